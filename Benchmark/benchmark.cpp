@@ -0,0 +1,84 @@
+#include "benchmark.h"
+#include <json.hpp>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+using namespace benchmark;
+using nlohmann::json;
+
+volatile float benchmark::sink = 0.0f;
+
+void benchmark::PrintResult(const Result& result)
+{
+    std::cout << std::fixed;
+    if (result.kind == Kind::MICRO) {
+        std::cout << std::left << std::setw(44) << result.name << std::right
+            << std::setprecision(2) << std::setw(10) << result.nsPerOp << " ns/op\n";
+    }
+    else {
+        const physics::StepTimings& t = result.averageTimings;
+        std::cout << std::left << std::setw(20) << result.name << std::right << std::setw(7) << result.bodyCount << " bodies"
+            << std::setprecision(1) << std::setw(10) << result.stepsPerSecond << " steps/s  ms/step:"
+            << std::setprecision(3)
+            << " gravity " << t.gravity << ", collision " << t.collisionDetection << ", islands " << t.islands
+            << ", solver " << t.solver << ", integration " << t.integration << ", sleep " << t.sleep
+            << ", total " << t.total << std::setprecision(1) << "  iterations/island " << result.iterationsPerIsland
+            << ", awake at the end " << result.awakeBodyCount << '\n';
+    }
+    std::cout << std::defaultfloat << std::flush;
+}
+
+void benchmark::WriteJson(const std::vector<Result>& results, const std::string& path)
+{
+    json j = json::array();
+    for (const Result& result : results) {
+        json resultJson;
+        resultJson["kind"] = result.kind == Kind::MICRO ? "micro" : "scene";
+        resultJson["name"] = result.name;
+        resultJson["iterations"] = result.iterations;
+        if (result.kind == Kind::MICRO) {
+            resultJson["nsPerOp"] = result.nsPerOp;
+        }
+        else {
+            const physics::StepTimings& t = result.averageTimings;
+            resultJson["bodies"] = result.bodyCount;
+            resultJson["stepsPerSecond"] = result.stepsPerSecond;
+            resultJson["iterationsPerIsland"] = result.iterationsPerIsland;
+            resultJson["awakeBodies"] = result.awakeBodyCount;
+            resultJson["msPerStep"] = {
+                { "gravity", t.gravity }, { "collisionDetection", t.collisionDetection }, { "islands", t.islands },
+                { "solver", t.solver }, { "integration", t.integration }, { "sleep", t.sleep }, { "total", t.total }
+            };
+        }
+        j.push_back(resultJson);
+    }
+    std::ofstream outputFile(path);
+    if (!outputFile.is_open()) {
+        throw std::runtime_error("can't write " + path);
+    }
+    outputFile << j.dump(4);
+}
+
+//one row per result, the columns that don't apply are left empty
+void benchmark::WriteCsv(const std::vector<Result>& results, const std::string& path)
+{
+    std::ofstream outputFile(path);
+    if (!outputFile.is_open()) {
+        throw std::runtime_error("can't write " + path);
+    }
+    outputFile << "kind,name,bodies,iterations,nsPerOp,stepsPerSecond,gravityMs,collisionDetectionMs,islandsMs,solverMs,integrationMs,sleepMs,totalMs,iterationsPerIsland,awakeBodies\n";
+    for (const Result& result : results) {
+        outputFile << (result.kind == Kind::MICRO ? "micro" : "scene") << ",\"" << result.name << "\",";
+        if (result.kind == Kind::MICRO) {
+            outputFile << "," << result.iterations << "," << result.nsPerOp << ",,,,,,,,,,\n";
+        }
+        else {
+            const physics::StepTimings& t = result.averageTimings;
+            outputFile << result.bodyCount << "," << result.iterations << ",," << result.stepsPerSecond << ","
+                << t.gravity << "," << t.collisionDetection << "," << t.islands << "," << t.solver << ","
+                << t.integration << "," << t.sleep << "," << t.total << "," << result.iterationsPerIsland << "," << result.awakeBodyCount << "\n";
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "engine/physicsWorld.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace benchmark
+{
+    enum class Kind
+    {
+        MICRO,//one operation in a loop, nsPerOp
+        SCENE//PhysicsWorld::Simulate() steps, stepsPerSecond and the phases
+    };
+
+    struct Result
+    {
+        Kind kind{};
+        std::string name;
+        int bodyCount{};
+        int iterations{};//operations or steps
+
+        double nsPerOp{};
+        double stepsPerSecond{};
+        physics::StepTimings averageTimings{};//ms per step
+        double iterationsPerIsland{};//solver iterations, averaged over the islands solved in all the steps
+        int awakeBodyCount{};//after the last step : a scene that settled has fallen asleep
+    };
+
+    struct Settings
+    {
+        int steps{ 200 };
+        int threadCount{ 1 };
+        int solverIterations{};//0 : the world's default
+        int maxBodyCount{ 100000 };
+        std::string filter;//runs the benchmarks whose name contains it
+        std::string jsonPath;
+        std::string csvPath;
+
+        bool IsSelected(const std::string& name) const { return filter.empty() || name.find(filter) != std::string::npos; }
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    //keeps the results alive, so that the measured operations aren't optimized out
+    extern volatile float sink;
+
+    //ns per call of op() (which returns a float for the sink), after a tenth of the iterations as a warm-up
+    template<typename Op>
+    double MeasureNanoseconds(int iterations, Op&& op)
+    {
+        float sum{};
+        for (int i{}; i < iterations / 10; ++i) {
+            sum += op();
+        }
+        Clock::time_point start = Clock::now();
+        for (int i{}; i < iterations; ++i) {
+            sum += op();
+        }
+        Clock::time_point end = Clock::now();
+        sink = sum;
+        return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    }
+
+    void RunMicroBenchmarks(const Settings& settings, std::vector<Result>& results);
+    void RunSceneBenchmarks(const Settings& settings, std::vector<Result>& results);
+
+    void PrintResult(const Result& result);
+    void WriteJson(const std::vector<Result>& results, const std::string& path);
+    void WriteCsv(const std::vector<Result>& results, const std::string& path);
+}
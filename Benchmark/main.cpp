@@ -0,0 +1,65 @@
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include "benchmark.h"
+
+//Micro benchmarks (math, narrow phase tests, solver) and scenes stepped at 100 to 100k bodies :
+//  Benchmark [--steps N] [--threads N] [--iterations N] [--max-bodies N] [--filter name] [--json results.json] [--csv results.csv]
+
+static benchmark::Settings ParseArguments(int argc, char** argv)
+{
+    benchmark::Settings settings;
+    for (int i{ 1 }; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--steps" && hasValue) {
+            settings.steps = std::stoi(argv[++i]);
+        }
+        else if (arg == "--threads" && hasValue) {
+            settings.threadCount = std::stoi(argv[++i]);
+        }
+        else if (arg == "--iterations" && hasValue) {
+            settings.solverIterations = std::stoi(argv[++i]);
+        }
+        else if (arg == "--max-bodies" && hasValue) {
+            settings.maxBodyCount = std::stoi(argv[++i]);
+        }
+        else if (arg == "--filter" && hasValue) {
+            settings.filter = argv[++i];
+        }
+        else if (arg == "--json" && hasValue) {
+            settings.jsonPath = argv[++i];
+        }
+        else if (arg == "--csv" && hasValue) {
+            settings.csvPath = argv[++i];
+        }
+        else {
+            throw std::runtime_error("usage: Benchmark [--steps N] [--threads N] [--iterations N] [--max-bodies N] [--filter name] [--json path] [--csv path]");
+        }
+    }
+    if (settings.steps <= 0) {
+        throw std::runtime_error("--steps must be positive");
+    }
+    return settings;
+}
+
+int main(int argc, char** argv) try
+{
+    benchmark::Settings settings = ParseArguments(argc, argv);
+    std::vector<benchmark::Result> results;
+
+    benchmark::RunMicroBenchmarks(settings, results);
+    benchmark::RunSceneBenchmarks(settings, results);
+
+    if (settings.jsonPath.empty() == false) {
+        benchmark::WriteJson(results, settings.jsonPath);
+    }
+    if (settings.csvPath.empty() == false) {
+        benchmark::WriteCsv(results, settings.csvPath);
+    }
+    return 0;
+}
+catch (const std::exception& e) {
+    std::cerr << "Caught exception: " << e.what() << std::endl;
+    return 1;
+}
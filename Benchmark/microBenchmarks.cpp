@@ -0,0 +1,271 @@
+#include "benchmark.h"
+#include "engine/collisionManager.h"
+#include "math/matrix3.h"
+#include "math/matrix4.h"
+#include "math/vector3.h"
+#include "math/mathConstants.h"//PI
+#include "simulator/object.h"
+#include <cmath>
+#include <functional>
+#include <typeinfo>
+
+using namespace benchmark;
+using math::Matrix4;
+using math::Vector3;
+using physics::BoxCollider;
+using physics::CapsuleCollider;
+using physics::CollisionManifold;
+using physics::CollisionManager;
+using physics::Collider;
+using physics::ConvexHull;
+using physics::ConvexHullCollider;
+using physics::Plane;
+using physics::RigidBody;
+using physics::SphereCollider;
+
+namespace
+{
+    constexpr int MATH_ITERATIONS = 2000000;
+    constexpr int NARROW_PHASE_ITERATIONS = 500000;
+
+    void Add(const Settings& settings, std::vector<Result>& results, const std::string& name, int iterations, const std::function<float()>& op)
+    {
+        if (settings.IsSelected(name) == false) {
+            return;
+        }
+        Result result;
+        result.kind = Kind::MICRO;
+        result.name = name;
+        result.iterations = iterations;
+        result.nsPerOp = MeasureNanoseconds(iterations, op);
+        PrintResult(result);
+        results.push_back(result);
+    }
+
+    //the typeid chain the dispatch table replaced, the baseline of the "dispatch" benchmarks
+    bool FindCollisionFeaturesByTypeid(CollisionManager& collisionManager, const Collider* shape1, const Collider* shape2, std::vector<CollisionManifold>& manifolds)
+    {
+        if (typeid(*shape1) == typeid(SphereCollider)) {
+            const SphereCollider* sphere = static_cast<const SphereCollider*>(shape1);
+            if (typeid(*shape2) == typeid(SphereCollider)) {
+                return collisionManager.FindCollisionFeatures(sphere, static_cast<const SphereCollider*>(shape2), manifolds);
+            }
+            else if (typeid(*shape2) == typeid(BoxCollider)) {
+                return collisionManager.FindCollisionFeatures(static_cast<const BoxCollider*>(shape2), sphere, manifolds);
+            }
+        }
+        else if (typeid(*shape1) == typeid(BoxCollider)) {
+            const BoxCollider* box = static_cast<const BoxCollider*>(shape1);
+            if (typeid(*shape2) == typeid(BoxCollider)) {
+                return collisionManager.FindCollisionFeatures(box, static_cast<const BoxCollider*>(shape2), manifolds);
+            }
+            else if (typeid(*shape2) == typeid(SphereCollider)) {
+                return collisionManager.FindCollisionFeatures(box, static_cast<const SphereCollider*>(shape2), manifolds);
+            }
+        }
+        return false;
+    }
+
+    RigidBody* CreateBody(physics::PhysicsWorld& world, const Vector3& position, const physics::Quaternion& orientation)
+    {
+        RigidBody* body = world.CreateRigidBody();
+        body->SetMass(2.0f);
+        body->SetInertiaTensor(physics::Matrix3(2.0f / 6.0f));
+        body->SetOrientation(orientation);
+        body->SetPosition(position);
+        return body;
+    }
+
+    void RunMathBenchmarks(const Settings& settings, std::vector<Result>& results)
+    {
+        //the inputs change every call, so that nothing is hoisted out of the loops
+        Matrix4 a{ 0.9f,0.1f,-0.2f,0.0f, -0.1f,0.95f,0.05f,0.0f, 0.2f,-0.05f,0.9f,0.0f, 1.0f,2.0f,3.0f,1.0f };
+        Matrix4 b{ 1.1f,0.0f,0.3f,0.0f, 0.2f,0.8f,0.0f,0.0f, -0.3f,0.1f,1.2f,0.0f, -2.0f,0.5f,1.0f,1.0f };
+        Vector3 u{ 1.5f,-0.25f,2.0f };
+        Vector3 v{ -0.75f,3.0f,0.5f };
+        float t = 0.0f;
+
+        Add(settings, results, "Matrix4 * Matrix4", MATH_ITERATIONS, [&]() {
+            a[0] = t += 1e-7f;
+            return (a * b)[5];
+        });
+        Add(settings, results, "Matrix4 * Vector3", MATH_ITERATIONS, [&]() {
+            u.x = t += 1e-7f;
+            return (a * u).y;
+        });
+        Add(settings, results, "Matrix4::Inverse", MATH_ITERATIONS, [&]() {
+            a[0] = 0.9f + (t += 1e-7f);
+            return a.Inverse()[5];
+        });
+        Add(settings, results, "Matrix4::Transpose", MATH_ITERATIONS, [&]() {
+            a[1] = t += 1e-7f;
+            return a.Transpose()[4];
+        });
+        Add(settings, results, "Matrix4::Extract3x3Matrix", MATH_ITERATIONS, [&]() {
+            a[1] = t += 1e-7f;
+            return a.Extract3x3Matrix()[1];
+        });
+
+        Add(settings, results, "Vector3::Dot", MATH_ITERATIONS, [&]() {
+            u.x = t += 1e-7f;
+            return u.Dot(v);
+        });
+        Add(settings, results, "Vector3::Cross", MATH_ITERATIONS, [&]() {
+            u.x = t += 1e-7f;
+            return u.Cross(v).z;
+        });
+        Add(settings, results, "Vector3::Normalize", MATH_ITERATIONS, [&]() {
+            Vector3 w{ 1.0f + (t += 1e-7f), 2.0f, 3.0f };
+            w.Normalize();
+            return w.x;
+        });
+        Add(settings, results, "Vector3 + Vector3 * float", MATH_ITERATIONS, [&]() {
+            return (u + v * (t += 1e-7f)).y;
+        });
+    }
+
+    //points on a sphere, all of them on the hull
+    ConvexHull BuildRoundHull(int pointCount)
+    {
+        const float goldenAngle = math::PI * (3.0f - std::sqrt(5.0f));
+        std::vector<Vector3> points;
+        for (int i{}; i < pointCount; ++i) {
+            float y = 1.0f - 2.0f * (i + 0.5f) / pointCount;
+            float ringRadius = std::sqrt(1.0f - y * y);
+            points.push_back(Vector3{ ringRadius * std::cos(goldenAngle * i), y, ringRadius * std::sin(goldenAngle * i) } * 0.5f);
+        }
+        return ConvexHull::Build(points);
+    }
+
+    //the hill climbing against the loop over the vertices, turning directions
+    void RunSupportBenchmarks(const Settings& settings, std::vector<Result>& results)
+    {
+        constexpr int DIRECTION_COUNT = 64;
+        Vector3 directions[DIRECTION_COUNT];
+        for (int i{}; i < DIRECTION_COUNT; ++i) {
+            directions[i] = Vector3{ std::cos(i * 0.7f), std::sin(i * 1.3f), std::cos(i * 2.1f) };
+        }
+        for (int pointCount : { 32, 256, 4096 }) {
+            const ConvexHull hull = BuildRoundHull(pointCount);
+            const std::vector<Vector3>& vertices = hull.GetVertices();
+            const std::string suffix = " (" + std::to_string(vertices.size()) + " vertices)";
+            int i{};
+            Add(settings, results, "ConvexHull support hill climbing" + suffix, NARROW_PHASE_ITERATIONS, [&]() {
+                return static_cast<float>(hull.GetSupportVertex(directions[++i % DIRECTION_COUNT]));
+            });
+            Add(settings, results, "ConvexHull support linear" + suffix, NARROW_PHASE_ITERATIONS, [&]() {
+                const Vector3& direction = directions[++i % DIRECTION_COUNT];
+                int best{};
+                float bestDot = vertices[0].Dot(direction);
+                for (int j = 1; j < static_cast<int>(vertices.size()); ++j) {
+                    const float dot = vertices[j].Dot(direction);
+                    if (dot > bestDot) {
+                        bestDot = dot;
+                        best = j;
+                    }
+                }
+                return static_cast<float>(best);
+            });
+        }
+    }
+
+    void RunNarrowPhaseBenchmarks(const Settings& settings, std::vector<Result>& results)
+    {
+        physics::PhysicsWorld world;
+        CollisionManager collisionManager;
+        std::vector<CollisionManifold> manifolds;
+
+        const physics::Quaternion tilted{ 30.0f, Vector3{ 1.0f,2.0f,0.5f } };
+        RigidBody* sphereBody1 = CreateBody(world, Vector3{ 0.0f,0.4f,0.0f }, physics::Quaternion{});
+        RigidBody* sphereBody2 = CreateBody(world, Vector3{ 0.7f,0.6f,0.2f }, physics::Quaternion{});
+        RigidBody* boxBody1 = CreateBody(world, Vector3{ 0.0f,0.45f,0.0f }, physics::Quaternion{});
+        RigidBody* boxBody2 = CreateBody(world, Vector3{ 0.6f,1.2f,0.3f }, tilted);
+        SphereCollider* sphere1 = world.CreateSphereCollider(sphereBody1, 0.5f);
+        SphereCollider* sphere2 = world.CreateSphereCollider(sphereBody2, 0.5f);
+        BoxCollider* box1 = world.CreateBoxCollider(boxBody1, Vector3{ 0.5f,0.5f,0.5f });
+        BoxCollider* box2 = world.CreateBoxCollider(boxBody2, Vector3{ 0.5f,0.5f,0.5f });
+        SphereCollider* sphereOnBox = world.CreateSphereCollider(sphereBody2, 0.5f);
+        BoxCollider* boxApart = world.CreateBoxCollider(CreateBody(world, Vector3{ 5.0f,0.5f,0.0f }, physics::Quaternion{}), Vector3{ 0.5f,0.5f,0.5f });
+        //inside box1's bounding sphere, separated along x : after the first call, the cached axis ends the SAT
+        BoxCollider* boxBeside = world.CreateBoxCollider(CreateBody(world, Vector3{ 1.2f,0.45f,0.0f }, tilted), Vector3{ 0.5f,0.5f,0.5f });
+        Plane ground{ Vector3{ 0.0f,1.0f,0.0f }, 0.0f };
+        CapsuleCollider* capsule1 = world.CreateCapsuleCollider(CreateBody(world, Vector3{ 0.0f,0.4f,0.0f }, tilted), 0.5f, 0.5f);
+        CapsuleCollider* capsule2 = world.CreateCapsuleCollider(CreateBody(world, Vector3{ 0.7f,0.9f,0.2f }, physics::Quaternion{}), 0.5f, 0.5f);
+        //lying across the top face of box1 : 2 points
+        CapsuleCollider* capsuleOnBox = world.CreateCapsuleCollider(CreateBody(world, Vector3{ 0.2f,1.35f,0.1f }, physics::Quaternion{ 90.0f, Vector3{ 0.0f,0.0f,1.0f } }), 0.5f, 0.5f);
+        ConvexHullCollider* rock1 = world.CreateConvexHullCollider(CreateBody(world, Vector3{ 0.0f,0.25f,0.0f }, tilted), ConvexHullObject::GetRockHull());
+        ConvexHullCollider* rock2 = world.CreateConvexHullCollider(CreateBody(world, Vector3{ 0.4f,0.75f,0.1f }, physics::Quaternion{}), ConvexHullObject::GetRockHull());
+
+        //every pair overlaps : the whole test runs, manifold included
+        auto test = [&](auto* lhs, auto* rhs) {
+            return [&, lhs, rhs]() {
+                manifolds.clear();
+                return collisionManager.FindCollisionFeatures(lhs, rhs, manifolds) ? 1.0f : 0.0f;
+            };
+        };
+        Add(settings, results, "FindCollisionFeatures sphere-sphere", NARROW_PHASE_ITERATIONS, test(sphere1, sphere2));
+        Add(settings, results, "FindCollisionFeatures box-sphere", NARROW_PHASE_ITERATIONS, test(box1, sphereOnBox));
+        Add(settings, results, "FindCollisionFeatures box-box", NARROW_PHASE_ITERATIONS, test(box1, box2));
+        Add(settings, results, "FindCollisionFeatures sphere-plane", NARROW_PHASE_ITERATIONS, test(sphere1, &ground));
+        Add(settings, results, "FindCollisionFeatures box-plane", NARROW_PHASE_ITERATIONS, test(box1, &ground));
+        Add(settings, results, "FindCollisionFeatures box-box separated", NARROW_PHASE_ITERATIONS, test(box1, boxBeside));
+        Add(settings, results, "FindCollisionFeatures capsule-capsule", NARROW_PHASE_ITERATIONS, test(capsule1, capsule2));
+        Add(settings, results, "FindCollisionFeatures capsule-sphere", NARROW_PHASE_ITERATIONS, test(capsule1, sphere2));
+        Add(settings, results, "FindCollisionFeatures box-capsule", NARROW_PHASE_ITERATIONS, test(box1, capsuleOnBox));
+        Add(settings, results, "FindCollisionFeatures capsule-plane", NARROW_PHASE_ITERATIONS, test(capsule1, &ground));
+        Add(settings, results, "FindCollisionFeatures hull-plane", NARROW_PHASE_ITERATIONS, test(rock1, &ground));
+        Add(settings, results, "FindCollisionFeatures dispatch (box-box)", NARROW_PHASE_ITERATIONS,
+            test(static_cast<const Collider*>(box1), static_cast<const Collider*>(box2)));
+
+        //the dispatch table against the typeid chain, the pairs apart leave little more than the dispatch
+        auto testByTypeid = [&](const Collider* lhs, const Collider* rhs) {
+            return [&, lhs, rhs]() {
+                manifolds.clear();
+                return FindCollisionFeaturesByTypeid(collisionManager, lhs, rhs, manifolds) ? 1.0f : 0.0f;
+            };
+        };
+        Add(settings, results, "FindCollisionFeatures typeid chain (box-box)", NARROW_PHASE_ITERATIONS, testByTypeid(box1, box2));
+        Add(settings, results, "FindCollisionFeatures dispatch (sphere-box, apart)", NARROW_PHASE_ITERATIONS,
+            test(static_cast<const Collider*>(sphere1), static_cast<const Collider*>(boxApart)));
+        Add(settings, results, "FindCollisionFeatures typeid chain (sphere-box, apart)", NARROW_PHASE_ITERATIONS, testByTypeid(sphere1, boxApart));
+        Add(settings, results, "FindCollisionFeatures dispatch (box-box, apart)", NARROW_PHASE_ITERATIONS,
+            test(static_cast<const Collider*>(box1), static_cast<const Collider*>(boxApart)));
+        Add(settings, results, "FindCollisionFeatures typeid chain (box-box, apart)", NARROW_PHASE_ITERATIONS, testByTypeid(box1, boxApart));
+
+        //GJK/EPA, the fallback of the pairs without an analytic test, on the pairs that have one
+        auto testConvex = [&](const Collider* lhs, const Collider* rhs) {
+            return [&, lhs, rhs]() {
+                manifolds.clear();
+                return collisionManager.FindConvexFeatures(lhs, rhs, manifolds) ? 1.0f : 0.0f;
+            };
+        };
+        Add(settings, results, "FindConvexFeatures sphere-sphere (GJK/EPA)", NARROW_PHASE_ITERATIONS, testConvex(sphere1, sphere2));
+        Add(settings, results, "FindConvexFeatures box-sphere (GJK/EPA)", NARROW_PHASE_ITERATIONS, testConvex(box1, sphereOnBox));
+        Add(settings, results, "FindConvexFeatures box-box (GJK/EPA)", NARROW_PHASE_ITERATIONS, testConvex(box1, box2));
+        Add(settings, results, "FindConvexFeatures box-box separated (GJK)", NARROW_PHASE_ITERATIONS, testConvex(box1, boxBeside));
+        Add(settings, results, "FindConvexFeatures capsule-capsule (GJK/EPA)", NARROW_PHASE_ITERATIONS, testConvex(capsule1, capsule2));
+        Add(settings, results, "FindConvexFeatures box-capsule (GJK/EPA)", NARROW_PHASE_ITERATIONS, testConvex(capsuleOnBox, box1));
+        Add(settings, results, "FindConvexFeatures hull-hull (GJK/EPA)", NARROW_PHASE_ITERATIONS, testConvex(rock1, rock2));
+        Add(settings, results, "FindConvexFeatures box-hull (GJK/EPA)", NARROW_PHASE_ITERATIONS, testConvex(box1, rock2));
+        Add(settings, results, "FindConvexFeatures box-plane (support point)", NARROW_PHASE_ITERATIONS, [&]() {
+            manifolds.clear();
+            return collisionManager.FindConvexFeatures(box1, &ground, manifolds) ? 1.0f : 0.0f;
+        });
+
+        //a resting box on the ground : 4 points
+        manifolds.clear();
+        collisionManager.FindCollisionFeatures(box1, &ground, manifolds);
+        CollisionManifold contact = manifolds.front();
+        Add(settings, results, "SequentialImpulse box-plane (4 points)", NARROW_PHASE_ITERATIONS, [&]() {
+            collisionManager.SequentialImpulse(contact, 1.0f / 60.0f);
+            return contact.points[0].accumulatedNormalImpulse;
+        });
+    }
+}
+
+void benchmark::RunMicroBenchmarks(const Settings& settings, std::vector<Result>& results)
+{
+    RunMathBenchmarks(settings, results);
+    RunNarrowPhaseBenchmarks(settings, results);
+    RunSupportBenchmarks(settings, results);
+}
@@ -0,0 +1,18 @@
+project "Benchmark"
+    kind "ConsoleApp"
+    language "C++"
+
+    files 
+    { 
+        "**.h", 
+        "**.cpp"
+    }
+
+    -- engine/, math/, simulator/ paths of PhysicsEngine
+    includedirs { "../PhysicsEngine", "." }
+
+    links { "PhysicsCore" }
+
+    -- timings of a Debug build are meaningless
+    filter "configurations:Debug"
+        optimize "On"
@@ -0,0 +1,194 @@
+#include "benchmark.h"
+#include "simulator/object.h"
+#include "math/mathConstants.h"//PI
+#include <cmath>
+#include <functional>
+#include <random>
+
+using namespace benchmark;
+using math::Vector3;
+using physics::PhysicsWorld;
+
+namespace
+{
+    constexpr int BODY_COUNTS[] = { 100, 1000, 10000, 100000 };
+    constexpr float SPAWNED_OBJECT_SCALE = 0.3f;//what SphereBoxSpawner throws out
+
+    typedef std::function<void(PhysicsWorld&, int bodyCount)> SceneBuilder;
+
+    RigidObject* AddObject(PhysicsWorld& world, ObjectType type, const Vector3& position, float scale, float mass)
+    {
+        RigidObject* obj = CreateObject(type);
+        AddObjectToWorld(world, obj, position);
+        obj->SetScale(scale);
+        obj->SetMass(mass);
+        return obj;
+    }
+
+    //spheres falling from a cube-shaped cloud
+    void BuildSphereRain(PhysicsWorld& world, int bodyCount)
+    {
+        std::mt19937 gen{ 42 };
+        std::uniform_real_distribution<float> jitter(-0.2f, 0.2f);
+        const int side = static_cast<int>(std::ceil(std::cbrt(static_cast<float>(bodyCount))));
+        for (int i{}; i < bodyCount; ++i) {
+            int x = i % side, z = (i / side) % side, y = i / (side * side);
+            Vector3 position{ (x - side / 2) * 1.2f + jitter(gen), 5.0f + y * 1.2f, (z - side / 2) * 1.2f + jitter(gen) };
+            AddObject(world, ObjectType::SPHERE, position, 0.4f, 1.0f);
+        }
+    }
+
+    //rows of unit boxes, each one half a box shorter on both sides : height H holds H(H+1)/2 boxes
+    void BuildBoxPyramid(PhysicsWorld& world, int bodyCount)
+    {
+        const int height = static_cast<int>((std::sqrt(8.0f * bodyCount + 1.0f) - 1.0f) / 2.0f);
+        for (int row{}; row < height; ++row) {
+            for (int i{}; i < height - row; ++i) {
+                Vector3 position{ (i - (height - row) / 2.0f) * 1.0f, 0.5f + row * 1.0f, 0.0f };
+                AddObject(world, ObjectType::BOX, position, 0.5f, 2.5f);
+            }
+        }
+    }
+
+    //what SphereBoxSpawner::spawnAll() does for bodyCount bodies : thrown out of one point, mostly upwards
+    void BuildSpawnerExplosion(PhysicsWorld& world, int bodyCount)
+    {
+        std::mt19937 gen{ 42 };
+        std::uniform_real_distribution<float> posDist(-2.0f, 2.0f);
+        std::uniform_real_distribution<float> upVelocityDist(0.1f, 25.0f);
+        std::uniform_real_distribution<float> sideVelocityDist(-5.0f, 5.0f);
+        std::uniform_real_distribution<float> degreeDist(0.0f, 2.0f * math::PI);
+        std::uniform_real_distribution<float> axisDist(-1.0f, 1.0f);
+
+        const Vector3 spawnerPosition{ 0.0f, 3.0f, 0.0f };
+        for (int i{}; i < bodyCount; ++i) {
+            Vector3 offset{ posDist(gen), posDist(gen), posDist(gen) };
+            ObjectType type = (i % 2 == 0) ? ObjectType::SPHERE : ObjectType::BOX;
+            RigidObject* obj = AddObject(world, type, spawnerPosition + offset, SPAWNED_OBJECT_SCALE, type == ObjectType::SPHERE ? 3.0f : 2.5f);
+
+            physics::RigidBody* body = obj->GetRigidBody();
+            body->SetLinearVelocity(Vector3{ sideVelocityDist(gen), upVelocityDist(gen), sideVelocityDist(gen) });
+            body->SetAngularVelocity(Vector3{ axisDist(gen), axisDist(gen), axisDist(gen) });
+            body->SetOrientation(physics::Quaternion{ degreeDist(gen), Vector3{ axisDist(gen), axisDist(gen), axisDist(gen) } });
+        }
+    }
+
+    //boxes resting on the ground, apart from each other : mostly sleeping after a few steps
+    void BuildBoxGrid(PhysicsWorld& world, int bodyCount)
+    {
+        const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(bodyCount))));
+        for (int i{}; i < bodyCount; ++i) {
+            int x = i % side, z = i / side;
+            AddObject(world, ObjectType::BOX, Vector3{ (x - side / 2) * 1.5f, 0.5f, (z - side / 2) * 1.5f }, 0.5f, 2.5f);
+        }
+    }
+
+    //capsules dropped in crossed layers, like a pile of logs : the capsule-capsule and capsule-plane tests
+    void BuildCapsulePile(PhysicsWorld& world, int bodyCount)
+    {
+        const int perLayer = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(bodyCount))));
+        const float halfHeight = perLayer * 0.5f;//as long as a layer is wide
+        const physics::Quaternion alongX{ 90.0f, Vector3{ 0.0f,0.0f,1.0f } };
+        const physics::Quaternion alongZ{ 90.0f, Vector3{ 1.0f,0.0f,0.0f } };
+        for (int i{}; i < bodyCount; ++i) {
+            int layer = i / perLayer, j = i % perLayer;
+            float offset = (j - perLayer / 2) * 1.0f;
+            bool isAlongX = layer % 2 == 0;
+            Vector3 position = isAlongX ? Vector3{ 0.0f, 0.5f + layer * 1.2f, offset } : Vector3{ offset, 0.5f + layer * 1.2f, 0.0f };
+            RigidObject* obj = AddObject(world, ObjectType::CAPSULE, position, 0.4f, 2.0f);
+            obj->SetScale(Vector3{ 0.4f, halfHeight, 0.4f });
+            obj->GetRigidBody()->SetOrientation(isAlongX ? alongX : alongZ);
+        }
+    }
+
+    //rocks dropped from a cloud, turned at random : the hull-plane test and GJK/EPA between the hulls
+    void BuildRockPile(PhysicsWorld& world, int bodyCount)
+    {
+        std::mt19937 gen{ 42 };
+        std::uniform_real_distribution<float> jitter(-0.2f, 0.2f);
+        std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+        const int side = static_cast<int>(std::ceil(std::cbrt(static_cast<float>(bodyCount))));
+        for (int i{}; i < bodyCount; ++i) {
+            int x = i % side, z = (i / side) % side, y = i / (side * side);
+            Vector3 position{ (x - side / 2) * 1.2f + jitter(gen), 1.0f + y * 1.2f, (z - side / 2) * 1.2f + jitter(gen) };
+            RigidObject* obj = AddObject(world, ObjectType::CONVEX_HULL, position, 1.0f, 2.0f);
+            obj->GetRigidBody()->SetOrientation(physics::Quaternion{ angle(gen), Vector3{ 0.0f,1.0f,0.0f } } * physics::Quaternion{ angle(gen), Vector3{ 1.0f,0.0f,0.0f } });
+        }
+    }
+
+    Result RunScene(const Settings& settings, const std::string& name, const SceneBuilder& build, int bodyCount)
+    {
+        PhysicsWorld world;
+        world.SetThreadCount(settings.threadCount);
+        if (settings.solverIterations > 0) {
+            world.SetSolverIterations(settings.solverIterations);
+        }
+        build(world, bodyCount);
+
+        Result result;
+        result.kind = Kind::SCENE;
+        result.name = name;
+        result.bodyCount = static_cast<int>(world.GetObjects().size());
+        result.iterations = settings.steps;
+
+        physics::StepTimings& sum = result.averageTimings;
+        double totalMs{};
+        long long solvedIslands{}, islandIterations{};
+        for (int i{}; i < settings.steps; ++i) {
+            world.Simulate(1.0f / 60.0f);
+            const physics::StepTimings& step = world.GetLastStepTimings();
+            sum.gravity += step.gravity;
+            sum.collisionDetection += step.collisionDetection;
+            sum.islands += step.islands;
+            sum.solver += step.solver;
+            sum.integration += step.integration;
+            sum.sleep += step.sleep;
+            sum.total += step.total;
+            totalMs += step.total;
+            const physics::StepStats& stats = world.GetStepStats().GetLast();
+            solvedIslands += stats.solvedIslands;
+            islandIterations += stats.islandIterations;
+        }
+        result.iterationsPerIsland = solvedIslands > 0 ? static_cast<double>(islandIterations) / solvedIslands : 0.0;
+        result.awakeBodyCount = world.GetStepStats().GetLast().bodiesIntegrated;
+        if (settings.steps > 0) {
+            const float stepCount = static_cast<float>(settings.steps);
+            sum.gravity /= stepCount;
+            sum.collisionDetection /= stepCount;
+            sum.islands /= stepCount;
+            sum.solver /= stepCount;
+            sum.integration /= stepCount;
+            sum.sleep /= stepCount;
+            sum.total /= stepCount;
+            result.stepsPerSecond = totalMs > 0.0 ? settings.steps * 1000.0 / totalMs : 0.0;
+        }
+
+        DeleteAllObjects(world);
+        return result;
+    }
+}
+
+void benchmark::RunSceneBenchmarks(const Settings& settings, std::vector<Result>& results)
+{
+    const std::pair<std::string, SceneBuilder> scenes[] = {
+        { "sphere rain", BuildSphereRain },
+        { "box pyramid", BuildBoxPyramid },
+        { "spawner explosion", BuildSpawnerExplosion },
+        { "box grid", BuildBoxGrid },
+        { "capsule pile", BuildCapsulePile },
+        { "rock pile", BuildRockPile }
+    };
+    for (const auto& scene : scenes) {
+        if (settings.IsSelected(scene.first) == false) {
+            continue;
+        }
+        for (int bodyCount : BODY_COUNTS) {
+            if (bodyCount > settings.maxBodyCount) {
+                continue;
+            }
+            Result result = RunScene(settings, scene.first, scene.second, bodyCount);
+            PrintResult(result);
+            results.push_back(result);
+        }
+    }
+}
@@ -0,0 +1,190 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "engine/physicsWorld.h"
+#include "simulator/object.h"
+#include "simulator/objectSerialization.h"
+#include "engine/profiler.h"
+
+//Steps a preset without window nor renderer, e.g. on the compute nodes :
+//  Headless-Runner <preset.json> [--steps N] [--dt seconds] [--threads N] [--solver-tolerance N.s] [--substeps N] [--out state.json] [--trace trace.json]
+//The final state is written in the preset format, so it can be loaded back in the GUI.
+
+struct RunnerSettings
+{
+    std::string presetPath;
+    std::string outputPath;//nothing written if empty
+    std::string tracePath;//Chrome trace of the last steps, nothing written if empty
+    int steps{ 600 };
+    float timeStep{ 1.0f / 60.0f };
+    int threadCount{ 1 };
+    float solverTolerance{ -1.0f };//the engine's default if negative
+    int substepCount{};//solved with SolverMode::SOFT_SUBSTEPS if positive
+};
+
+static RunnerSettings ParseArguments(int argc, char** argv)
+{
+    RunnerSettings settings;
+    for (int i{ 1 }; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--steps" && hasValue) {
+            settings.steps = std::stoi(argv[++i]);
+        }
+        else if (arg == "--dt" && hasValue) {
+            settings.timeStep = std::stof(argv[++i]);
+        }
+        else if (arg == "--threads" && hasValue) {
+            settings.threadCount = std::stoi(argv[++i]);
+        }
+        else if (arg == "--solver-tolerance" && hasValue) {
+            settings.solverTolerance = std::stof(argv[++i]);
+        }
+        else if (arg == "--substeps" && hasValue) {
+            settings.substepCount = std::stoi(argv[++i]);
+        }
+        else if (arg == "--out" && hasValue) {
+            settings.outputPath = argv[++i];
+        }
+        else if (arg == "--trace" && hasValue) {
+            settings.tracePath = argv[++i];
+        }
+        else if (arg.rfind("--", 0) != 0 && settings.presetPath.empty()) {
+            settings.presetPath = arg;
+        }
+        else {
+            throw std::runtime_error("invalid argument: " + arg);
+        }
+    }
+    if (settings.presetPath.empty()) {
+        throw std::runtime_error("usage: Headless-Runner <preset.json> [--steps N] [--dt seconds] [--threads N] [--solver-tolerance N.s] [--substeps N] [--out state.json] [--trace trace.json]");
+    }
+    if (settings.steps < 0 || settings.timeStep <= 0.0f) {
+        throw std::runtime_error("--steps can't be negative, --dt must be positive");
+    }
+    return settings;
+}
+
+//PresetLoadEvent without the graphical shapes : the spawners are loaded as boxes
+static void LoadPreset(physics::PhysicsWorld& world, const std::string& presetPath)
+{
+    std::vector<ObjectData> loadedObjects;
+    LoadObjectsFromJson(loadedObjects, presetPath);
+    if (loadedObjects.empty()) {
+        throw std::runtime_error("no object loaded from " + presetPath);
+    }
+
+    int spawnerCount{};
+    for (const ObjectData& objData : loadedObjects) {
+        ObjectType type = objData.type;
+        if (type == ObjectType::SPAWNER) {
+            type = ObjectType::BOX;//its pools need the renderer
+            ++spawnerCount;
+        }
+        RigidObject* obj = CreateObject(type);
+        AddObjectToWorld(world, obj, objData.pos);
+        ApplyObjectData(obj, objData);
+    }
+    if (spawnerCount > 0) {
+        std::cerr << spawnerCount << " spawner(s) loaded as boxes" << std::endl;
+    }
+}
+
+//averages per step over the stats window
+static void PrintStepStats(const physics::StepStatsWindow& window)
+{
+    const int stepCount = window.GetStepCount();
+    if (stepCount == 0) {
+        return;
+    }
+    const physics::StepStats& sum = window.GetSum();
+    auto average = [stepCount](int value) { return static_cast<double>(value) / stepCount; };
+
+    std::cout << "last " << stepCount << " steps, per step:\n";
+    std::cout << "  candidate pairs: " << average(sum.candidatePairs) << '\n';
+    std::cout << "  narrow phase tests: " << average(sum.GetNarrowPhaseTestCount());
+    for (int i{}; i < physics::SHAPE_PAIR_TYPE_COUNT; ++i) {
+        std::cout << (i == 0 ? " (" : ", ") << physics::GetShapePairName(static_cast<physics::ShapePairType>(i))
+            << ' ' << average(sum.narrowPhaseTests[i]);
+    }
+    std::cout << ")\n";
+    std::cout << "  manifolds: " << average(sum.manifolds) << ", contact points: " << average(sum.contactPoints) << '\n';
+    std::cout << "  solver iterations: " << average(sum.solverIterations) << " (slowest island), islands solved: " << average(sum.solvedIslands)
+        << ", iterations per island: " << (sum.solvedIslands > 0 ? static_cast<double>(sum.islandIterations) / sum.solvedIslands : 0.0) << '\n';
+    std::cout << "  bodies integrated: " << average(sum.bodiesIntegrated) << '\n';
+    std::cout << "  heap allocations: " << average(sum.heapAllocations) << std::endl;
+}
+
+static void SaveState(const std::vector<RigidObject*>& objects, const std::string& outputPath)
+{
+    std::vector<ObjectData> serializedObjs;
+    for (const RigidObject* obj : objects) {
+        const physics::RigidBody* body = obj->GetRigidBody();
+        ObjectData data;
+        data.pos = body->GetPosition();
+        data.scl = obj->GetScale();
+        data.vel = body->GetLinearVelocity();
+        data.angVel = body->GetAngularVelocity();
+        data.type = obj->GetObjectType();
+        data.orientation = body->GetOrientation();
+        data.mass = body->GetMass();
+        data.IsFixed = obj->GetIsFixed();
+        serializedObjs.push_back(data);
+    }
+    SaveObjectsToJson(serializedObjs, outputPath);
+}
+
+int main(int argc, char** argv) try
+{
+    RunnerSettings settings = ParseArguments(argc, argv);
+
+    physics::PhysicsWorld world;
+    world.SetThreadCount(settings.threadCount);
+    if (settings.solverTolerance >= 0.0f) {
+        world.SetSolverTolerance(settings.solverTolerance);
+    }
+    if (settings.substepCount > 0) {
+        physics::SoftContactSettings softSettings;
+        softSettings.substepCount = settings.substepCount;
+        world.SetSoftContactSettings(softSettings);
+        world.SetSolverMode(physics::SolverMode::SOFT_SUBSTEPS);
+    }
+    LoadPreset(world, settings.presetPath);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i{}; i < settings.steps; ++i) {
+        world.Simulate(settings.timeStep);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::vector<RigidObject*>& objects = world.GetObjects();
+    std::cout << "objects: " << objects.size() << ", steps: " << settings.steps << ", dt: " << settings.timeStep
+        << ", threads: " << world.GetThreadCount() << '\n';
+    std::cout << "total: " << totalMs << " ms, per step: " << (settings.steps > 0 ? totalMs / settings.steps : 0.0) << " ms" << std::endl;
+    PrintStepStats(world.GetStepStats());
+
+    if (settings.outputPath.empty() == false) {
+        SaveState(objects, settings.outputPath);
+    }
+    if (settings.tracePath.empty() == false && physics::Profiler::WriteChromeTrace(settings.tracePath) == false) {
+        throw std::runtime_error("can't write " + settings.tracePath);
+    }
+
+    DeleteAllObjects(world);
+    return 0;
+}
+catch (const std::runtime_error& e) {
+    std::cerr << "Runtime error: " << e.what() << std::endl;
+    return 1;
+}
+catch (const std::exception& e) {
+    std::cerr << "Caught exception: " << e.what() << std::endl;
+    return 2;
+}
+catch (...) {
+    std::cerr << "Caught unknown exception." << std::endl;
+    return 3;
+}
@@ -0,0 +1,15 @@
+project "Headless-Runner"
+    kind "ConsoleApp"
+    language "C++"
+
+    files 
+    { 
+        "**.h", 
+        "**.cpp",
+        "../PhysicsEngine/engine/allocationCounter.cpp" -- heap allocations in the step counters
+    }
+
+    -- engine/, math/, simulator/ paths of PhysicsEngine
+    includedirs { "../PhysicsEngine" }
+
+    links { "PhysicsCore" }
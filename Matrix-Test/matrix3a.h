@@ -0,0 +1,141 @@
+#pragma once
+
+#include "vector3a.h"
+#include "matrix3.h"
+#include "matrix4.h"
+
+namespace math
+{
+    //Matrix3 as 3 padded columns (Vector3A), inline. Same layout as Matrix3 (entries[col][row]) and same results :
+    //a product still adds its 3 terms in the order of Matrix3::operator*().
+    struct alignas(16) Matrix3A
+    {
+        Vector3A columns[3];
+
+        Matrix3A(float diagonal = 1.f)
+            : columns{ Vector3A(diagonal, 0.0f, 0.0f), Vector3A(0.0f, diagonal, 0.0f), Vector3A(0.0f, 0.0f, diagonal) } {}
+        Matrix3A(const Vector3A& column0, const Vector3A& column1, const Vector3A& column2)
+            : columns{ column0, column1, column2 } {}
+        explicit Matrix3A(const Matrix3& mat)
+            : columns{
+                Vector3A(mat.entries[0][0], mat.entries[0][1], mat.entries[0][2]),
+                Vector3A(mat.entries[1][0], mat.entries[1][1], mat.entries[1][2]),
+                Vector3A(mat.entries[2][0], mat.entries[2][1], mat.entries[2][2]) } {}
+
+        //upper-left 3x3 of a transform, read straight from its columns (no Extract3x3Matrix() copy)
+        static Matrix3A FromMatrix4(const Matrix4& mat);
+
+        Matrix3 ToMatrix3() const;
+
+        Matrix3A Transpose() const;
+        Matrix3A operator*(const Matrix3A& other) const;
+    };
+
+    //R * I * R^T, R being the rotation of localToWorld
+    Matrix3A TransformInertiaTensor(const Matrix3A& rotation, const Matrix3A& inertiaTensor);
+    //same, for a diagonal I (boxes, spheres) : R * diag is only a scale of the columns of R
+    Matrix3A TransformDiagonalInertiaTensor(const Matrix3A& rotation, const Vector3& diagonal);
+    //results[i] = R_i * tensors[i] * R_i^T for count bodies, the diagonal tensors take the fast path
+    void TransformInertiaTensors(const Matrix4* localToWorld, const Matrix3* tensors, Matrix3* results, int count);
+
+
+    inline Matrix3A Matrix3A::FromMatrix4(const Matrix4& mat) {
+#ifdef MATH_SIMD_SSE
+        //the w of the rotation columns is 0 for a transform, cleared anyway to keep the padding of Vector3A
+        const __m128 xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+        return Matrix3A(
+            Vector3A(_mm_and_ps(mat.columns[0], xyzMask)),
+            Vector3A(_mm_and_ps(mat.columns[1], xyzMask)),
+            Vector3A(_mm_and_ps(mat.columns[2], xyzMask)));
+#else
+        Matrix3A result;
+        for (int col = 0; col < 3; ++col) {
+            alignas(16) float column[4];
+            _mm_store_ps(column, mat.columns[col]);
+            result.columns[col] = Vector3A(column[0], column[1], column[2]);
+        }
+        return result;
+#endif
+    }
+
+    inline Matrix3 Matrix3A::ToMatrix3() const {
+        Matrix3 result;
+        for (int col = 0; col < 3; ++col) {
+            Vector3 column = columns[col].ToVector3();
+            result.entries[col][0] = column.x;
+            result.entries[col][1] = column.y;
+            result.entries[col][2] = column.z;
+        }
+        return result;
+    }
+
+    inline Matrix3A Matrix3A::Transpose() const {
+#ifdef MATH_SIMD_SSE
+        //4x4 transpose with a zero 4th column
+        __m128 xy01 = _mm_unpacklo_ps(columns[0].value, columns[1].value);//x0 x1 y0 y1
+        __m128 zw01 = _mm_unpackhi_ps(columns[0].value, columns[1].value);//z0 z1 0 0
+        __m128 xy2 = _mm_unpacklo_ps(columns[2].value, _mm_setzero_ps());//x2 0 y2 0
+        __m128 zw2 = _mm_unpackhi_ps(columns[2].value, _mm_setzero_ps());//z2 0 0 0
+        return Matrix3A(
+            Vector3A(_mm_movelh_ps(xy01, xy2)),
+            Vector3A(_mm_movehl_ps(xy2, xy01)),
+            Vector3A(_mm_movelh_ps(zw01, zw2)));
+#else
+        return Matrix3A(
+            Vector3A(columns[0][0], columns[1][0], columns[2][0]),
+            Vector3A(columns[0][1], columns[1][1], columns[2][1]),
+            Vector3A(columns[0][2], columns[1][2], columns[2][2]));
+#endif
+    }
+
+    //column j = ((0 + A.col0 * B[j][0]) + A.col1 * B[j][1]) + A.col2 * B[j][2]
+    inline Matrix3A Matrix3A::operator*(const Matrix3A& other) const {
+        Matrix3A result;
+        for (int j = 0; j < 3; ++j) {
+#ifdef MATH_SIMD_SSE
+            const __m128 column = other.columns[j].value;
+            __m128 sum = _mm_add_ps(_mm_setzero_ps(), _mm_mul_ps(columns[0].value, _mm_shuffle_ps(column, column, _MM_SHUFFLE(0, 0, 0, 0))));
+            sum = _mm_add_ps(sum, _mm_mul_ps(columns[1].value, _mm_shuffle_ps(column, column, _MM_SHUFFLE(1, 1, 1, 1))));
+            sum = _mm_add_ps(sum, _mm_mul_ps(columns[2].value, _mm_shuffle_ps(column, column, _MM_SHUFFLE(2, 2, 2, 2))));
+            result.columns[j] = Vector3A(sum);
+#else
+            result.columns[j] = Vector3A()
+                + columns[0] * other.columns[j][0]
+                + columns[1] * other.columns[j][1]
+                + columns[2] * other.columns[j][2];
+#endif
+        }
+        return result;
+    }
+
+    inline Matrix3A TransformInertiaTensor(const Matrix3A& rotation, const Matrix3A& inertiaTensor) {
+        return (rotation * inertiaTensor) * rotation.Transpose();
+    }
+
+    inline Matrix3A TransformDiagonalInertiaTensor(const Matrix3A& rotation, const Vector3& diagonal) {
+        Matrix3A scaled(
+            rotation.columns[0] * diagonal.x,
+            rotation.columns[1] * diagonal.y,
+            rotation.columns[2] * diagonal.z);
+        return scaled * rotation.Transpose();
+    }
+
+    inline void TransformInertiaTensors(const Matrix4* localToWorld, const Matrix3* tensors, Matrix3* results, int count) {
+        for (int i = 0; i < count; ++i) {
+            const Matrix3& tensor = tensors[i];
+            const Matrix3A rotation = Matrix3A::FromMatrix4(localToWorld[i]);
+
+            const bool isDiagonal =
+                tensor.entries[0][1] == 0.0f && tensor.entries[0][2] == 0.0f &&
+                tensor.entries[1][0] == 0.0f && tensor.entries[1][2] == 0.0f &&
+                tensor.entries[2][0] == 0.0f && tensor.entries[2][1] == 0.0f;
+            if (isDiagonal) {
+                Vector3 diagonal(tensor.entries[0][0], tensor.entries[1][1], tensor.entries[2][2]);
+                results[i] = TransformDiagonalInertiaTensor(rotation, diagonal).ToMatrix3();
+            }
+            else {
+                results[i] = TransformInertiaTensor(rotation, Matrix3A(tensor)).ToMatrix3();
+            }
+        }
+    }
+}
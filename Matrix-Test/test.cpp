@@ -5,10 +5,17 @@
 #include "matrix3_old.h"
 #include "matrix4_old.h"
 
+#include "vector3a.h"
+#include "matrix3a.h"
+#include "quaternion.h"
+#include "quaternionA.h"
+
 const float EPSILON = 1e-5f;
 const float LOOSE_EPSILON = 1e-3f;
 
 using namespace math;
+using physics::Quaternion;
+using physics::QuaternionA;
 
 TEST(Matrix3Test, Constructor_DiagonalSingleValue) {
 	Matrix3 m(7.0f);
@@ -470,6 +477,193 @@ TEST(Matrix4_Old_vs_New, Extract3x3_Multiplication) {
 	}
 }
 
+TEST(Vector3A_vs_Vector3, Arithmetic) {
+	Vector3 a{ 51.3f,-9.23f,11.5f };
+	Vector3 b{ -6.1f,0.25f,3.75f };
+	Vector3A aA{ a };
+	Vector3A bA{ b };
+
+	Vector3 sum = a + b;
+	Vector3 difference = a - b;
+	Vector3 scaled = a * -0.7f;
+	Vector3 accumulated = a;
+	accumulated += b;
+	accumulated *= 3.0f;
+	accumulated -= a;
+
+	Vector3A accumulatedA = aA;
+	accumulatedA += bA;
+	accumulatedA *= 3.0f;
+	accumulatedA -= aA;
+
+	for (int i{}; i < 3; ++i) {
+		EXPECT_FLOAT_EQ((aA + bA)[i], sum[i]);
+		EXPECT_FLOAT_EQ((aA - bA)[i], difference[i]);
+		EXPECT_FLOAT_EQ((aA * -0.7f)[i], scaled[i]);
+		EXPECT_FLOAT_EQ(accumulatedA[i], accumulated[i]);
+		EXPECT_FLOAT_EQ((-aA)[i], -a[i]);
+	}
+	EXPECT_TRUE(aA + bA == Vector3A(sum));
+	EXPECT_TRUE(aA != bA);
+}
+
+TEST(Vector3A_vs_Vector3, DotCross) {
+	Vector3 a{ 51.3f,-9.23f,11.5f };
+	Vector3 b{ -6.1f,0.25f,3.75f };
+	Vector3A aA{ a };
+	Vector3A bA{ b };
+
+	EXPECT_FLOAT_EQ(aA.Dot(bA), a.Dot(b));
+	EXPECT_FLOAT_EQ(aA.LengthSquared(), a.MagnitudeSquared());
+	EXPECT_FLOAT_EQ(aA.Length(), a.Magnitude());
+
+	Vector3 cross = a.Cross(b);
+	Vector3A crossA = aA.Cross(bA);
+	for (int i{}; i < 3; ++i) {
+		EXPECT_FLOAT_EQ(crossA[i], cross[i]);
+	}
+	EXPECT_FLOAT_EQ(crossA[3], 0.0f);//padding stays 0
+}
+
+TEST(Vector3A_vs_Vector3, Normalize) {
+	Vector3 a{ 51.3f,-9.23f,11.5f };
+	Vector3A aA{ a };
+
+	a.Normalize();
+	aA.Normalize();
+
+	Vector3 result = aA.ToVector3();
+	EXPECT_FLOAT_EQ(result.x, a.x);
+	EXPECT_FLOAT_EQ(result.y, a.y);
+	EXPECT_FLOAT_EQ(result.z, a.z);
+
+	aA.Clear();
+	EXPECT_TRUE(aA == Vector3A());
+}
+
+TEST(QuaternionA_vs_Quaternion, Multiplication) {
+	Quaternion q1{ 0.5f,-0.3f,0.8f,0.1f };
+	Quaternion q2{ -0.2f,0.7f,0.4f,-0.6f };
+
+	Quaternion r1 = q1 * q2;
+	Quaternion r2 = (QuaternionA(q1) * QuaternionA(q2)).ToQuaternion();
+	EXPECT_FLOAT_EQ(r2.w, r1.w);
+	EXPECT_FLOAT_EQ(r2.x, r1.x);
+	EXPECT_FLOAT_EQ(r2.y, r1.y);
+	EXPECT_FLOAT_EQ(r2.z, r1.z);
+
+	QuaternionA q1A{ q1 };
+	q1A *= QuaternionA(q2);
+	q1 *= q2;
+	r2 = q1A.ToQuaternion();
+	EXPECT_FLOAT_EQ(r2.w, q1.w);
+	EXPECT_FLOAT_EQ(r2.x, q1.x);
+	EXPECT_FLOAT_EQ(r2.y, q1.y);
+	EXPECT_FLOAT_EQ(r2.z, q1.z);
+}
+
+TEST(QuaternionA_vs_Quaternion, AdditionScale) {
+	Quaternion q1{ 0.5f,-0.3f,0.8f,0.1f };
+	Quaternion q2{ -0.2f,0.7f,0.4f,-0.6f };
+
+	Quaternion r1 = (q1 + q2) * 1.5f;
+	Quaternion r2 = ((QuaternionA(q1) + QuaternionA(q2)) * 1.5f).ToQuaternion();
+	EXPECT_FLOAT_EQ(r2.w, r1.w);
+	EXPECT_FLOAT_EQ(r2.x, r1.x);
+	EXPECT_FLOAT_EQ(r2.y, r1.y);
+	EXPECT_FLOAT_EQ(r2.z, r1.z);
+}
+
+TEST(QuaternionA_vs_Quaternion, Normalize) {
+	Quaternion q{ 3.0f,-1.5f,0.25f,7.0f };
+	QuaternionA qA{ q };
+	q.Normalize();
+	qA.Normalize();
+
+	Quaternion r = qA.ToQuaternion();
+	EXPECT_FLOAT_EQ(r.w, q.w);
+	EXPECT_FLOAT_EQ(r.x, q.x);
+	EXPECT_FLOAT_EQ(r.y, q.y);
+	EXPECT_FLOAT_EQ(r.z, q.z);
+
+	//zero quaternion : back to the identity
+	QuaternionA zero{ 0.0f,0.0f,0.0f,0.0f };
+	zero.Normalize();
+	r = zero.ToQuaternion();
+	EXPECT_FLOAT_EQ(r.w, 1.0f);
+	EXPECT_FLOAT_EQ(r.x, 0.0f);
+}
+
+//the orientation update of RigidBody::Integrate(), over many steps
+TEST(QuaternionA_vs_Quaternion, Integrate) {
+	const float duration = 1.0f / 60.0f;
+	Vector3 angularVelocity{ 1.9f,-0.12f,-2.5f };
+
+	Quaternion orientation{ 45.0f, Vector3{ 1.0f,2.0f,-0.5f } };
+	QuaternionA orientationA{ orientation };
+
+	for (int i{}; i < 120; ++i) {
+		orientation += orientation.RotateByScaledVector(angularVelocity, duration / 2.0f);
+		orientation.Normalize();
+
+		orientationA += orientationA.RotateByScaledVector(Vector3A(angularVelocity), duration / 2.0f);
+		orientationA.Normalize();
+	}
+
+	Quaternion r = orientationA.ToQuaternion();
+	EXPECT_NEAR(r.w, orientation.w, EPSILON);
+	EXPECT_NEAR(r.x, orientation.x, EPSILON);
+	EXPECT_NEAR(r.y, orientation.y, EPSILON);
+	EXPECT_NEAR(r.z, orientation.z, EPSILON);
+}
+
+TEST(Matrix3A_vs_Matrix3, MultiplicationTranspose) {
+	Matrix3 a = Matrix4{ -1,2,3,4,5,6,-7,8,9,10,11,12,13,-14,15,16 }.Extract3x3Matrix();
+	Matrix3 b = Matrix4{ 0.5f,-2,1.25f,0,3,0.75f,-1,0,2,-4,1.5f,0,0,0,0,1 }.Extract3x3Matrix();
+
+	Matrix3 product = (Matrix3A(a) * Matrix3A(b)).ToMatrix3();
+	Matrix3 productRef = a * b;
+	Matrix3 transpose = Matrix3A(a).Transpose().ToMatrix3();
+	Matrix3 transposeRef = a.Transpose();
+
+	for (int i{}; i < 9; ++i) {
+		EXPECT_FLOAT_EQ(product[i], productRef[i]);
+		EXPECT_FLOAT_EQ(transpose[i], transposeRef[i]);
+	}
+}
+
+//R * diag * R^T, for a rotation (the diagonal fast path) and a full tensor, vs the scalar path of the integration
+TEST(Matrix3A_vs_Matrix3, TransformInertiaTensor) {
+	Quaternion orientation{ 45.0f, Vector3{ 1.0f,2.0f,-0.5f } };
+	orientation.Normalize();
+	Matrix4 localToWorld{ 1.0f };
+	{
+		const Quaternion& q = orientation;
+		localToWorld = Matrix4{
+			1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.w * q.z), 2.0f * (q.x * q.z - q.w * q.y), 0.0f,
+			2.0f * (q.x * q.y - q.w * q.z), 1.0f - 2.0f * (q.x * q.x + q.z * q.z), 2.0f * (q.y * q.z + q.w * q.x), 0.0f,
+			2.0f * (q.x * q.z + q.w * q.y), 2.0f * (q.y * q.z - q.w * q.x), 1.0f - 2.0f * (q.x * q.x + q.y * q.y), 0.0f,
+			3.0f, -1.0f, 2.0f, 1.0f };
+	}
+	Matrix3 tensors[2];
+	tensors[0] = Matrix3{ 0.48f, 0.24f, 0.12f };//diagonal, a box
+	tensors[1] = Matrix3{ 2.0f,0.5f,-0.25f,0.5f,3.0f,0.1f,-0.25f,0.1f,4.0f };
+
+	const Matrix4 transforms[2] = { localToWorld, localToWorld };
+	Matrix3 results[2];
+	TransformInertiaTensors(transforms, tensors, results, 2);
+
+	Matrix3 rotation = localToWorld.Extract3x3Matrix();
+	for (int t{}; t < 2; ++t) {
+		Matrix3 reference = (rotation * tensors[t]) * rotation.Transpose();
+		Matrix3 single = TransformInertiaTensor(Matrix3A::FromMatrix4(localToWorld), Matrix3A(tensors[t])).ToMatrix3();
+		for (int i{}; i < 9; ++i) {
+			EXPECT_FLOAT_EQ(results[t][i], reference[i]);
+			EXPECT_FLOAT_EQ(single[i], reference[i]);
+		}
+	}
+}
+
 int main(int argc, char** argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();
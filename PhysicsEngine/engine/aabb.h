@@ -0,0 +1,43 @@
+#pragma once
+
+#include "math/vector3.h"
+#include <algorithm>//std::min, std::max
+
+namespace physics
+{
+    using math::Vector3;
+
+    //world space axis-aligned bounding box, used by the broad phase
+    struct AABB
+    {
+        Vector3 min;
+        Vector3 max;
+
+        AABB() : min{}, max{} {}
+        AABB(const Vector3& _min, const Vector3& _max) : min(_min), max(_max) {}
+
+        bool Overlaps(const AABB& other) const {
+            return min.x <= other.max.x && max.x >= other.min.x
+                && min.y <= other.max.y && max.y >= other.min.y
+                && min.z <= other.max.z && max.z >= other.min.z;
+        }
+
+        bool Contains(const AABB& other) const {
+            return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z
+                && other.max.x <= max.x && other.max.y <= max.y && other.max.z <= max.z;
+        }
+
+        //the tree insertion cost only compares areas, so the factor 2 is dropped
+        float HalfSurfaceArea() const {
+            Vector3 size = max - min;
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+
+        AABB Union(const AABB& other) const {
+            return {
+                { std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z) },
+                { std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z) }
+            };
+        }
+    };
+}
@@ -0,0 +1,32 @@
+#include "stepStats.h"
+#include <cstdlib>//std::malloc, std::free
+#include <new>//std::bad_alloc, std::get_new_handler
+
+//Replaces the global operator new to feed StepStats::heapAllocations. Not part of PhysicsCore :
+//only the executables that report the allocations (Headless-Runner) compile it in.
+
+//the array and nothrow forms call this one, the aligned forms (alignas > 16) are not counted
+void* operator new(std::size_t size){
+    physics::CountHeapAllocation();
+    if (size == 0) {
+        size = 1;
+    }
+    while (true) {
+        if (void* memory = std::malloc(size)) {
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* memory) noexcept{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept{
+    std::free(memory);
+}
@@ -6,42 +6,47 @@ using namespace physics;
 
 void RigidBody::Integrate(float duration)
 {
-    if (massInverse == 0.0f) {
-        return;
+    const int idx = Index();
+    storage->Integrate(idx, idx + 1, duration);
+}
+
+void RigidBody::SetAwake(bool awake){
+    const int idx = Index();
+    storage->awakeFlags[idx] = awake;
+    storage->sleepTimes[idx] = 0.0f;
+    if (awake == false) {
+        storage->velocities[idx].Clear();
+        storage->angularVelocities[idx].Clear();
+        storage->forces[idx].Clear();
+        storage->torques[idx].Clear();
     }
+}
 
-    //1. linear Velocity
-    Vector3 linearAcceleration = force * massInverse;
-    velocity += linearAcceleration * duration;
-    velocity *= powf(linearDamping, duration);
-
-    //2. angular Velocity
-    Vector3 angularAcceleration = inverseInertiaTensorWorld * torque;
-    angularVelocity += angularAcceleration * duration;
-    angularVelocity *= powf(angularDamping, duration);
-
-    //3.Pos, Orientation
-    position += velocity * duration;
-    orientation += orientation.RotateByScaledVector(angularVelocity, duration / 2.0f);
-    orientation.Normalize();    
-
-    //5.update accordingly
-    UpdateTransformMatrix();
-    TransformInertiaTensor();
+void RigidBody::LoadSolverBody(SolverBody& body) const{
+    const int idx = Index();
+    body.position = storage->positions[idx];
+    body.velocity = storage->velocities[idx];
+    body.angularVelocity = storage->localToWorldMatrices[idx].Extract3x3Matrix().Transpose() * storage->angularVelocities[idx];
+    body.inverseInertiaTensorWorld = storage->inverseInertiaTensorsWorld[idx];
+    body.inverseMass = storage->inverseMasses[idx];
+}
 
-    force.Clear();
-    torque.Clear();
+void RigidBody::StoreSolverBody(const SolverBody& body){
+    const int idx = Index();
+    storage->velocities[idx] = body.velocity;
+    storage->angularVelocities[idx] = storage->localToWorldMatrices[idx].Extract3x3Matrix() * body.angularVelocity;
 }
 
 void RigidBody::AddForce(const Vector3& _force){
-    force += _force;
+    storage->forces[Index()] += _force;
 }
 
 void RigidBody::AddForceAt(const Vector3& _force, const Vector3& point)
 {
-    force += _force;
-    Vector3 pointFromCenter = point - position;
-    torque += pointFromCenter.Cross(_force);
+    const int idx = Index();
+    storage->forces[idx] += _force;
+    Vector3 pointFromCenter = point - storage->positions[idx];
+    storage->torques[idx] += pointFromCenter.Cross(_force);
 }
 
 Vector3 RigidBody::GetAxis(int index) const
@@ -50,6 +55,7 @@ Vector3 RigidBody::GetAxis(int index) const
         throw std::runtime_error("RigidBody::getAxis(): index, out of bounds\n");
     }
 
+    const Matrix4& localToWorldCoord = storage->localToWorldMatrices[Index()];
     Vector3 result(
         localToWorldCoord[index*4],
         localToWorldCoord[index*4 + 1],
@@ -67,152 +73,118 @@ void RigidBody::RotateByQuat(const Quaternion& quat)
     SetOrientation(newOrientation);
 }
 
-void RigidBody::UpdateTransformMatrix()
-{
-    // First column
-    localToWorldCoord.columns[0].m128_f32[0] = 1.0f - 2.0f * (orientation.y * orientation.y + orientation.z * orientation.z);
-    localToWorldCoord.columns[0].m128_f32[1] = 2.0f * (orientation.x * orientation.y + orientation.w * orientation.z);
-    localToWorldCoord.columns[0].m128_f32[2] = 2.0f * (orientation.x * orientation.z - orientation.w * orientation.y);
-    localToWorldCoord.columns[0].m128_f32[3] = 0.0f; // Assuming homogeneous coordinate for direction vectors is 0
-
-    // Second column
-    localToWorldCoord.columns[1].m128_f32[0] = 2.0f * (orientation.x * orientation.y - orientation.w * orientation.z);
-    localToWorldCoord.columns[1].m128_f32[1] = 1.0f - 2.0f * (orientation.x * orientation.x + orientation.z * orientation.z);
-    localToWorldCoord.columns[1].m128_f32[2] = 2.0f * (orientation.y * orientation.z + orientation.w * orientation.x);
-    localToWorldCoord.columns[1].m128_f32[3] = 0.0f; // Assuming homogeneous coordinate for direction vectors is 0
-
-    // Third column
-    localToWorldCoord.columns[2].m128_f32[0] = 2.0f * (orientation.x * orientation.z + orientation.w * orientation.y);
-    localToWorldCoord.columns[2].m128_f32[1] = 2.0f * (orientation.y * orientation.z - orientation.w * orientation.x);
-    localToWorldCoord.columns[2].m128_f32[2] = 1.0f - 2.0f * (orientation.x * orientation.x + orientation.y * orientation.y);
-    localToWorldCoord.columns[2].m128_f32[3] = 0.0f; // Assuming homogeneous coordinate for direction vectors is 0
-
-    // Fourth column (position)
-    localToWorldCoord.columns[3].m128_f32[0] = position[0];
-    localToWorldCoord.columns[3].m128_f32[1] = position[1];
-    localToWorldCoord.columns[3].m128_f32[2] = position[2];
-    localToWorldCoord.columns[3].m128_f32[3] = 1.0f; // Homogeneous coordinate for position is 1
-}
-
-void RigidBody::TransformInertiaTensor()
-{
-    Matrix3 rotationMatrix=localToWorldCoord.Extract3x3Matrix();
-    inverseInertiaTensorWorld = (rotationMatrix * inverseInertiaTensor) * rotationMatrix.Transpose();
-}
-
 void RigidBody::SetMass(float value)
 {
-    massInverse = 1.0f / value;
+    storage->inverseMasses[Index()] = 1.0f / value;
 }
 
 void RigidBody::SetInverseMass(float value)
 {
-    massInverse = value;
+    storage->inverseMasses[Index()] = value;
 }
 
 void RigidBody::SetInertiaTensor(const Matrix3& mat)
 {
-    inverseInertiaTensor = mat.Inverse();
-    TransformInertiaTensor();
+    const int idx = Index();
+    storage->inverseInertiaTensors[idx] = mat.Inverse();
+    storage->TransformInertiaTensor(idx);
 }
 
 void RigidBody::SetInverseInertiaTensor(const Matrix3& mat)
 {
-    inverseInertiaTensor = mat;
-    TransformInertiaTensor();
+    const int idx = Index();
+    storage->inverseInertiaTensors[idx] = mat;
+    storage->TransformInertiaTensor(idx);
 }
 
 void RigidBody::SetPosition(const Vector3& vec)
 {
-    position = vec;
-    UpdateTransformMatrix();
+    const int idx = Index();
+    storage->positions[idx] = vec;
+    storage->UpdateTransformMatrix(idx);
 }
 
 void RigidBody::SetPosition(float x, float y, float z)
 {
-    position.x = x;
-    position.y = y;
-    position.z = z;
-    UpdateTransformMatrix();
+    SetPosition(Vector3(x, y, z));
 }
 
 void RigidBody::SetOrientation(const Quaternion& quat)
 {
-    orientation = quat;
-    UpdateTransformMatrix();
-    TransformInertiaTensor();
+    const int idx = Index();
+    storage->orientations[idx] = quat;
+    storage->UpdateTransformMatrix(idx);
+    storage->TransformInertiaTensor(idx);
 }
 
 void RigidBody::SetLinearVelocity(const Vector3& vec)
 {
-    velocity = vec;
+    storage->velocities[Index()] = vec;
 }
 
 void RigidBody::SetLinearVelocity(float x, float y, float z)
 {
-    velocity.x = x;
-    velocity.y = y;
-    velocity.z = z;
+    SetLinearVelocity(Vector3(x, y, z));
 }
 
 void RigidBody::SetAngularVelocity(const Vector3& vec){
-    angularVelocity = localToWorldCoord.Extract3x3Matrix() * vec;
+    const int idx = Index();
+    storage->angularVelocities[idx] = storage->localToWorldMatrices[idx].Extract3x3Matrix() * vec;
 }
 
 void RigidBody::SetAngularVelocity(float x, float y, float z){
-    angularVelocity = localToWorldCoord.Extract3x3Matrix() * Vector3(x, y, z);
+    SetAngularVelocity(Vector3(x, y, z));
 }
 
 void RigidBody::SetLinearAcceleration(const Vector3& vec){
-    linearAcceleration = vec;
+    storage->linearAccelerations[Index()] = vec;
 }
 
 void RigidBody::SetLinearAcceleration(float x, float y, float z){
-    linearAcceleration.x = x;
-    linearAcceleration.y = y;
-    linearAcceleration.z = z;
+    SetLinearAcceleration(Vector3(x, y, z));
 }
 
 void RigidBody::SetLinearDamping(float value){
-    linearDamping = value;
+    storage->linearDampings[Index()] = value;
 }
 
 float RigidBody::GetMass() const{
-    return 1.0f / massInverse;
+    return 1.0f / storage->inverseMasses[Index()];
 }
 
 float RigidBody::GetInverseMass() const{
-    return massInverse;
+    return storage->inverseMasses[Index()];
 }
 
 Matrix3 RigidBody::GetInverseInertiaTensor() const{
-    return inverseInertiaTensor;
+    return storage->inverseInertiaTensors[Index()];
 }
 
 Matrix3 RigidBody::GetInverseInertiaTensorWorld() const{
-    return inverseInertiaTensorWorld;
+    return storage->inverseInertiaTensorsWorld[Index()];
 }
 
 Vector3 RigidBody::GetPosition() const{
-    return position;
+    return storage->positions[Index()];
 }
 
 Vector3 RigidBody::GetLinearVelocity() const{
-    return velocity;
+    return storage->velocities[Index()];
 }
 
 Vector3 RigidBody::GetAngularVelocity() const{
-    return localToWorldCoord.Extract3x3Matrix().Transpose() * angularVelocity;
+    const int idx = Index();
+    return storage->localToWorldMatrices[idx].Extract3x3Matrix().Transpose() * storage->angularVelocities[idx];
 }
 
 Vector3 RigidBody::GetAcceleration() const{
-    return linearAcceleration;
+    return storage->linearAccelerations[Index()];
 }
 
 float RigidBody::GetLinearDamping() const{
-    return linearDamping;
+    return storage->linearDampings[Index()];
 }
 
 Matrix4 RigidBody::GetLocalToWorldMatrix() const{
-    return localToWorldCoord;
+    return storage->localToWorldMatrices[Index()];
 }
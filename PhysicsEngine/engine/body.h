@@ -4,6 +4,7 @@
 #include "math/matrix3.h"
 #include "math/matrix4.h"
 #include "quaternion.h"
+#include "bodyStorage.h"
 
 namespace physics
 {
@@ -11,39 +12,49 @@ namespace physics
     using math::Matrix4;
     using math::Vector3;
 
-    class RigidBody
+    //what the sequential solver reads of a body, copied out of the storage once per manifold
+    struct SolverBody
     {
-    protected:        
-
-        Matrix3 inverseInertiaTensor; //local
-        Matrix3 inverseInertiaTensorWorld; //world
-        Matrix4 localToWorldCoord;
-
         Vector3 position;
-        Quaternion orientation;
         Vector3 velocity;
-        Vector3 angularVelocity;
-        Vector3 linearAcceleration;
-        Vector3 force;
-        Vector3 torque;
+        Vector3 angularVelocity;//as GetAngularVelocity()
+        Matrix3 inverseInertiaTensorWorld;
+        float inverseMass;
+    };
 
-        float massInverse;
-        float linearDamping;
-        float angularDamping;
+    //A view of one body of a BodyStorage, the state itself lives in the storage's arrays.
+    //The address stays the same for the lifetime of the body (colliders, manifolds and caches keep pointers to it).
+    class RigidBody
+    {
+    private:
+        BodyStorage* storage;
+        BodyHandle handle;
 
     public:
-        RigidBody() : massInverse{0.f},linearDamping(0.99f), angularDamping(0.7f) {}
+        explicit RigidBody(BodyStorage& _storage) : storage{ &_storage }, handle{ _storage.Create() } {}
+        ~RigidBody() { storage->Destroy(handle); }
+        RigidBody(const RigidBody&) = delete;
+        RigidBody& operator=(const RigidBody&) = delete;
+
+        BodyHandle GetHandle() const { return handle; }
 
         void Integrate(float duration);
         void AddForceAt(const Vector3& force, const Vector3& point);
         void AddForce(const Vector3& force);
         Vector3 GetAxis(int index) const;
         void RotateByQuat(const Quaternion&);
-        bool IsFixed() {return massInverse == 0.0f ? true : false;}
+        bool IsFixed() const { return storage->inverseMasses[Index()] == 0.0f; }
+        bool IsAwake() const { return storage->awakeFlags[Index()] != 0; }
+        void SetAwake(bool awake);//a sleeping body keeps no velocity and is not integrated
+        float GetSleepTime() const { return storage->sleepTimes[Index()]; }
+        void SetSleepTime(float value) { storage->sleepTimes[Index()] = value; }
+
+        //one index lookup each, instead of one per getter/setter. Only the velocities are stored back
+        void LoadSolverBody(SolverBody& body) const;
+        void StoreSolverBody(const SolverBody& body);
 
-    private:    
-        void UpdateTransformMatrix();
-        void TransformInertiaTensor();
+    private:
+        int Index() const { return storage->GetIndex(handle); }
 
     public:
         void SetMass(float value);
@@ -73,7 +84,7 @@ namespace physics
         Matrix3 GetInverseInertiaTensor() const;
         Matrix3 GetInverseInertiaTensorWorld() const;
         Vector3 GetPosition() const;
-        Quaternion GetOrientation() const { return orientation; }
+        Quaternion GetOrientation() const { return storage->orientations[Index()]; }
         Vector3 GetLinearVelocity() const;
         Vector3 GetAngularVelocity() const;
         Vector3 GetAcceleration() const;
@@ -0,0 +1,243 @@
+#include "bodyStorage.h"
+#include "quaternionA.h"
+#include "math/matrix3a.h"
+#include <cmath>
+#include <stdexcept>
+#include <utility>//std::swap
+
+using namespace physics;
+
+BodyHandle BodyStorage::Create(){
+    BodyHandle handle;
+    if (freeHandles.empty() == false) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else {
+        handle = static_cast<BodyHandle>(indices.size());
+        indices.push_back(-1);
+    }
+
+    indices[handle] = GetCount();
+    handles.push_back(handle);
+
+    positions.emplace_back();
+    orientations.emplace_back();
+    velocities.emplace_back();
+    angularVelocities.emplace_back();
+    linearAccelerations.emplace_back();
+    forces.emplace_back();
+    torques.emplace_back();
+
+    inverseMasses.push_back(0.0f);
+    inverseInertiaTensors.emplace_back();
+    inverseInertiaTensorsWorld.emplace_back();
+    localToWorldMatrices.emplace_back();
+
+    linearDampings.push_back(0.99f);
+    angularDampings.push_back(0.7f);
+    awakeFlags.push_back(true);
+    sleepTimes.push_back(0.0f);
+
+    return handle;
+}
+
+void BodyStorage::Destroy(BodyHandle handle){
+    if (handle < 0 || handle >= static_cast<BodyHandle>(indices.size()) || indices[handle] < 0) {
+        throw std::runtime_error("BodyStorage::Destroy(), invalid handle");
+    }
+    SetSimulated(handle, false);
+    SwapBodies(indices[handle], GetCount() - 1);
+
+    positions.pop_back();
+    orientations.pop_back();
+    velocities.pop_back();
+    angularVelocities.pop_back();
+    linearAccelerations.pop_back();
+    forces.pop_back();
+    torques.pop_back();
+
+    inverseMasses.pop_back();
+    inverseInertiaTensors.pop_back();
+    inverseInertiaTensorsWorld.pop_back();
+    localToWorldMatrices.pop_back();
+
+    linearDampings.pop_back();
+    angularDampings.pop_back();
+    awakeFlags.pop_back();
+    sleepTimes.pop_back();
+
+    handles.pop_back();
+    indices[handle] = -1;
+    freeHandles.push_back(handle);
+}
+
+void BodyStorage::SetSimulated(BodyHandle handle, bool isSimulated){
+    if (IsSimulated(handle) == isSimulated) {
+        return;
+    }
+    if (isSimulated) {
+        SwapBodies(indices[handle], simulatedCount);
+        ++simulatedCount;
+    }
+    else {
+        --simulatedCount;
+        SwapBodies(indices[handle], simulatedCount);
+    }
+}
+
+void BodyStorage::ApplyGravity(int begin, int end, float gravity){
+    for (int i = begin; i < end; ++i) {
+        if (inverseMasses[i] == 0.0f || awakeFlags[i] == false) {
+            continue;
+        }
+        forces[i] += Vector3{ 0.f,-gravity,0.f } * (1.0f / inverseMasses[i]);
+    }
+}
+
+int BodyStorage::Integrate(int begin, int end, float duration){
+    int integratedCount{};
+    for (int i = begin; i < end; ++i) {
+        integratedCount += IntegrateMotion(i, duration) ? 1 : 0;
+    }
+    if (begin == end) {
+        return 0;
+    }
+    //one batch for the range : the tensors of the skipped (fixed, sleeping) bodies come out unchanged
+    math::TransformInertiaTensors(&localToWorldMatrices[begin], &inverseInertiaTensors[begin], &inverseInertiaTensorsWorld[begin], end - begin);
+    return integratedCount;
+}
+
+int BodyStorage::IntegrateVelocities(int begin, int end, float duration){
+    int integratedCount{};
+    for (int i = begin; i < end; ++i) {
+        integratedCount += IntegrateVelocity(i, duration) ? 1 : 0;
+    }
+    return integratedCount;
+}
+
+void BodyStorage::IntegratePositions(int begin, int end, float duration){
+    if (begin == end) {
+        return;
+    }
+    for (int i = begin; i < end; ++i) {
+        if (inverseMasses[i] != 0.0f && awakeFlags[i]) {
+            IntegratePosition(i, duration);
+        }
+    }
+    math::TransformInertiaTensors(&localToWorldMatrices[begin], &inverseInertiaTensors[begin], &inverseInertiaTensorsWorld[begin], end - begin);
+}
+
+void BodyStorage::ClearForces(int begin, int end){
+    for (int i = begin; i < end; ++i) {
+        forces[i].Clear();
+        torques[i].Clear();
+    }
+}
+
+bool BodyStorage::IntegrateMotion(int index, float duration){
+    if (IntegrateVelocity(index, duration) == false) {
+        return false;
+    }
+    IntegratePosition(index, duration);
+
+    forces[index].Clear();
+    torques[index].Clear();
+    return true;
+}
+
+bool BodyStorage::IntegrateVelocity(int index, float duration){
+    const float massInverse = inverseMasses[index];
+    if (massInverse == 0.0f || awakeFlags[index] == false) {
+        return false;
+    }
+    Vector3& velocity = velocities[index];
+    Vector3& angularVelocity = angularVelocities[index];
+
+    //1. linear Velocity
+    Vector3 linearAcceleration = forces[index] * massInverse;
+    velocity += linearAcceleration * duration;
+    velocity *= powf(linearDampings[index], duration);
+
+    //2. angular Velocity
+    Vector3 angularAcceleration = inverseInertiaTensorsWorld[index] * torques[index];
+    angularVelocity += angularAcceleration * duration;
+    angularVelocity *= powf(angularDampings[index], duration);
+    return true;
+}
+
+void BodyStorage::IntegratePosition(int index, float duration){
+    const Vector3& velocity = velocities[index];
+    const Vector3& angularVelocity = angularVelocities[index];
+
+    //3.Pos, Orientation
+    positions[index] += velocity * duration;
+    QuaternionA orientation(orientations[index]);
+    orientation += orientation.RotateByScaledVector(Vector3A(angularVelocity), duration / 2.0f);
+    orientation.Normalize();
+    orientations[index] = orientation.ToQuaternion();
+
+    //5.update accordingly (the inertia tensor in Integrate(), batched)
+    UpdateTransformMatrix(index);
+}
+
+void BodyStorage::UpdateTransformMatrix(int index){
+    const Quaternion& orientation = orientations[index];
+    const Vector3& position = positions[index];
+    Matrix4& localToWorldCoord = localToWorldMatrices[index];
+
+    // First column
+    localToWorldCoord.columns[0].m128_f32[0] = 1.0f - 2.0f * (orientation.y * orientation.y + orientation.z * orientation.z);
+    localToWorldCoord.columns[0].m128_f32[1] = 2.0f * (orientation.x * orientation.y + orientation.w * orientation.z);
+    localToWorldCoord.columns[0].m128_f32[2] = 2.0f * (orientation.x * orientation.z - orientation.w * orientation.y);
+    localToWorldCoord.columns[0].m128_f32[3] = 0.0f; // Assuming homogeneous coordinate for direction vectors is 0
+
+    // Second column
+    localToWorldCoord.columns[1].m128_f32[0] = 2.0f * (orientation.x * orientation.y - orientation.w * orientation.z);
+    localToWorldCoord.columns[1].m128_f32[1] = 1.0f - 2.0f * (orientation.x * orientation.x + orientation.z * orientation.z);
+    localToWorldCoord.columns[1].m128_f32[2] = 2.0f * (orientation.y * orientation.z + orientation.w * orientation.x);
+    localToWorldCoord.columns[1].m128_f32[3] = 0.0f; // Assuming homogeneous coordinate for direction vectors is 0
+
+    // Third column
+    localToWorldCoord.columns[2].m128_f32[0] = 2.0f * (orientation.x * orientation.z + orientation.w * orientation.y);
+    localToWorldCoord.columns[2].m128_f32[1] = 2.0f * (orientation.y * orientation.z - orientation.w * orientation.x);
+    localToWorldCoord.columns[2].m128_f32[2] = 1.0f - 2.0f * (orientation.x * orientation.x + orientation.y * orientation.y);
+    localToWorldCoord.columns[2].m128_f32[3] = 0.0f; // Assuming homogeneous coordinate for direction vectors is 0
+
+    // Fourth column (position)
+    localToWorldCoord.columns[3].m128_f32[0] = position[0];
+    localToWorldCoord.columns[3].m128_f32[1] = position[1];
+    localToWorldCoord.columns[3].m128_f32[2] = position[2];
+    localToWorldCoord.columns[3].m128_f32[3] = 1.0f; // Homogeneous coordinate for position is 1
+}
+
+void BodyStorage::TransformInertiaTensor(int index){
+    math::TransformInertiaTensors(&localToWorldMatrices[index], &inverseInertiaTensors[index], &inverseInertiaTensorsWorld[index], 1);
+}
+
+void BodyStorage::SwapBodies(int index1, int index2){
+    if (index1 == index2) {
+        return;
+    }
+    std::swap(positions[index1], positions[index2]);
+    std::swap(orientations[index1], orientations[index2]);
+    std::swap(velocities[index1], velocities[index2]);
+    std::swap(angularVelocities[index1], angularVelocities[index2]);
+    std::swap(linearAccelerations[index1], linearAccelerations[index2]);
+    std::swap(forces[index1], forces[index2]);
+    std::swap(torques[index1], torques[index2]);
+
+    std::swap(inverseMasses[index1], inverseMasses[index2]);
+    std::swap(inverseInertiaTensors[index1], inverseInertiaTensors[index2]);
+    std::swap(inverseInertiaTensorsWorld[index1], inverseInertiaTensorsWorld[index2]);
+    std::swap(localToWorldMatrices[index1], localToWorldMatrices[index2]);
+
+    std::swap(linearDampings[index1], linearDampings[index2]);
+    std::swap(angularDampings[index1], angularDampings[index2]);
+    std::swap(awakeFlags[index1], awakeFlags[index2]);
+    std::swap(sleepTimes[index1], sleepTimes[index2]);
+
+    std::swap(handles[index1], handles[index2]);
+    indices[handles[index1]] = index1;
+    indices[handles[index2]] = index2;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "math/vector3.h"
+#include "math/matrix3.h"
+#include "math/matrix4.h"
+#include "quaternion.h"
+#include <vector>
+
+namespace physics
+{
+    using math::Matrix3;
+    using math::Matrix4;
+    using math::Vector3;
+
+    typedef int BodyHandle;//stays valid while the body exists, whatever happens to the others
+
+    //State of every rigid body, one contiguous array per field so that the per-body loops stream through memory.
+    //The arrays are dense : a removed body is replaced by the last one, handles map to the current index.
+    //[0, simulatedCount) are the bodies of the world, the rest are created but not added yet (e.g. spawner pools).
+    class BodyStorage
+    {
+    public:
+        friend class RigidBody;
+
+        static constexpr BodyHandle INVALID_HANDLE = -1;
+
+    private:
+        std::vector<Vector3> positions;
+        std::vector<Quaternion> orientations;
+        std::vector<Vector3> velocities;
+        std::vector<Vector3> angularVelocities;//world
+        std::vector<Vector3> linearAccelerations;
+        std::vector<Vector3> forces;
+        std::vector<Vector3> torques;
+
+        std::vector<float> inverseMasses;
+        std::vector<Matrix3> inverseInertiaTensors;//local
+        std::vector<Matrix3> inverseInertiaTensorsWorld;
+        std::vector<Matrix4> localToWorldMatrices;
+
+        std::vector<float> linearDampings;
+        std::vector<float> angularDampings;
+        std::vector<char> awakeFlags;//not vector<bool> : the integration threads write neighbouring bodies
+        std::vector<float> sleepTimes;
+
+        std::vector<int> indices;//by handle, -1 for a free handle
+        std::vector<BodyHandle> handles;//by index
+        std::vector<BodyHandle> freeHandles;
+        int simulatedCount;
+
+    public:
+        BodyStorage() : simulatedCount{ 0 } {}
+
+        BodyHandle Create();
+        void Destroy(BodyHandle handle);
+
+        //moves the body in/out of the simulated range
+        void SetSimulated(BodyHandle handle, bool isSimulated);
+        bool IsSimulated(BodyHandle handle) const { return indices[handle] < simulatedCount; }
+
+        int GetIndex(BodyHandle handle) const { return indices[handle]; }
+        int GetCount() const { return static_cast<int>(handles.size()); }
+        int GetSimulatedCount() const { return simulatedCount; }
+
+        //loops over the indices [begin, end), fixed and sleeping bodies are skipped
+        void ApplyGravity(int begin, int end, float gravity);
+        int Integrate(int begin, int end, float duration);//returns the number of bodies moved
+
+        //Integrate() in two halves for the substeps, the forces stay until ClearForces()
+        int IntegrateVelocities(int begin, int end, float duration);//returns the number of bodies moved
+        void IntegratePositions(int begin, int end, float duration);
+        void ClearForces(int begin, int end);
+
+    private:
+        bool IntegrateMotion(int index, float duration);
+        bool IntegrateVelocity(int index, float duration);
+        void IntegratePosition(int index, float duration);
+        void UpdateTransformMatrix(int index);
+        void TransformInertiaTensor(int index);
+        void SwapBodies(int index1, int index2);
+    };
+}
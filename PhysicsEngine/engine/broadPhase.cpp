@@ -0,0 +1,44 @@
+#include "broadPhase.h"
+#include "sweepAndPrune.h"
+#include "dynamicAABBTree.h"
+#include "spatialHashGrid.h"
+#include <algorithm>//std::find
+#include <stdexcept>
+
+using namespace physics;
+
+void BruteForceBroadPhase::AddObject(RigidObject* obj){
+    objects.push_back(obj);
+}
+
+void BruteForceBroadPhase::RemoveObject(RigidObject* obj){
+    auto itr = std::find(objects.begin(), objects.end(), obj);
+    if (itr != objects.end()) {
+        objects.erase(itr);
+    }
+}
+
+void BruteForceBroadPhase::ComputePairs(std::vector<ObjectPair>& pairs){
+    pairs.clear();
+    for (auto i = objects.begin(); i != objects.end(); ++i) {
+        for (auto j = std::next(i, 1); j != objects.end(); ++j) {
+            pairs.emplace_back(*i, *j);
+        }
+    }
+}
+
+std::unique_ptr<BroadPhase> physics::CreateBroadPhase(BroadPhaseType type){
+    switch (type)
+    {
+    case BroadPhaseType::BRUTE_FORCE:
+        return std::make_unique<BruteForceBroadPhase>();
+    case BroadPhaseType::SWEEP_AND_PRUNE:
+        return std::make_unique<SweepAndPrune>();
+    case BroadPhaseType::DYNAMIC_AABB_TREE:
+        return std::make_unique<DynamicAABBTree>();
+    case BroadPhaseType::SPATIAL_HASH_GRID:
+        return std::make_unique<SpatialHashGrid>();
+    default:
+        throw std::runtime_error("CreateBroadPhase(), unknown broad phase type");
+    }
+}
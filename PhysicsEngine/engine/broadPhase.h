@@ -0,0 +1,53 @@
+#pragma once
+
+#include "simulator/object.h"
+#include <memory>//std::unique_ptr
+#include <vector>
+#include <utility>//std::pair
+
+namespace physics
+{
+    enum class BroadPhaseType
+    {
+        BRUTE_FORCE,
+        SWEEP_AND_PRUNE,
+        DYNAMIC_AABB_TREE,
+        SPATIAL_HASH_GRID
+    };
+
+    typedef std::pair<RigidObject*, RigidObject*> ObjectPair;
+
+    //Collects the candidate pairs that are handed over to the narrow phase (FindCollisionFeatures).
+    //pairs are always reported with the earlier registered object first, so that a manifold's two bodies
+    //are in the same order no matter which broad phase produced the pair. The order of the pair list
+    //itself is up to each broad phase and differs between them, but is the same from run to run.
+    class BroadPhase
+    {
+    public:
+        virtual ~BroadPhase() {}
+
+        virtual BroadPhaseType GetType() const = 0;
+
+        virtual void AddObject(RigidObject* obj) = 0;
+        virtual void RemoveObject(RigidObject* obj) = 0;//no-op for unregistered objects
+
+        //refreshes the bounds of every object, then fills 'pairs' (cleared first)
+        virtual void ComputePairs(std::vector<ObjectPair>& pairs) = 0;
+    };
+
+    //tests every object against every other object, kept as the reference for benchmarks
+    class BruteForceBroadPhase : public BroadPhase
+    {
+    private:
+        std::vector<RigidObject*> objects;
+
+    public:
+        BroadPhaseType GetType() const override { return BroadPhaseType::BRUTE_FORCE; }
+
+        void AddObject(RigidObject* obj) override;
+        void RemoveObject(RigidObject* obj) override;
+        void ComputePairs(std::vector<ObjectPair>& pairs) override;
+    };
+
+    std::unique_ptr<BroadPhase> CreateBroadPhase(BroadPhaseType type);
+}
@@ -1,11 +1,13 @@
 ﻿#include "collider.h"
 #include <cstdarg>
+#include <cmath>//std::abs
+#include <algorithm>//std::min,max
 
 using namespace physics;
 
 SphereCollider::SphereCollider(RigidBody* _body, float _radius)
+	: Collider(_body, ShapeType::SPHERE)
 {
-	rigidBody = _body;
 	radius = _radius;
 }
 
@@ -14,9 +16,21 @@ void SphereCollider::SetScale(double value, ...)
 	radius = value;
 }
 
+AABB SphereCollider::ComputeAABB() const
+{
+	Vector3 center = rigidBody->GetPosition();
+	Vector3 halfSize{ radius, radius, radius };
+	return { center - halfSize, center + halfSize };
+}
+
+Vector3 SphereCollider::GetSupport(const Vector3&) const
+{
+	return rigidBody->GetPosition();//the radius is the margin
+}
+
 BoxCollider::BoxCollider(RigidBody* _body, float _halfX, float _halfY, float _halfZ)
+	: Collider(_body, ShapeType::BOX)
 {
-	rigidBody = _body;
 	extents.x = _halfX;
 	extents.y = _halfY;
 	extents.z = _halfZ;
@@ -35,6 +49,32 @@ void BoxCollider::SetScale(double value, ...)
 	va_end(args);
 }
 
+AABB BoxCollider::ComputeAABB() const
+{
+	//projects the (rotated) extents onto the world axes
+	Vector3 halfSize;
+	for (int i = 0; i < 3; ++i) {
+		Vector3 axis = rigidBody->GetAxis(i) * extents[i];
+		halfSize.x += std::abs(axis.x);
+		halfSize.y += std::abs(axis.y);
+		halfSize.z += std::abs(axis.z);
+	}
+	Vector3 center = rigidBody->GetPosition();
+	return { center - halfSize, center + halfSize };
+}
+
+Vector3 BoxCollider::GetSupport(const Vector3& direction) const
+{
+	//Extract3x3Matrix() is stored transposed : it takes the direction to local space
+	Matrix4 localToWorld = rigidBody->GetLocalToWorldMatrix();
+	Vector3 localDirection = localToWorld.Extract3x3Matrix() * direction;
+	Vector3 vertex{
+		localDirection.x < 0.0f ? -extents.x : extents.x,
+		localDirection.y < 0.0f ? -extents.y : extents.y,
+		localDirection.z < 0.0f ? -extents.z : extents.z };
+	return localToWorld * vertex;
+}
+
 Vector3 physics::BoxCollider::GetLocalContactVertex(Vector3 collisionNormal, std::function<bool(float, float)> cmp) const {
 	Vector3 contactPoint{  extents.x,  extents.y,  extents.z };
 
@@ -50,7 +90,84 @@ Vector3 physics::BoxCollider::GetLocalContactVertex(Vector3 collisionNormal, std
 	return contactPoint;
 }
 
+CapsuleCollider::CapsuleCollider(RigidBody* _body, float _radius, float _halfHeight)
+	: Collider(_body, ShapeType::CAPSULE)
+{
+	radius = _radius;
+	halfHeight = _halfHeight;
+}
+
+void CapsuleCollider::SetScale(double value, ...)
+{
+	radius = value;
+
+	va_list args;
+	va_start(args, value);
+	halfHeight = va_arg(args, double);
+	va_end(args);
+}
+
+AABB CapsuleCollider::ComputeAABB() const
+{
+	Vector3 start, end;
+	GetSegment(start, end);
+	Vector3 halfSize{ radius, radius, radius };
+	return {
+		Vector3(std::min(start.x, end.x), std::min(start.y, end.y), std::min(start.z, end.z)) - halfSize,
+		Vector3(std::max(start.x, end.x), std::max(start.y, end.y), std::max(start.z, end.z)) + halfSize };
+}
+
+Vector3 CapsuleCollider::GetSupport(const Vector3& direction) const
+{
+	Vector3 axis = rigidBody->GetAxis(1) * halfHeight;
+	return axis.Dot(direction) < 0.0f ? rigidBody->GetPosition() - axis : rigidBody->GetPosition() + axis;
+}
+
+void CapsuleCollider::GetSegment(Vector3& start, Vector3& end) const
+{
+	Vector3 axis = rigidBody->GetAxis(1) * halfHeight;
+	start = rigidBody->GetPosition() - axis;
+	end = rigidBody->GetPosition() + axis;
+}
+
+ConvexHullCollider::ConvexHullCollider(RigidBody* _body, std::shared_ptr<const ConvexHull> _hull)
+	: Collider(_body, ShapeType::CONVEX_HULL)
+{
+	hull = std::move(_hull);
+	scale = 1.0f;
+}
+
+void ConvexHullCollider::SetScale(double value, ...)
+{
+	scale = value;
+}
+
+AABB ConvexHullCollider::ComputeAABB() const
+{
+	//the supports along the world axes, the matrix computed once
+	Matrix4 localToWorld = rigidBody->GetLocalToWorldMatrix();
+	Matrix3 worldToLocal = localToWorld.Extract3x3Matrix();
+	const std::vector<Vector3>& vertices = hull->GetVertices();
+	Vector3 min, max;
+	for (int i = 0; i < 3; ++i) {
+		Vector3 axis;
+		axis[i] = 1.0f;
+		Vector3 localAxis = worldToLocal * axis;
+		max[i] = (localToWorld * (vertices[hull->GetSupportVertex(localAxis)] * scale))[i];
+		min[i] = (localToWorld * (vertices[hull->GetSupportVertex(-localAxis)] * scale))[i];
+	}
+	return { min, max };
+}
+
+Vector3 ConvexHullCollider::GetSupport(const Vector3& direction) const
+{
+	Matrix4 localToWorld = rigidBody->GetLocalToWorldMatrix();
+	Vector3 localDirection = localToWorld.Extract3x3Matrix() * direction;
+	return localToWorld * (hull->GetVertices()[hull->GetSupportVertex(localDirection)] * scale);
+}
+
 Plane::Plane(Vector3 _normal, float _offset)
+	: Constraint(ConstraintType::PLANE)
 {
 	normal = _normal;
 	distance = _offset;
@@ -1,15 +1,43 @@
 #pragma once
 #include "body.h"
+#include "engine/aabb.h"
 #include "engine/contact.h"
+#include "engine/convexHull.h"
 #include <functional>//std::function
+#include <memory>//std::shared_ptr
 #include <vector>
 
 namespace physics
 {
+	//the indices of CollisionManager's dispatch tables
+	enum class ShapeType
+	{
+		SPHERE,
+		BOX,
+		CAPSULE,
+		CONVEX_HULL,
+		COUNT
+	};
+	constexpr int SHAPE_TYPE_COUNT = static_cast<int>(ShapeType::COUNT);
+
+	enum class ConstraintType
+	{
+		PLANE,
+		COUNT
+	};
+	constexpr int CONSTRAINT_TYPE_COUNT = static_cast<int>(ConstraintType::COUNT);
+
 	class Constraint {
 		friend class CollisionManager;
+
+	protected:
+		ConstraintType constraintType;
+
+		Constraint(ConstraintType _constraintType) : constraintType{ _constraintType } {}
+
 	public:
 		virtual ~Constraint() {}
+		ConstraintType GetConstraintType() const { return constraintType; }
 	};
 
 	class Plane : public Constraint
@@ -34,9 +62,18 @@ namespace physics
 
 	protected:
 		RigidBody* rigidBody;
+		ShapeType shapeType;
+
+		Collider(RigidBody* _body, ShapeType _shapeType) : rigidBody{ _body }, shapeType{ _shapeType } {}
 
 	public:
+		ShapeType GetShapeType() const { return shapeType; }
 		virtual void SetScale(double, ...) = 0;
+		virtual AABB ComputeAABB() const = 0;
+		//GJK/EPA see a shape as a convex core rounded by a margin (a sphere is its center and its radius).
+		//World space point of the core furthest along 'direction' (not normalized)
+		virtual Vector3 GetSupport(const Vector3& direction) const = 0;
+		virtual float GetMargin() const { return 0.0f; }
 	};
 
 	class SphereCollider : public Collider
@@ -50,7 +87,9 @@ namespace physics
 	public:
 		SphereCollider(RigidBody* _body, float _radius);
 		void SetScale(double, ...);
-
+		AABB ComputeAABB() const override;
+		Vector3 GetSupport(const Vector3& direction) const override;
+		float GetMargin() const override { return radius; }
 	};
 
 	class BoxCollider : public Collider //OBB
@@ -64,8 +103,49 @@ namespace physics
 	public:
 		BoxCollider(RigidBody* rigidBody, float extentsX, float extentsY, float extentsZ);
 		void SetScale(double, ...);
+		AABB ComputeAABB() const override;
+		Vector3 GetSupport(const Vector3& direction) const override;
 
 		Vector3 GetLocalContactVertex(Vector3 collisionNormal, std::function<bool(float, float)>cmp) const;
 	};
+
+	class CapsuleCollider : public Collider //a segment along the local y axis, rounded by the radius
+	{
+		friend class CollisionManager;
+		friend class PhysicsWorld;
+
+	protected:
+		float radius;
+		float halfHeight;//of the segment, the caps not included
+
+	public:
+		CapsuleCollider(RigidBody* _body, float _radius, float _halfHeight);
+		void SetScale(double, ...);//radius, halfHeight
+		AABB ComputeAABB() const override;
+		Vector3 GetSupport(const Vector3& direction) const override;
+		float GetMargin() const override { return radius; }
+
+		//world space ends of the segment
+		void GetSegment(Vector3& start, Vector3& end) const;
+	};
+
+	class ConvexHullCollider : public Collider
+	{
+		friend class CollisionManager;
+		friend class PhysicsWorld;
+
+	protected:
+		std::shared_ptr<const ConvexHull> hull;//shared by the colliders of the same shape
+		float scale;//uniform : the normals and the hill climbing stay valid
+
+	public:
+		ConvexHullCollider(RigidBody* _body, std::shared_ptr<const ConvexHull> _hull);
+		void SetScale(double, ...);//scale
+		AABB ComputeAABB() const override;
+		Vector3 GetSupport(const Vector3& direction) const override;
+
+		const ConvexHull& GetHull() const { return *hull; }
+		float GetScale() const { return scale; }
+	};
 }
 
@@ -1,79 +1,408 @@
 #include <cmath>
 #include <cfloat>
-#include <typeinfo>
 #include <algorithm>//std::clamp
 #include <array>//std::array
 #include <iostream>//std::cout
 #include "collisionManager.h"
+#include "gjk.h"
 #include "math/compare.h"
-#include "simulator/spawner.h"
+#include "profiler.h"
 #include "simulator/object.h"
 
 using namespace physics;
 
-void CollisionManager::DetectCollision(const std::vector<RigidObject*>& objects,const std::vector<std::unique_ptr<Constraint>>& constraints){
-    std::vector<SphereBoxSpawner*> activatedSpawners;
-    for (auto i = objects.begin(); i != objects.end(); ++i)
+namespace
+{
+    //the box-box SAT in box1's frame : axis i < 3 is box1's face i, 3 + j box2's face j, 6 + 3i + j the edges axes1[i] x axes2[j]
+    struct BoxPairFrame
     {
-        Collider* shape1 = (*i)->GetCollider();
-        //(1) Rigid Bodies
-        for (auto j = std::next(i, 1); j != objects.end(); ++j)
-        {
-            Collider* shape2 = (*j)->GetCollider();
+        static constexpr int AXIS_COUNT = 15;
+        static constexpr float PARALLEL_EPSILON = 1e-5f;//added to |rotation| : rounding can't separate along nearly parallel edges
+        static constexpr float PARALLEL_LENGTH_SQUARED = 1e-6f;//of the cross product of two edges, below : parallel, no axis
+
+        Vector3 axes1[3], axes2[3];//world
+        float rotation[3][3];//axes1[i].Dot(axes2[j])
+        float absRotation[3][3];
+        float centerToCenter1[3];//box1 to box2, on axes1
+        float centerToCenter2[3];//on axes2
+
+        //overlap of the boxes' projections on the axis, 0 or less : the axis separates them (FLT_MAX : no axis)
+        float CalcPenetration(const Vector3& extents1, const Vector3& extents2, int axisIdx) const {
+            if (axisIdx < 3) {
+                const int i = axisIdx;
+                float radius2 = extents2.x * absRotation[i][0] + extents2.y * absRotation[i][1] + extents2.z * absRotation[i][2];
+                return extents1[i] + radius2 - std::abs(centerToCenter1[i]);
+            }
+            if (axisIdx < 6) {
+                const int j = axisIdx - 3;
+                float radius1 = extents1.x * absRotation[0][j] + extents1.y * absRotation[1][j] + extents1.z * absRotation[2][j];
+                return radius1 + extents2[j] - std::abs(centerToCenter2[j]);
+            }
+            const int i = (axisIdx - 6) / 3;
+            const int j = (axisIdx - 6) % 3;
+            const float lengthSquared = 1.0f - rotation[i][j] * rotation[i][j];
+            if (lengthSquared < PARALLEL_LENGTH_SQUARED) {
+                return FLT_MAX;
+            }
+            const int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+            const int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            float radius1 = extents1[i1] * absRotation[i2][j] + extents1[i2] * absRotation[i1][j];
+            float radius2 = extents2[j1] * absRotation[i][j2] + extents2[j2] * absRotation[i][j1];
+            float distance = std::abs(centerToCenter1[i2] * rotation[i1][j] - centerToCenter1[i1] * rotation[i2][j]);
+            return (radius1 + radius2 - distance) / sqrtf(lengthSquared);//the cross product isn't unit
+        }
+
+        Vector3 GetAxis(int axisIdx) const {
+            if (axisIdx < 3) {
+                return axes1[axisIdx];
+            }
+            if (axisIdx < 6) {
+                return axes2[axisIdx - 3];
+            }
+            Vector3 axis = axes1[(axisIdx - 6) / 3].Cross(axes2[(axisIdx - 6) % 3]);
+            axis.Normalize();
+            return axis;
+        }
+    };
+
+    constexpr uint32_t AXIS_CACHE_AXIS_MASK = 0xF;//low bits of a cachedAxes entry : axis index + 1, 0 : none
+
+    uint64_t HashBodyPair(const RigidBody* body1, const RigidBody* body2){
+        uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(body1)) * 0x9E3779B97F4A7C15ull;
+        h ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(body2)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h * 0x9E3779B97F4A7C15ull;
+    }
 
-            if (FindCollisionFeatures(shape1, shape2) == true) {
-                if ((*i)->GetObjectType() == ObjectType::SPAWNER) {
-                    activatedSpawners.push_back(dynamic_cast<SphereBoxSpawner*>(*i));
+    constexpr float CAPSULE_PARALLEL_COSINE = 0.99f;//capsule axes (or axis and face) this parallel touch along a line : 2 points
+    constexpr float CAPSULE_DEPTH_TOLERANCE = 0.005f;//the 2 points may be this much shallower than the closest points
+    constexpr int HULL_PLANE_MAX_VERTICES = 64;//of a hull under the ground, before the reduction to 4
+
+    Vector3 ClosestPointOnSegment(const Vector3& start, const Vector3& end, const Vector3& point){
+        const Vector3 segment = end - start;
+        const float lengthSquared = segment.LengthSquared();
+        if (lengthSquared < FLT_EPSILON) {
+            return start;
+        }
+        const float t = std::clamp((point - start).Dot(segment) / lengthSquared, 0.0f, 1.0f);
+        return start + segment * t;
+    }
+
+    //Ericson, Real-Time Collision Detection 5.1.9, returns the squared distance
+    float ClosestPointsOfSegments(const Vector3& start1, const Vector3& end1, const Vector3& start2, const Vector3& end2,
+        Vector3& closest1, Vector3& closest2){
+        const Vector3 d1 = end1 - start1;
+        const Vector3 d2 = end2 - start2;
+        const Vector3 r = start1 - start2;
+        const float a = d1.LengthSquared();
+        const float e = d2.LengthSquared();
+        const float f = d2.Dot(r);
+        float s = 0.0f, t = 0.0f;
+        if (a < FLT_EPSILON && e < FLT_EPSILON) {
+            //both are points
+        }
+        else if (a < FLT_EPSILON) {
+            t = std::clamp(f / e, 0.0f, 1.0f);
+        }
+        else {
+            const float c = d1.Dot(r);
+            if (e < FLT_EPSILON) {
+                s = std::clamp(-c / a, 0.0f, 1.0f);
+            }
+            else {
+                const float b = d1.Dot(d2);
+                const float denominator = a * e - b * b;
+                if (denominator > FLT_EPSILON) {//parallel : any s, 0 is as good
+                    s = std::clamp((b * f - c * e) / denominator, 0.0f, 1.0f);
+                }
+                t = (b * s + f) / e;
+                if (t < 0.0f) {
+                    t = 0.0f;
+                    s = std::clamp(-c / a, 0.0f, 1.0f);
                 }
-                if ((*j)->GetObjectType() == ObjectType::SPAWNER) {
-                    activatedSpawners.push_back(dynamic_cast<SphereBoxSpawner*>(*j));
+                else if (t > 1.0f) {
+                    t = 1.0f;
+                    s = std::clamp((b - c) / a, 0.0f, 1.0f);
                 }
             }
         }
+        closest1 = start1 + d1 * s;
+        closest2 = start2 + d2 * t;
+        return (closest1 - closest2).LengthSquared();
+    }
 
-        //(2) constraints     
-        for (auto& constraint : constraints) {
-            if(FindCollisionFeatures(shape1, constraint.get())==true){
-                if ((*i)->GetObjectType() == ObjectType::SPAWNER) {
-                    activatedSpawners.push_back(dynamic_cast<SphereBoxSpawner*>(*i));
+    //slab test of the segment against the box centered at the origin
+    bool SegmentIntersectsBox(const float start[3], const float end[3], const float extents[3]){
+        float tMin = 0.0f, tMax = 1.0f;
+        for (int i = 0; i < 3; ++i) {
+            const float direction = end[i] - start[i];
+            if (std::abs(direction) < FLT_EPSILON) {
+                if (std::abs(start[i]) > extents[i]) {
+                    return false;
                 }
+                continue;
+            }
+            float t1 = (-extents[i] - start[i]) / direction;
+            float t2 = (extents[i] - start[i]) / direction;
+            if (t1 > t2) {
+                std::swap(t1, t2);
+            }
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+            if (tMin > tMax) {
+                return false;
             }
         }
+        return true;
     }
-    for(SphereBoxSpawner* spanwer : activatedSpawners){
-        spanwer->spawnAll();
+
+    //-1 if the ray misses the sphere
+    float CalcRaySphereDistance(const Vector3& origin, const Vector3& direction, const Vector3& center, float radius){
+        Vector3 originToSphere = center - origin;
+        float originToSphereProjected = originToSphere.Dot(direction);
+        float orthogonalDistanceSquared = originToSphere.LengthSquared() - originToSphereProjected * originToSphereProjected;
+        if (orthogonalDistanceSquared > radius * radius) {
+            return -1.0f;
+        }
+        return originToSphereProjected - sqrtf(radius * radius - orthogonalDistanceSquared);
     }
-}
 
-bool physics::CollisionManager::FindCollisionFeatures(const Collider* shape1, const Collider* shape2){
-    if (typeid(*shape1) == typeid(SphereCollider))
-    {
-        const SphereCollider* sphere = static_cast<const SphereCollider*>(shape1);
-        if (typeid(*shape2) == typeid(SphereCollider))
-        {
-            return FindCollisionFeatures(sphere, static_cast<const SphereCollider*>(shape2));
+    //the ground reads as a fixed body at rest : no mass, no inertia
+    void LoadSolverBodies(const CollisionManifold& contact, SolverBody (&bodies)[2]){
+        contact.bodies[0]->LoadSolverBody(bodies[0]);
+        if (contact.bodies[1]) {
+            contact.bodies[1]->LoadSolverBody(bodies[1]);
         }
-        else if (typeid(*shape2) == typeid(BoxCollider))
-        {
-            return FindCollisionFeatures(static_cast<const BoxCollider*>(shape2), sphere);
+        else {
+            bodies[1] = { Vector3(), Vector3(), Vector3(), Matrix3(0.0f), 0.0f };
+        }
+    }
+
+    //fixed bodies are never written, the colored solver shares them between threads
+    void StoreSolverBodies(const CollisionManifold& contact, const SolverBody (&bodies)[2]){
+        for (int i = 0; i < 2; ++i) {
+            if (contact.bodies[i] && bodies[i].inverseMass != 0.0f) {
+                contact.bodies[i]->StoreSolverBody(bodies[i]);
+            }
         }
     }
-    else if (typeid(*shape1) == typeid(BoxCollider))
+
+    //CollisionManifold::CalcContactArms() from the gathered positions
+    void CalcContactArms(const CollisionManifold& contact, const ManifoldPoint& point, const SolverBody (&bodies)[2], Vector3& r1, Vector3& r2){
+        r1 = point.contactPoint.p1.second - bodies[0].position;
+        if (contact.bodies[1]) {
+            r2 = point.contactPoint.p2.second - bodies[1].position;
+        }
+    }
+}
+
+void CollisionManager::DetectCollision(const std::vector<RigidObject*>& objects,const std::vector<std::unique_ptr<Constraint>>& constraints,JobSystem& jobSystem){
+    //(1) Rigid Bodies, only the pairs that survived the broad phase
     {
-        const BoxCollider* box = static_cast<const BoxCollider*>(shape1);
-        if (typeid(*shape2) == typeid(BoxCollider))
-        {
-            return FindCollisionFeatures(box, static_cast<const BoxCollider*>(shape2));
+        PROFILE_ZONE("BroadPhase");
+        broadPhase->ComputePairs(candidatePairs);
+    }
+    PROFILE_ZONE("NarrowPhase");
+    narrowPhaseTestCounts.fill(0);
+    const int pairCount = static_cast<int>(candidatePairs.size());
+    PrepareNarrowPhaseBuffers(pairCount);
+    jobSystem.ParallelForChunks(pairCount, PAIR_GRAIN_SIZE, [this](int chunkIdx, int begin, int end) {
+        PROFILE_ZONE("NarrowPhase job");
+        NarrowPhaseBuffer& buffer = narrowPhaseBuffers[chunkIdx];
+        for (int i = begin; i < end; ++i) {
+            const ObjectPair& pair = candidatePairs[i];
+            if (IsActive(pair.first->GetRigidBody()) == false && IsActive(pair.second->GetRigidBody()) == false) {
+                continue;
+            }
+            ++buffer.testCounts[static_cast<int>(GetShapePairType(pair.first->GetCollider(), pair.second->GetCollider()))];
+            if (FindCollisionFeatures(pair.first->GetCollider(), pair.second->GetCollider(), buffer.manifolds) == true) {
+                if (pair.first->GetObjectType() == ObjectType::SPAWNER) {
+                    buffer.activatedSpawners.push_back(pair.first);
+                }
+                if (pair.second->GetObjectType() == ObjectType::SPAWNER) {
+                    buffer.activatedSpawners.push_back(pair.second);
+                }
+            }
         }
-        else if (typeid(*shape2) == typeid(SphereCollider))
-        {
-            return FindCollisionFeatures(box, static_cast<const SphereCollider*>(shape2));
+    });
+    MergeNarrowPhaseBuffers();
+
+    //(2) constraints     
+    const int objectCount = static_cast<int>(objects.size());
+    PrepareNarrowPhaseBuffers(objectCount);
+    jobSystem.ParallelForChunks(objectCount, PAIR_GRAIN_SIZE, [this, &objects, &constraints](int chunkIdx, int begin, int end) {
+        NarrowPhaseBuffer& buffer = narrowPhaseBuffers[chunkIdx];
+        for (int i = begin; i < end; ++i) {
+            RigidObject* obj = objects[i];
+            if (obj->GetRigidBody()->IsAwake() == false) {
+                continue;
+            }
+            Collider* shape = obj->GetCollider();
+            for (auto& constraint : constraints) {
+                ++buffer.testCounts[static_cast<int>(GetShapePairType(shape, constraint.get()))];
+                if (FindCollisionFeatures(shape, constraint.get(), buffer.manifolds) == true) {
+                    if (obj->GetObjectType() == ObjectType::SPAWNER) {
+                        buffer.activatedSpawners.push_back(obj);
+                    }
+                }
+            }
+        }
+    });
+    MergeNarrowPhaseBuffers();
+
+    //spawning adds objects to the world, only once every test is done
+    for (NarrowPhaseBuffer& buffer : narrowPhaseBuffers) {
+        for (RigidObject* spawner : buffer.activatedSpawners) {
+            spawner->OnCollision();
         }
+        buffer.activatedSpawners.clear();
     }
-    return false;
 }
 
-bool CollisionManager::FindCollisionFeatures(const BoxCollider* box, const SphereCollider* sphere) {
+void CollisionManager::PrepareNarrowPhaseBuffers(int count){
+    size_t chunkCount = JobSystem::GetChunkCount(count, PAIR_GRAIN_SIZE);
+    if (narrowPhaseBuffers.size() < chunkCount) {
+        narrowPhaseBuffers.resize(chunkCount);
+    }
+}
+
+//appends the manifolds in chunk order, the spawners are kept for after the constraints
+void CollisionManager::MergeNarrowPhaseBuffers(){
+    for (NarrowPhaseBuffer& buffer : narrowPhaseBuffers) {
+        contacts.insert(contacts.end(), buffer.manifolds.begin(), buffer.manifolds.end());
+        buffer.manifolds.clear();
+        for (int i = 0; i < SHAPE_PAIR_TYPE_COUNT; ++i) {
+            narrowPhaseTestCounts[i] += buffer.testCounts[i];
+        }
+        buffer.testCounts.fill(0);
+    }
+}
+
+void CollisionManager::FillStepStats(StepStats& stats) const{
+    stats.candidatePairs = static_cast<int>(candidatePairs.size());
+    stats.narrowPhaseTests = narrowPhaseTestCounts;
+    stats.manifolds = static_cast<int>(contacts.size());
+    stats.contactPoints = 0;
+    for (const CollisionManifold& contact : contacts) {
+        stats.contactPoints += contact.pointCount;
+    }
+    stats.solverIterations = lastIterationCount;
+    stats.solvedIslands = lastSolvedIslandCount;
+    stats.islandIterations = lastIslandIterationSum;
+}
+
+//awake and movable, at least one body of a pair has to be active to be tested
+bool CollisionManager::IsActive(const RigidBody* body) const{
+    return body->IsAwake() && body->IsFixed() == false;
+}
+
+CollisionManager::ShapeTestEntry CollisionManager::shapeTests[SHAPE_TYPE_COUNT][SHAPE_TYPE_COUNT]{};
+CollisionManager::ConstraintTestEntry CollisionManager::constraintTests[SHAPE_TYPE_COUNT][CONSTRAINT_TYPE_COUNT]{};
+CollisionManager::RayTest CollisionManager::rayTests[SHAPE_TYPE_COUNT]{};
+const bool CollisionManager::builtInTestsRegistered = CollisionManager::RegisterBuiltInTests();
+
+void CollisionManager::RegisterShapeTest(ShapeType type1, ShapeType type2, ShapeTest test, ShapePairType pairType){
+    const int idx1 = static_cast<int>(type1);
+    const int idx2 = static_cast<int>(type2);
+    shapeTests[idx1][idx2] = { test, pairType, false };
+    if (idx1 != idx2) {
+        shapeTests[idx2][idx1] = { test, pairType, true };
+    }
+}
+
+void CollisionManager::RegisterConstraintTest(ShapeType shapeType, ConstraintType constraintType, ConstraintTest test, ShapePairType pairType){
+    constraintTests[static_cast<int>(shapeType)][static_cast<int>(constraintType)] = { test, pairType };
+}
+
+void CollisionManager::RegisterRayTest(ShapeType shapeType, RayTest test){
+    rayTests[static_cast<int>(shapeType)] = test;
+}
+
+//the static_casts are safe : an entry is only reached through the types it was registered for
+bool CollisionManager::RegisterBuiltInTests(){
+    RegisterShapeTest(ShapeType::SPHERE, ShapeType::SPHERE,
+        [](CollisionManager& manager, const Collider* shape1, const Collider* shape2, std::vector<CollisionManifold>& manifolds) {
+            return manager.FindCollisionFeatures(static_cast<const SphereCollider*>(shape1), static_cast<const SphereCollider*>(shape2), manifolds);
+        }, ShapePairType::SPHERE_SPHERE);
+    RegisterShapeTest(ShapeType::BOX, ShapeType::SPHERE,
+        [](CollisionManager& manager, const Collider* shape1, const Collider* shape2, std::vector<CollisionManifold>& manifolds) {
+            return manager.FindCollisionFeatures(static_cast<const BoxCollider*>(shape1), static_cast<const SphereCollider*>(shape2), manifolds);
+        }, ShapePairType::BOX_SPHERE);
+    RegisterShapeTest(ShapeType::BOX, ShapeType::BOX,
+        [](CollisionManager& manager, const Collider* shape1, const Collider* shape2, std::vector<CollisionManifold>& manifolds) {
+            return manager.FindCollisionFeatures(static_cast<const BoxCollider*>(shape1), static_cast<const BoxCollider*>(shape2), manifolds);
+        }, ShapePairType::BOX_BOX);
+
+    RegisterShapeTest(ShapeType::CAPSULE, ShapeType::CAPSULE,
+        [](CollisionManager& manager, const Collider* shape1, const Collider* shape2, std::vector<CollisionManifold>& manifolds) {
+            return manager.FindCollisionFeatures(static_cast<const CapsuleCollider*>(shape1), static_cast<const CapsuleCollider*>(shape2), manifolds);
+        }, ShapePairType::CAPSULE_CAPSULE);
+    RegisterShapeTest(ShapeType::CAPSULE, ShapeType::SPHERE,
+        [](CollisionManager& manager, const Collider* shape1, const Collider* shape2, std::vector<CollisionManifold>& manifolds) {
+            return manager.FindCollisionFeatures(static_cast<const CapsuleCollider*>(shape1), static_cast<const SphereCollider*>(shape2), manifolds);
+        }, ShapePairType::CAPSULE_SPHERE);
+    RegisterShapeTest(ShapeType::BOX, ShapeType::CAPSULE,
+        [](CollisionManager& manager, const Collider* shape1, const Collider* shape2, std::vector<CollisionManifold>& manifolds) {
+            return manager.FindCollisionFeatures(static_cast<const BoxCollider*>(shape1), static_cast<const CapsuleCollider*>(shape2), manifolds);
+        }, ShapePairType::BOX_CAPSULE);
+
+    RegisterConstraintTest(ShapeType::SPHERE, ConstraintType::PLANE,
+        [](CollisionManager& manager, const Collider* shape, const Constraint* constraint, std::vector<CollisionManifold>& manifolds) {
+            return manager.FindCollisionFeatures(static_cast<const SphereCollider*>(shape), static_cast<const Plane*>(constraint), manifolds);
+        }, ShapePairType::SPHERE_PLANE);
+    RegisterConstraintTest(ShapeType::BOX, ConstraintType::PLANE,
+        [](CollisionManager& manager, const Collider* shape, const Constraint* constraint, std::vector<CollisionManifold>& manifolds) {
+            return manager.FindCollisionFeatures(static_cast<const BoxCollider*>(shape), static_cast<const Plane*>(constraint), manifolds);
+        }, ShapePairType::BOX_PLANE);
+    RegisterConstraintTest(ShapeType::CAPSULE, ConstraintType::PLANE,
+        [](CollisionManager& manager, const Collider* shape, const Constraint* constraint, std::vector<CollisionManifold>& manifolds) {
+            return manager.FindCollisionFeatures(static_cast<const CapsuleCollider*>(shape), static_cast<const Plane*>(constraint), manifolds);
+        }, ShapePairType::CAPSULE_PLANE);
+
+    RegisterConstraintTest(ShapeType::CONVEX_HULL, ConstraintType::PLANE,
+        [](CollisionManager& manager, const Collider* shape, const Constraint* constraint, std::vector<CollisionManifold>& manifolds) {
+            return manager.FindCollisionFeatures(static_cast<const ConvexHullCollider*>(shape), static_cast<const Plane*>(constraint), manifolds);
+        }, ShapePairType::HULL_PLANE);
+
+    RegisterRayTest(ShapeType::SPHERE, [](CollisionManager& manager, const Vector3& origin, const Vector3& direction, const Collider* shape) {
+        return manager.CaclRaySphereHitPointDistance(origin, direction, *static_cast<const SphereCollider*>(shape));
+    });
+    RegisterRayTest(ShapeType::BOX, [](CollisionManager& manager, const Vector3& origin, const Vector3& direction, const Collider* shape) {
+        return manager.RayAndBox(origin, direction, *static_cast<const BoxCollider*>(shape));
+    });
+    RegisterRayTest(ShapeType::CAPSULE, [](CollisionManager& manager, const Vector3& origin, const Vector3& direction, const Collider* shape) {
+        return manager.RayAndCapsule(origin, direction, *static_cast<const CapsuleCollider*>(shape));
+    });
+    RegisterRayTest(ShapeType::CONVEX_HULL, [](CollisionManager& manager, const Vector3& origin, const Vector3& direction, const Collider* shape) {
+        return manager.RayAndConvexHull(origin, direction, *static_cast<const ConvexHullCollider*>(shape));
+    });
+    return true;
+}
+
+//one indexed call, in the innermost loop of the narrow phase
+bool physics::CollisionManager::FindCollisionFeatures(const Collider* shape1, const Collider* shape2, std::vector<CollisionManifold>& manifolds){
+    const ShapeTestEntry& entry = shapeTests[static_cast<int>(shape1->GetShapeType())][static_cast<int>(shape2->GetShapeType())];
+    if (entry.test == nullptr) {
+        return FindConvexFeatures(shape1, shape2, manifolds);
+    }
+    return entry.swapShapes ? entry.test(*this, shape2, shape1, manifolds) : entry.test(*this, shape1, shape2, manifolds);
+}
+
+ShapePairType CollisionManager::GetShapePairType(const Collider* shape1, const Collider* shape2){
+    const ShapeTestEntry& entry = shapeTests[static_cast<int>(shape1->GetShapeType())][static_cast<int>(shape2->GetShapeType())];
+    return entry.test ? entry.pairType : ShapePairType::CONVEX_CONVEX;
+}
+
+ShapePairType CollisionManager::GetShapePairType(const Collider* collider, const Constraint* constraint){
+    const ConstraintTestEntry& entry = constraintTests[static_cast<int>(collider->GetShapeType())][static_cast<int>(constraint->GetConstraintType())];
+    return entry.test ? entry.pairType : ShapePairType::CONVEX_PLANE;
+}
+
+float CollisionManager::CalcRayDistance(const Vector3& origin, const Vector3& direction, const Collider* shape){
+    RayTest test = rayTests[static_cast<int>(shape->GetShapeType())];
+    return test ? test(*this, origin, direction, shape) : -1.0f;
+}
+
+bool CollisionManager::FindCollisionFeatures(const BoxCollider* box, const SphereCollider* sphere, std::vector<CollisionManifold>& manifolds) {
     constexpr int NUM_AXES = 3;
     Vector3 centerToCenter = sphere->rigidBody->GetPosition() - box->rigidBody->GetPosition();
     Vector3 extents = box->extents;
@@ -110,27 +439,23 @@ bool CollisionManager::FindCollisionFeatures(const BoxCollider* box, const Spher
     newContact.bodies[1] = box->rigidBody;
     newContact.collisionNormal = sphere->rigidBody->GetPosition() - closestPoint;
     newContact.collisionNormal.Normalize();
-    newContact.contactPoint ={
+    newContact.AddPoint({
         { true, Vector3(sphere->rigidBody->GetPosition() - newContact.collisionNormal * sphere->radius) },
         { true, Vector3(closestPoint) }
-        };
-    newContact.penetrationDepth = sphere->radius - sqrtf(distanceSquared);
+        }, sphere->radius - sqrtf(distanceSquared), 0);
     newContact.restitution = objectRestitution;
     newContact.friction = friction;
-    contacts.push_back(newContact);
+    manifolds.push_back(newContact);
 
     return true;
 }
-bool CollisionManager::FindCollisionFeatures(const SphereCollider* sphere1,const SphereCollider* sphere2,bool isForBroadPhaseTest){
+bool CollisionManager::FindCollisionFeatures(const SphereCollider* sphere1,const SphereCollider* sphere2,std::vector<CollisionManifold>& manifolds){
     float distanceSquared = (sphere1->rigidBody->GetPosition() - sphere2->rigidBody->GetPosition()).LengthSquared();
 
     float radiusSum = sphere1->radius + sphere2->radius;
     if (distanceSquared > radiusSum * radiusSum) {
         return false;
     }
-    if (isForBroadPhaseTest == true) {//no need to calc details
-        return true;
-    }
 
 	Vector3 normal = sphere1->rigidBody->GetPosition() - sphere2->rigidBody->GetPosition();
 	normal.Normalize();
@@ -139,17 +464,17 @@ bool CollisionManager::FindCollisionFeatures(const SphereCollider* sphere1,const
     newContact.bodies[0] = sphere1->rigidBody;
 	newContact.bodies[1] = sphere2->rigidBody;
 	newContact.collisionNormal = normal;
-    newContact.contactPoint = { { true, Vector3(sphere1->rigidBody->GetPosition() - normal * sphere1->radius) },
-                                { true, Vector3(sphere2->rigidBody->GetPosition() + normal * sphere2->radius) }};
-	newContact.penetrationDepth = radiusSum - sqrtf(distanceSquared);
+    newContact.AddPoint({ { true, Vector3(sphere1->rigidBody->GetPosition() - normal * sphere1->radius) },
+                        { true, Vector3(sphere2->rigidBody->GetPosition() + normal * sphere2->radius) } },
+                        radiusSum - sqrtf(distanceSquared), 0);
 	newContact.restitution = objectRestitution;
 	newContact.friction = friction;
-    contacts.push_back(newContact);
+    manifolds.push_back(newContact);
 
     return true;
 }
 
-bool CollisionManager::FindCollisionFeatures(const SphereCollider* sphere, const Plane* plane){
+bool CollisionManager::FindCollisionFeatures(const SphereCollider* sphere, const Plane* plane, std::vector<CollisionManifold>& manifolds){
     float distance = std::abs(plane->normal.Dot(sphere->rigidBody->GetPosition())-plane->distance);
 
     if (distance > sphere->radius) {
@@ -160,69 +485,101 @@ bool CollisionManager::FindCollisionFeatures(const SphereCollider* sphere, const
 	newContact.bodies[0] = sphere->rigidBody;
 	newContact.bodies[1] = nullptr;
 	newContact.collisionNormal = plane->normal;
-	newContact.contactPoint={{ true,Vector3(sphere->rigidBody->GetPosition() - plane->normal * distance) },
-		                    { false,Vector3{}}};
-	newContact.penetrationDepth = sphere->radius - distance;
+	newContact.AddPoint({ { true,Vector3(sphere->rigidBody->GetPosition() - plane->normal * distance) },
+		                { false,Vector3{}} },
+		                sphere->radius - distance, 0);
 	newContact.restitution = groundRestitution;
 	newContact.friction = friction;
-	contacts.push_back(newContact);
+	manifolds.push_back(newContact);
 	return true;
 }
 
-bool CollisionManager::FindCollisionFeatures(const BoxCollider* box1, const BoxCollider* box2){
-    RigidBody b1;
-    RigidBody b2;
-    b1.SetPosition(box1->rigidBody->GetPosition());
-    b2.SetPosition(box2->rigidBody->GetPosition());
-
-    SphereCollider s1{ &b1, box1->extents.Length()};
-    SphereCollider s2{ &b2, box2->extents.Length()};
-
-    if (FindCollisionFeatures(&s1, &s2,true)==false) {//'true' : only for the broad phase test
+//SAT from the relative rotation (Gottschalk's OBB test) : the 15 axes are never built, only the chosen one.
+//The axis that ended the test (separating, or the contact axis) is tried first the next step,
+//so a pair that stays apart exits after one axis
+bool CollisionManager::FindCollisionFeatures(const BoxCollider* box1, const BoxCollider* box2, std::vector<CollisionManifold>& manifolds){
+    //bounding spheres first
+    const Vector3 box1ToBox2 = box2->rigidBody->GetPosition() - box1->rigidBody->GetPosition();
+    float radiusSum = box1->extents.Length() + box2->extents.Length();
+    if (box1ToBox2.LengthSquared() > radiusSum * radiusSum) {
         return false;
     }
 
-    std::vector<Vector3> axes;
-
-    //face(box1) <-> vertex(box2)
+    BoxPairFrame frame;
     for (int i{}; i < 3; ++i) {
-        axes.push_back(box1->rigidBody->GetAxis(i));
+        frame.axes1[i] = box1->rigidBody->GetAxis(i);
+        frame.axes2[i] = box2->rigidBody->GetAxis(i);
     }
-
-    //face(box2) <-> vertex(box1)
     for (int i{}; i < 3; ++i) {
-        axes.push_back(box2->rigidBody->GetAxis(i));
+        for (int j{}; j < 3; ++j) {
+            frame.rotation[i][j] = frame.axes1[i].Dot(frame.axes2[j]);
+            frame.absRotation[i][j] = std::abs(frame.rotation[i][j]) + BoxPairFrame::PARALLEL_EPSILON;
+        }
+        frame.centerToCenter1[i] = box1ToBox2.Dot(frame.axes1[i]);
+        frame.centerToCenter2[i] = box1ToBox2.Dot(frame.axes2[i]);
     }
 
-    //edge-edge
-    for (int i{}; i < 3; ++i) {
-        for (int j{}; j < 3; ++j) {
-            Vector3 crossProduct = axes[i].Cross(axes[3 + j]);
-            crossProduct.Normalize();
-            axes.push_back(crossProduct);
+    const uint64_t pairHash = HashBodyPair(box1->rigidBody, box2->rigidBody);
+    std::atomic<uint32_t>& cachedAxis = cachedAxes[(pairHash >> 32) % AXIS_CACHE_SIZE];
+    const uint32_t cacheTag = static_cast<uint32_t>(pairHash) & ~AXIS_CACHE_AXIS_MASK;
+    const uint32_t cached = cachedAxis.load(std::memory_order_relaxed);
+    if ((cached & ~AXIS_CACHE_AXIS_MASK) == cacheTag && (cached & AXIS_CACHE_AXIS_MASK) != 0) {
+        const int axisIdx = static_cast<int>(cached & AXIS_CACHE_AXIS_MASK) - 1;
+        if (frame.CalcPenetration(box1->extents, box2->extents, axisIdx) <= 0.0f) {
+            return false;
         }
     }
 
     float minPenetration = FLT_MAX;
     int minAxisIdx = 0;
+    float minFacePenetration2 = FLT_MAX;//faces of box2
+    int minFaceAxisIdx2 = -1;
+    float minEdgePenetration = FLT_MAX;
+    int minEdgeAxisIdx = -1;
 
-    for (int i{}; i < axes.size(); ++i){
-        float penetration = CalcPenetration(*box1, *box2, axes[i]);
+    for (int i{}; i < BoxPairFrame::AXIS_COUNT; ++i){
+        float penetration = frame.CalcPenetration(box1->extents, box2->extents, i);
 
         if (penetration <= 0.f) {
+            cachedAxis.store(cacheTag | static_cast<uint32_t>(i + 1), std::memory_order_relaxed);
             return false; //early exit
         }
 
-        if (penetration <= minPenetration){
-            minPenetration = penetration;
-            minAxisIdx = i;
+        if (i < 3) {
+            if (penetration <= minPenetration) {
+                minPenetration = penetration;
+                minAxisIdx = i;
+            }
+        }
+        else if (i < 6) {
+            if (penetration < minFacePenetration2) {
+                minFacePenetration2 = penetration;
+                minFaceAxisIdx2 = i;
+            }
+        }
+        else if (penetration < minEdgePenetration) {
+            minEdgePenetration = penetration;
+            minEdgeAxisIdx = i;
         }
     }
 
+    //box1 faces are preferred over box2 faces, and faces over edges, unless the other axis is clearly better.
+    //a face gives a whole clipped face as the manifold, and the reference face doesn't flip from step to step
+    //when two boxes rest on each other (the feature ids, so the warm starting, depend on it)
+    constexpr float RELATIVE_TOLERANCE = 0.95f;
+    if (minFacePenetration2 < minPenetration * RELATIVE_TOLERANCE) {
+        minPenetration = minFacePenetration2;
+        minAxisIdx = minFaceAxisIdx2;
+    }
+    if (minEdgeAxisIdx >= 0 && minEdgePenetration < minPenetration * RELATIVE_TOLERANCE) {
+        minPenetration = minEdgePenetration;
+        minAxisIdx = minEdgeAxisIdx;
+    }
+    cachedAxis.store(cacheTag | static_cast<uint32_t>(minAxisIdx + 1), std::memory_order_relaxed);
+
     CollisionManifold newContact;
     newContact.bodies[0] = box1->rigidBody;
     newContact.bodies[1] = box2->rigidBody;
-    newContact.penetrationDepth = minPenetration;
     newContact.restitution = objectRestitution;
     newContact.friction = friction;
 
@@ -231,31 +588,358 @@ bool CollisionManager::FindCollisionFeatures(const BoxCollider* box1, const BoxC
 
     // Determine the direction of the collision normal (collisionNormal).
     // want the collisionNormal to always point from box2 towards box1.
-    newContact.collisionNormal = (axes[minAxisIdx].Dot(box2ToBox1) < 0) ? axes[minAxisIdx] * -1.f : axes[minAxisIdx];
+    const Vector3 axis = frame.GetAxis(minAxisIdx);
+    newContact.collisionNormal = (axis.Dot(box2ToBox1) < 0) ? axis * -1.f : axis;
 
-    CalcOBBsContactPoints(*box1, *box2, newContact, minAxisIdx);
-    
-    contacts.push_back(newContact);
+    if (minAxisIdx >= 6 || ClipBoxFaces(*box1, *box2, newContact, minAxisIdx) == false) {
+        CalcOBBsContactPoints(*box1, *box2, newContact, minPenetration, minAxisIdx);
+    }
+
+    manifolds.push_back(newContact);
     return true;
 }
 
-bool physics::CollisionManager::FindCollisionFeatures(const Collider* collider, const Constraint* constraint){
-    if (typeid(*collider) == typeid(SphereCollider)){
-        const SphereCollider* sphere = static_cast<const SphereCollider*>(collider);
-        if (typeid(*constraint) == typeid(Plane)) {
-            return FindCollisionFeatures(sphere, static_cast<const Plane*>(constraint));
+//the closest points of the segments, as two spheres. Lying side by side, the ends of the overlap are the points
+bool CollisionManager::FindCollisionFeatures(const CapsuleCollider* capsule1, const CapsuleCollider* capsule2, std::vector<CollisionManifold>& manifolds){
+    Vector3 start1, end1, start2, end2;
+    capsule1->GetSegment(start1, end1);
+    capsule2->GetSegment(start2, end2);
+    Vector3 closest1, closest2;
+    const float distanceSquared = ClosestPointsOfSegments(start1, end1, start2, end2, closest1, closest2);
+    const float radiusSum = capsule1->radius + capsule2->radius;
+    if (distanceSquared > radiusSum * radiusSum) {
+        return false;
+    }
+    if (distanceSquared < FLT_EPSILON * FLT_EPSILON) {
+        return FindConvexFeatures(capsule1, capsule2, manifolds);//crossing axes : no closest direction
+    }
+    const float distance = sqrtf(distanceSquared);
+    const float depth = radiusSum - distance;
+
+    CollisionManifold newContact;
+    newContact.bodies[0] = capsule1->rigidBody;
+    newContact.bodies[1] = capsule2->rigidBody;
+    newContact.restitution = objectRestitution;
+    newContact.friction = friction;
+
+    //the overlap of the segments along the axis of capsule2, the normal across it
+    const Vector3 axis2 = capsule2->rigidBody->GetAxis(1);
+    if (std::abs(capsule1->rigidBody->GetAxis(1).Dot(axis2)) > CAPSULE_PARALLEL_COSINE) {
+        const float length2 = capsule2->halfHeight * 2.0f;
+        const float t1 = (start1 - start2).Dot(axis2), t2 = (end1 - start2).Dot(axis2);
+        const float overlapStart = std::max(std::min(t1, t2), 0.0f);
+        const float overlapEnd = std::min(std::max(t1, t2), length2);
+        Vector3 sideNormal = (closest1 - closest2) - axis2 * (closest1 - closest2).Dot(axis2);
+        const float sideDistance = sideNormal.Length();
+        if (overlapStart < overlapEnd && sideDistance > FLT_EPSILON) {
+            sideNormal *= 1.0f / sideDistance;
+            for (float t : { overlapStart, overlapEnd }) {
+                const Vector3 point2 = start2 + axis2 * t;
+                const Vector3 point1 = ClosestPointOnSegment(start1, end1, point2);
+                const float pointDepth = radiusSum - (point1 - point2).Dot(sideNormal);
+                if (pointDepth > 0.0f) {
+                    newContact.AddPoint({ { true, Vector3(point1 - sideNormal * capsule1->radius) },
+                                        { true, Vector3(point2 + sideNormal * capsule2->radius) } },
+                                        pointDepth, newContact.pointCount + 1);
+                }
+            }
+            newContact.collisionNormal = sideNormal;
         }
     }
-    else if (typeid(*collider) == typeid(BoxCollider)){
-        const BoxCollider* box = static_cast<const BoxCollider*>(collider);
-        if (typeid(*constraint) == typeid(Plane)) {
-            return FindCollisionFeatures(box, static_cast<const Plane*>(constraint));
+    if (newContact.pointCount < 2
+        || std::max(newContact.points[0].penetrationDepth, newContact.points[1].penetrationDepth) < depth - CAPSULE_DEPTH_TOLERANCE) {
+        const Vector3 normal = (closest1 - closest2) * (1.0f / distance);
+        newContact.pointCount = 0;
+        newContact.collisionNormal = normal;
+        newContact.AddPoint({ { true, Vector3(closest1 - normal * capsule1->radius) },
+                            { true, Vector3(closest2 + normal * capsule2->radius) } },
+                            depth, 0);
+    }
+    manifolds.push_back(newContact);
+    return true;
+}
+
+bool CollisionManager::FindCollisionFeatures(const CapsuleCollider* capsule, const SphereCollider* sphere, std::vector<CollisionManifold>& manifolds){
+    Vector3 start, end;
+    capsule->GetSegment(start, end);
+    const Vector3 center = sphere->rigidBody->GetPosition();
+    const Vector3 closest = ClosestPointOnSegment(start, end, center);
+    const float distanceSquared = (closest - center).LengthSquared();
+    const float radiusSum = capsule->radius + sphere->radius;
+    if (distanceSquared > radiusSum * radiusSum) {
+        return false;
+    }
+    if (distanceSquared < FLT_EPSILON * FLT_EPSILON) {
+        return FindConvexFeatures(capsule, sphere, manifolds);
+    }
+    const float distance = sqrtf(distanceSquared);
+    const Vector3 normal = (closest - center) * (1.0f / distance);
+
+    CollisionManifold newContact;
+    newContact.bodies[0] = capsule->rigidBody;
+    newContact.bodies[1] = sphere->rigidBody;
+    newContact.collisionNormal = normal;
+    newContact.AddPoint({ { true, Vector3(closest - normal * capsule->radius) },
+                        { true, Vector3(center + normal * sphere->radius) } },
+                        radiusSum - distance, 0);
+    newContact.restitution = objectRestitution;
+    newContact.friction = friction;
+    manifolds.push_back(newContact);
+    return true;
+}
+
+//in the box's frame : the closest points involve an end of the segment or an edge of the box,
+//unless the segment goes through the box (then GJK/EPA)
+bool CollisionManager::FindCollisionFeatures(const BoxCollider* box, const CapsuleCollider* capsule, std::vector<CollisionManifold>& manifolds){
+    const Vector3 boxCenter = box->rigidBody->GetPosition();
+    const Vector3 extents = box->extents;
+    //bounding spheres first
+    const float reach = extents.Length() + capsule->halfHeight + capsule->radius;
+    if ((capsule->rigidBody->GetPosition() - boxCenter).LengthSquared() > reach * reach) {
+        return false;
+    }
+
+    //Extract3x3Matrix() is stored transposed : it takes world directions to the box's local space
+    const Matrix4 localToWorld = box->rigidBody->GetLocalToWorldMatrix();
+    const Matrix3 worldToLocal = localToWorld.Extract3x3Matrix();
+    Vector3 start, end;
+    capsule->GetSegment(start, end);
+    const Vector3 localEnds[2] = { worldToLocal * (start - boxCenter), worldToLocal * (end - boxCenter) };
+    //per axis, as in BoxPairFrame
+    const float halfSize[3] = { extents.x, extents.y, extents.z };
+    const float localStart[3] = { localEnds[0].x, localEnds[0].y, localEnds[0].z };
+    const float localEnd[3] = { localEnds[1].x, localEnds[1].y, localEnds[1].z };
+
+    //the closest points below can't see a segment crossing the faces
+    if (SegmentIntersectsBox(localStart, localEnd, halfSize)) {
+        return FindConvexFeatures(capsule, box, manifolds);
+    }
+    auto clampToBox = [&extents](const Vector3& point) {
+        return Vector3(std::clamp(point.x, -extents.x, extents.x), std::clamp(point.y, -extents.y, extents.y), std::clamp(point.z, -extents.z, extents.z));
+    };
+
+    Vector3 closestOnSegment = localEnds[0];
+    Vector3 closestOnBox = clampToBox(localEnds[0]);
+    float closestDistanceSquared = (closestOnSegment - closestOnBox).LengthSquared();
+    Vector3 endOnBox = clampToBox(localEnds[1]);
+    if ((localEnds[1] - endOnBox).LengthSquared() < closestDistanceSquared) {
+        closestOnSegment = localEnds[1];
+        closestOnBox = endOnBox;
+        closestDistanceSquared = (localEnds[1] - endOnBox).LengthSquared();
+    }
+    //the 12 edges, 4 along each axis. An edge is skipped when its corner, across the axis, is already
+    //farther from the bounds of the segment than the closest points so far
+    float segmentMin[3], segmentMax[3];
+    for (int i = 0; i < 3; ++i) {
+        segmentMin[i] = std::min(localStart[i], localEnd[i]);
+        segmentMax[i] = std::max(localStart[i], localEnd[i]);
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        const int axis1 = (axis + 1) % 3, axis2 = (axis + 2) % 3;
+        for (int corner = 0; corner < 4; ++corner) {
+            const float corner1 = (corner & 1) ? halfSize[axis1] : -halfSize[axis1];
+            const float corner2 = (corner & 2) ? halfSize[axis2] : -halfSize[axis2];
+            const float gap1 = std::max(segmentMin[axis1] - corner1, corner1 - segmentMax[axis1]);
+            const float gap2 = std::max(segmentMin[axis2] - corner2, corner2 - segmentMax[axis2]);
+            const float lowerBound = (gap1 > 0.0f ? gap1 * gap1 : 0.0f) + (gap2 > 0.0f ? gap2 * gap2 : 0.0f);
+            if (lowerBound >= closestDistanceSquared) {
+                continue;
+            }
+            float edgeStart[3], edgeEnd[3];
+            edgeStart[axis] = -halfSize[axis];
+            edgeEnd[axis] = halfSize[axis];
+            edgeStart[axis1] = edgeEnd[axis1] = corner1;
+            edgeStart[axis2] = edgeEnd[axis2] = corner2;
+            Vector3 onSegment, onEdge;
+            const float distanceSquared = ClosestPointsOfSegments(localEnds[0], localEnds[1],
+                Vector3(edgeStart[0], edgeStart[1], edgeStart[2]), Vector3(edgeEnd[0], edgeEnd[1], edgeEnd[2]), onSegment, onEdge);
+            if (distanceSquared < closestDistanceSquared) {
+                closestDistanceSquared = distanceSquared;
+                closestOnSegment = onSegment;
+                closestOnBox = onEdge;
+            }
+        }
+    }
+
+    if (closestDistanceSquared > capsule->radius * capsule->radius) {
+        return false;
+    }
+    if (closestDistanceSquared < FLT_EPSILON * FLT_EPSILON) {
+        return FindConvexFeatures(capsule, box, manifolds);
+    }
+    const float distance = sqrtf(closestDistanceSquared);
+    Vector3 localNormal = (closestOnSegment - closestOnBox) * (1.0f / distance);
+
+    CollisionManifold newContact;
+    newContact.bodies[0] = capsule->rigidBody;
+    newContact.bodies[1] = box->rigidBody;
+    newContact.collisionNormal = worldToLocal.Transpose() * localNormal;
+    newContact.restitution = objectRestitution;
+    newContact.friction = friction;
+
+    //lying on a face : both ends touch it
+    const Vector3 localAxis = localEnds[1] - localEnds[0];
+    const float axisLength = localAxis.Length();
+    if (axisLength > FLT_EPSILON && std::abs(localAxis.Dot(localNormal)) < (1.0f - CAPSULE_PARALLEL_COSINE) * axisLength) {
+        for (int i = 0; i < 2; ++i) {
+            const Vector3 onBox = clampToBox(localEnds[i]);
+            const Vector3 offset = localEnds[i] - onBox;
+            const float depth = capsule->radius - offset.Dot(localNormal);
+            if (offset.LengthSquared() > capsule->radius * capsule->radius || depth <= 0.0f
+                || offset.Dot(localNormal) < CAPSULE_PARALLEL_COSINE * offset.Length()) {
+                continue;
+            }
+            newContact.AddPoint({ { true, Vector3(localToWorld * (localEnds[i] - localNormal * capsule->radius)) },
+                                { true, Vector3(localToWorld * onBox) } },
+                                depth, i + 1);
+        }
+    }
+    const float depth = capsule->radius - distance;
+    if (newContact.pointCount < 2
+        || std::max(newContact.points[0].penetrationDepth, newContact.points[1].penetrationDepth) < depth - CAPSULE_DEPTH_TOLERANCE) {
+        newContact.pointCount = 0;
+        newContact.AddPoint({ { true, Vector3(localToWorld * (closestOnSegment - localNormal * capsule->radius)) },
+                            { true, Vector3(localToWorld * closestOnBox) } },
+                            depth, 0);
+    }
+    manifolds.push_back(newContact);
+    return true;
+}
+
+//the ends of the segment, one or both (lying flat)
+bool CollisionManager::FindCollisionFeatures(const CapsuleCollider* capsule, const Plane* plane, std::vector<CollisionManifold>& manifolds){
+    Vector3 ends[2];
+    capsule->GetSegment(ends[0], ends[1]);
+
+    CollisionManifold newContact;
+    newContact.bodies[0] = capsule->rigidBody;
+    newContact.bodies[1] = nullptr;
+    newContact.collisionNormal = plane->normal;
+    newContact.restitution = groundRestitution;
+    newContact.friction = friction;
+    for (int i = 0; i < 2; ++i) {
+        const float distance = plane->normal.Dot(ends[i]) - plane->distance;
+        if (distance < capsule->radius) {
+            newContact.AddPoint({ { true, Vector3(ends[i] - plane->normal * capsule->radius) },
+                                { false, Vector3{} } },
+                                capsule->radius - distance, i);
         }
     }
-    return false;
+    if (newContact.pointCount == 0) {
+        return false;
+    }
+    manifolds.push_back(newContact);
+    return true;
+}
+
+//in local space : the vertices under the ground are connected, they are walked from the deepest one
+bool CollisionManager::FindCollisionFeatures(const ConvexHullCollider* hull, const Plane* plane, std::vector<CollisionManifold>& manifolds){
+    const ConvexHull& shape = *hull->hull;
+    Matrix4 localToWorld = hull->rigidBody->GetLocalToWorldMatrix();
+    const Vector3 localNormal = localToWorld.Extract3x3Matrix() * plane->normal;
+    const float localDistance = (plane->distance - plane->normal.Dot(hull->rigidBody->GetPosition())) / hull->scale;
+
+    int vertexIndices[HULL_PLANE_MAX_VERTICES];
+    const int count = shape.GetVerticesBelow(localNormal, localDistance, shape.GetSupportVertex(-localNormal), vertexIndices, HULL_PLANE_MAX_VERTICES);
+    if (count == 0) {
+        return false;
+    }
+    Vector3 penetratingVertices[HULL_PLANE_MAX_VERTICES];
+    float depths[HULL_PLANE_MAX_VERTICES];
+    for (int i = 0; i < count; ++i) {
+        penetratingVertices[i] = localToWorld * (shape.GetVertices()[vertexIndices[i]] * hull->scale);
+        depths[i] = plane->distance - plane->normal.Dot(penetratingVertices[i]);
+    }
+
+    CollisionManifold newContact;
+    newContact.bodies[0] = hull->rigidBody;
+    newContact.bodies[1] = nullptr;
+    newContact.collisionNormal = plane->normal;
+    newContact.restitution = groundRestitution;
+    newContact.friction = friction;
+
+    int selected[CollisionManifold::MAX_POINTS];
+    const int selectedCount = SelectManifoldPoints(penetratingVertices, depths, count, plane->normal, selected);
+    for (int i = 0; i < selectedCount; ++i) {
+        const int idx = selected[i];
+        newContact.AddPoint({ { true, Vector3(penetratingVertices[idx]) },
+                            { false, Vector3{} } },
+                            depths[idx], vertexIndices[idx]);
+    }
+    manifolds.push_back(newContact);
+    return true;
 }
 
-bool CollisionManager::FindCollisionFeatures(const BoxCollider* box,const Plane* plane){
+bool physics::CollisionManager::FindCollisionFeatures(const Collider* collider, const Constraint* constraint, std::vector<CollisionManifold>& manifolds){
+    const ConstraintTestEntry& entry = constraintTests[static_cast<int>(collider->GetShapeType())][static_cast<int>(constraint->GetConstraintType())];
+    if (entry.test == nullptr) {
+        //Plane is the only constraint
+        return FindConvexFeatures(collider, static_cast<const Plane*>(constraint), manifolds);
+    }
+    return entry.test(*this, collider, constraint, manifolds);
+}
+
+//the cores apart, the margins tell the contact from the closest points (spheres never need EPA unless deep).
+//Overlapping cores : GJK/EPA on the whole shapes
+bool CollisionManager::FindConvexFeatures(const Collider* shape1, const Collider* shape2, std::vector<CollisionManifold>& manifolds){
+    Penetration penetration;
+    ClosestPoints closest;
+    if (GjkDistance(*shape1, *shape2, closest) == true) {
+        const float margin1 = shape1->GetMargin();
+        const float margin2 = shape2->GetMargin();
+        if (closest.distance >= margin1 + margin2) {
+            return false;
+        }
+        penetration.normal = (closest.point1 - closest.point2) * (1.0f / closest.distance);
+        penetration.depth = margin1 + margin2 - closest.distance;
+        penetration.point1 = closest.point1 - penetration.normal * margin1;
+        penetration.point2 = closest.point2 + penetration.normal * margin2;
+    }
+    else {
+        Simplex simplex;
+        if (Gjk(*shape1, *shape2, simplex) == false) {
+            return false;
+        }
+        Epa(*shape1, *shape2, simplex, penetration);//not converged : the closest face found is close enough
+        if (penetration.depth <= 0.0f) {
+            return false;
+        }
+    }
+
+    CollisionManifold newContact;
+    newContact.bodies[0] = shape1->rigidBody;
+    newContact.bodies[1] = shape2->rigidBody;
+    newContact.collisionNormal = penetration.normal;
+    newContact.AddPoint({ { true, penetration.point1 },
+                        { true, penetration.point2 } },
+                        penetration.depth, 0);
+    newContact.restitution = objectRestitution;
+    newContact.friction = friction;
+    manifolds.push_back(newContact);
+    return true;
+}
+
+bool CollisionManager::FindConvexFeatures(const Collider* collider, const Plane* plane, std::vector<CollisionManifold>& manifolds){
+    Vector3 deepestPoint = collider->GetSupport(plane->normal * -1.0f) - plane->normal * collider->GetMargin();
+    float depth = plane->distance - plane->normal.Dot(deepestPoint);
+    if (depth <= 0.0f) {
+        return false;
+    }
+
+    CollisionManifold newContact;
+    newContact.bodies[0] = collider->rigidBody;
+    newContact.bodies[1] = nullptr;
+    newContact.collisionNormal = plane->normal;
+    newContact.AddPoint({ { true, deepestPoint },
+                        { false, Vector3{} } },
+                        depth, 0);
+    newContact.restitution = groundRestitution;
+    newContact.friction = friction;
+    manifolds.push_back(newContact);
+    return true;
+}
+
+bool CollisionManager::FindCollisionFeatures(const BoxCollider* box,const Plane* plane,std::vector<CollisionManifold>& manifolds){
     Vector3 vertices[8];
     vertices[0] = Vector3(-box->extents.x, box->extents.y, box->extents.z);
     vertices[1] = Vector3(-box->extents.x, -box->extents.y, box->extents.z);
@@ -271,7 +955,10 @@ bool CollisionManager::FindCollisionFeatures(const BoxCollider* box,const Plane*
         vertices[i] = box->rigidBody->GetLocalToWorldMatrix() * vertices[i];
     }
 
-    bool hasContacted = false;
+    Vector3 penetratingVertices[8];
+    float depths[8];
+    int vertexIndices[8];
+    int count = 0;
 
     for (int i = 0; i < 8; ++i)
     {
@@ -279,21 +966,35 @@ bool CollisionManager::FindCollisionFeatures(const BoxCollider* box,const Plane*
 
         if (distance < plane->distance)
         {
-            CollisionManifold newContact;
-            newContact.bodies[0] = box->rigidBody;
-            newContact.bodies[1] = nullptr;
-            newContact.collisionNormal = plane->normal;
-            newContact.contactPoint={{ true, Vector3(vertices[i]) },
-                                        {false, Vector3{}}};
-            newContact.penetrationDepth = plane->distance -distance;
-            newContact.restitution = groundRestitution;
-            newContact.friction = friction;
-
-            contacts.push_back(newContact);
-            hasContacted = true;
+            penetratingVertices[count] = vertices[i];
+            depths[count] = plane->distance - distance;
+            vertexIndices[count] = i;
+            ++count;
         }
     }
-    return hasContacted;
+    if (count == 0) {
+        return false;
+    }
+
+    //a tilted box can push up to 8 vertices under the ground, one manifold keeps the best 4
+    CollisionManifold newContact;
+    newContact.bodies[0] = box->rigidBody;
+    newContact.bodies[1] = nullptr;
+    newContact.collisionNormal = plane->normal;
+    newContact.restitution = groundRestitution;
+    newContact.friction = friction;
+
+    int selected[CollisionManifold::MAX_POINTS];
+    int selectedCount = SelectManifoldPoints(penetratingVertices, depths, count, plane->normal, selected);
+    for (int i = 0; i < selectedCount; ++i) {
+        int idx = selected[i];
+        newContact.AddPoint({ { true, Vector3(penetratingVertices[idx]) },
+                            { false, Vector3{} } },
+                            depths[idx], vertexIndices[idx]);
+    }
+
+    manifolds.push_back(newContact);
+    return true;
 }
 
 float CollisionManager::CaclRaySphereHitPointDistance(const Vector3& origin,const Vector3& direction,const SphereCollider& sphere){
@@ -350,38 +1051,283 @@ float CollisionManager::RayAndBox(const Vector3& origin,const Vector3& direction
     return tNearMax;
 }
 
-float CollisionManager::CalcPenetration(const BoxCollider& box1, const BoxCollider& box2, const Vector3& axis){
-    Vector3 centerToCenter = box2.rigidBody->GetPosition() - box1.rigidBody->GetPosition();
-    float projectedCenterToCenter = abs(centerToCenter.Dot(axis));
+//the caps as spheres, the side as a cylinder between them
+float CollisionManager::RayAndCapsule(const Vector3& origin, const Vector3& direction, const CapsuleCollider& capsule){
+    Vector3 start, end;
+    capsule.GetSegment(start, end);
+    float hitDistance = FLT_MAX;
+    for (const Vector3& center : { start, end }) {
+        const float distance = CalcRaySphereDistance(origin, direction, center, capsule.radius);
+        if (distance >= 0.0f && distance < hitDistance) {
+            hitDistance = distance;
+        }
+    }
 
-    float projectedSum = 
-          abs((box1.rigidBody->GetAxis(0) * box1.extents.x).Dot(axis))
-        + abs((box1.rigidBody->GetAxis(1) * box1.extents.y).Dot(axis))
-        + abs((box1.rigidBody->GetAxis(2) * box1.extents.z).Dot(axis))
-        
-        + abs((box2.rigidBody->GetAxis(0) * box2.extents.x).Dot(axis))
-        + abs((box2.rigidBody->GetAxis(1) * box2.extents.y).Dot(axis))
-        + abs((box2.rigidBody->GetAxis(2) * box2.extents.z).Dot(axis));
+    const Vector3 axis = capsule.rigidBody->GetAxis(1);
+    const float length = capsule.halfHeight * 2.0f;
+    const Vector3 startToOrigin = origin - start;
+    const Vector3 perpendicularDirection = direction - axis * direction.Dot(axis);
+    const Vector3 perpendicularOffset = startToOrigin - axis * startToOrigin.Dot(axis);
+    const float a = perpendicularDirection.LengthSquared();
+    if (a > FLT_EPSILON) {
+        const float b = perpendicularOffset.Dot(perpendicularDirection);
+        const float c = perpendicularOffset.LengthSquared() - capsule.radius * capsule.radius;
+        const float discriminant = b * b - a * c;
+        if (discriminant >= 0.0f) {
+            const float distance = (-b - sqrtf(discriminant)) / a;
+            const float height = (startToOrigin + direction * distance).Dot(axis);
+            if (distance >= 0.0f && height >= 0.0f && height <= length && distance < hitDistance) {
+                hitDistance = distance;
+            }
+        }
+    }
+    return hitDistance == FLT_MAX ? -1.0f : hitDistance;
+}
+
+//the ray clipped by the planes of the faces, in local space (scaled down, the distance along the ray stays the same)
+float CollisionManager::RayAndConvexHull(const Vector3& origin, const Vector3& direction, const ConvexHullCollider& hull){
+    Matrix4 localToWorld = hull.rigidBody->GetLocalToWorldMatrix();
+    const Matrix3 worldToLocal = localToWorld.Extract3x3Matrix();
+    const float inverseScale = 1.0f / hull.scale;
+    const Vector3 localOrigin = worldToLocal * (origin - hull.rigidBody->GetPosition()) * inverseScale;
+    const Vector3 localDirection = worldToLocal * direction * inverseScale;
 
-    return projectedSum - projectedCenterToCenter;
+    float tNearMax = 0.0f;
+    float tFarMin = FLT_MAX;
+    for (const ConvexHull::Face& face : hull.hull->GetFaces()) {
+        const float height = face.normal.Dot(localOrigin) - face.distance;
+        const float speed = face.normal.Dot(localDirection);
+        if (std::abs(speed) > FLT_EPSILON) {
+            const float t = -height / speed;
+            if (speed < 0.0f) {
+                tNearMax = std::max(tNearMax, t);
+            }
+            else {
+                tFarMin = std::min(tFarMin, t);
+            }
+            if (tFarMin < tNearMax) {
+                return -1.0f;
+            }
+        }
+        else if (height > 0.0f) {
+            return -1.0f;
+        }
+    }
+    return tNearMax;
+}
+
+//contact reduction : the deepest point, the one farthest from it, then the ones spanning the largest area with them
+int CollisionManager::SelectManifoldPoints(const Vector3* positions, const float* depths, int count, const Vector3& normal, int* selected) const{
+    if (count <= CollisionManifold::MAX_POINTS) {
+        for (int i = 0; i < count; ++i) {
+            selected[i] = i;
+        }
+        return count;
+    }
+
+    //1. deepest
+    int a = 0;
+    for (int i = 1; i < count; ++i) {
+        if (depths[i] > depths[a]) {
+            a = i;
+        }
+    }
+
+    //2. farthest from a
+    int b = -1;
+    float maxDistanceSquared = -1.0f;
+    for (int i = 0; i < count; ++i) {
+        float distanceSquared = (positions[i] - positions[a]).LengthSquared();
+        if (i != a && distanceSquared > maxDistanceSquared) {
+            maxDistanceSquared = distanceSquared;
+            b = i;
+        }
+    }
+
+    //3. largest triangle (a,b,c), area measured in the contact plane
+    int c = -1;
+    float maxArea = -1.0f;
+    float orientation = 1.0f;
+    for (int i = 0; i < count; ++i) {
+        if (i == a || i == b) {
+            continue;
+        }
+        float signedArea = (positions[b] - positions[a]).Cross(positions[i] - positions[a]).Dot(normal);
+        if (std::abs(signedArea) > maxArea) {
+            maxArea = std::abs(signedArea);
+            orientation = (signedArea < 0.0f) ? -1.0f : 1.0f;
+            c = i;
+        }
+    }
+
+    //4. the point lying the farthest outside of the triangle adds the most area
+    auto edgeArea = [&](int from, int to, int i) {
+        return (positions[to] - positions[from]).Cross(positions[i] - positions[from]).Dot(normal) * orientation;
+    };
+    int d = -1;
+    float minArea = FLT_MAX;
+    for (int i = 0; i < count; ++i) {
+        if (i == a || i == b || i == c) {
+            continue;
+        }
+        float area = std::min(edgeArea(a, b, i), std::min(edgeArea(b, c, i), edgeArea(c, a, i)));
+        if (area < minArea) {
+            minArea = area;
+            d = i;
+        }
+    }
+
+    selected[0] = a;
+    selected[1] = b;
+    selected[2] = c;
+    selected[3] = d;
+    return CollisionManifold::MAX_POINTS;
+}
+
+//Sutherland-Hodgman : the incident face is clipped against the side planes of the reference face,
+//the clipped points below the reference face become the manifold (up to 8, reduced to MAX_POINTS)
+//returns false if nothing is left, then the single point version is used
+bool CollisionManager::ClipBoxFaces(const BoxCollider& box1, const BoxCollider& box2, CollisionManifold& newContact, int minPenetrationAxisIdx) const{
+    constexpr int MAX_CLIP_VERTICES = 8;//a quad clipped by a rectangle
+
+    const bool isBox1Reference = minPenetrationAxisIdx < 3;
+    const BoxCollider& reference = isBox1Reference ? box1 : box2;
+    const BoxCollider& incident = isBox1Reference ? box2 : box1;
+    const int referenceAxis = minPenetrationAxisIdx % 3;
+
+    //outward normal of the reference face (towards the incident box)
+    const Vector3 referenceNormal = isBox1Reference ? -newContact.collisionNormal : newContact.collisionNormal;
+    const Vector3 referenceCenter = reference.rigidBody->GetPosition() + referenceNormal * reference.extents[referenceAxis];
+
+    //1. incident face : the face of the other box most anti-parallel to the reference normal
+    int incidentAxis = 0;
+    float minDot = FLT_MAX;
+    float incidentSign = 1.0f;
+    for (int i = 0; i < 3; ++i) {
+        float dot = incident.rigidBody->GetAxis(i).Dot(referenceNormal);
+        if (-std::abs(dot) < minDot) {
+            minDot = -std::abs(dot);
+            incidentAxis = i;
+            incidentSign = (dot > 0.0f) ? -1.0f : 1.0f;
+        }
+    }
+    const int incidentFace = incidentAxis * 2 + (incidentSign < 0.0f ? 1 : 0);
+
+    const Vector3 incidentNormal = incident.rigidBody->GetAxis(incidentAxis) * incidentSign;
+    const Vector3 incidentCenter = incident.rigidBody->GetPosition() + incidentNormal * incident.extents[incidentAxis];
+    const int u = (incidentAxis + 1) % 3;
+    const int v = (incidentAxis + 2) % 3;
+    const Vector3 incidentU = incident.rigidBody->GetAxis(u) * incident.extents[u];
+    const Vector3 incidentV = incident.rigidBody->GetAxis(v) * incident.extents[v];
+
+    //every vertex remembers where it came from (feature id) and on which line its outgoing edge lies
+    //(0~3 : incident edges, 4~7 : side planes) so that the ids stay the same from step to step
+    struct ClipVertex
+    {
+        Vector3 position;
+        int id;
+        int edge;
+    };
+    ClipVertex polygon[MAX_CLIP_VERTICES] = {
+        { incidentCenter + incidentU + incidentV, 0, 0 },
+        { incidentCenter - incidentU + incidentV, 1, 1 },
+        { incidentCenter - incidentU - incidentV, 2, 2 },
+        { incidentCenter + incidentU - incidentV, 3, 3 },
+    };
+    int polygonCount = 4;
+
+    //2. clip against the 4 side planes of the reference face, keep : dot(n, p) <= offset
+    //   the planes are pushed out a bit, so that the vertices of a same sized box stacked on top
+    //   are kept as they are instead of being replaced by intersections every other step
+    constexpr float CLIP_SLOP_RATIO = 0.01f;
+    ClipVertex clipped[MAX_CLIP_VERTICES];
+    for (int plane = 0; plane < 4; ++plane) {
+        const int sideAxis = (referenceAxis + 1 + plane / 2) % 3;
+        const Vector3 sideNormal = reference.rigidBody->GetAxis(sideAxis) * ((plane % 2 == 0) ? 1.0f : -1.0f);
+        const float offset = sideNormal.Dot(reference.rigidBody->GetPosition()) + reference.extents[sideAxis] * (1.0f + CLIP_SLOP_RATIO);
+
+        int clippedCount = 0;
+        for (int i = 0; i < polygonCount; ++i) {
+            const ClipVertex& current = polygon[i];
+            const ClipVertex& next = polygon[(i + 1) % polygonCount];
+            float currentDistance = sideNormal.Dot(current.position) - offset;
+            float nextDistance = sideNormal.Dot(next.position) - offset;
+
+            if (currentDistance <= 0.0f) {
+                clipped[clippedCount++] = current;
+            }
+            if ((currentDistance <= 0.0f) != (nextDistance <= 0.0f)) {
+                ClipVertex intersection;
+                intersection.position = current.position + (next.position - current.position) * (currentDistance / (currentDistance - nextDistance));
+                intersection.id = 8 + current.edge * 8 + plane;
+                //leaving : the rest of the edge runs along the side plane
+                intersection.edge = (currentDistance <= 0.0f) ? 4 + plane : current.edge;
+                clipped[clippedCount++] = intersection;
+            }
+        }
+
+        polygonCount = clippedCount;
+        std::copy(clipped, clipped + clippedCount, polygon);
+        if (polygonCount == 0) {
+            return false;
+        }
+    }
+
+    //3. keep the points below the reference face
+    Vector3 positions[MAX_CLIP_VERTICES];
+    float depths[MAX_CLIP_VERTICES];
+    int ids[MAX_CLIP_VERTICES];
+    int count = 0;
+    for (int i = 0; i < polygonCount; ++i) {
+        float separation = referenceNormal.Dot(polygon[i].position - referenceCenter);
+        if (separation <= 0.0f) {
+            positions[count] = polygon[i].position;
+            depths[count] = -separation;
+            ids[count] = polygon[i].id;
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    //4. reduction, p1 is on box1 and p2 on box2
+    int selected[CollisionManifold::MAX_POINTS];
+    int selectedCount = SelectManifoldPoints(positions, depths, count, referenceNormal, selected);
+    for (int i = 0; i < selectedCount; ++i) {
+        int idx = selected[i];
+        Vector3 onIncident = positions[idx];
+        Vector3 onReference = onIncident + referenceNormal * depths[idx];
+
+        ContactPoint contactPoint = isBox1Reference
+            ? ContactPoint{ { true, onReference }, { true, onIncident } }
+            : ContactPoint{ { true, onIncident }, { true, onReference } };
+        newContact.AddPoint(contactPoint, depths[idx], (minPenetrationAxisIdx << 10) | (incidentFace << 7) | ids[idx]);
+    }
+    return true;
 }
 
-void CollisionManager::CalcOBBsContactPoints(const BoxCollider& box1, const BoxCollider& box2, CollisionManifold& newContact, int minPenetrationAxisIdx) const{
+//single point manifold, used for the edge-edge cases and when the clipping found nothing
+void CollisionManager::CalcOBBsContactPoints(const BoxCollider& box1, const BoxCollider& box2, CollisionManifold& newContact, float penetration, int minPenetrationAxisIdx) const{
+    constexpr int SINGLE_POINT_FEATURE = 1 << 16;//keeps these ids apart from the clipped ones
+
     //  	1. for cases 0 to 5, vertices are found to define contact points
     if (minPenetrationAxisIdx >= 0 && minPenetrationAxisIdx < 3)
     {
         Vector3 contactPoint = box2.GetLocalContactVertex(newContact.collisionNormal, math::Less);
+        int featureId = SINGLE_POINT_FEATURE | (minPenetrationAxisIdx << 3) | GetVertexFeatureId(contactPoint);
 
         contactPoint = box2.rigidBody->GetLocalToWorldMatrix() * contactPoint;
-        newContact.contactPoint={{true, contactPoint + newContact.collisionNormal * newContact.penetrationDepth},
-                                {true, contactPoint}};
+        newContact.AddPoint({{true, contactPoint + newContact.collisionNormal * penetration},
+                            {true, contactPoint}}, penetration, featureId);
     }
     else if (minPenetrationAxisIdx >= 3 && minPenetrationAxisIdx < 6) {
         Vector3 contactPoint = box1.GetLocalContactVertex(newContact.collisionNormal, math::Greater);
+        int featureId = SINGLE_POINT_FEATURE | (minPenetrationAxisIdx << 3) | GetVertexFeatureId(contactPoint);
 
         contactPoint = box1.rigidBody->GetLocalToWorldMatrix() * contactPoint;
-        newContact.contactPoint={{true, contactPoint},
-                            {true, contactPoint - newContact.collisionNormal * newContact.penetrationDepth}};
+        newContact.AddPoint({{true, contactPoint},
+                            {true, contactPoint - newContact.collisionNormal * penetration}}, penetration, featureId);
     }
     //    2. for cases 6 to 15, points on the edges of the bounding boxes are used.
     else
@@ -395,7 +1341,7 @@ void CollisionManager::CalcOBBsContactPoints(const BoxCollider& box1, const BoxC
         // to represent the correct side of the box where the collision occurred.
         Vector3 vertexOne = box1.GetLocalContactVertex(newContact.collisionNormal, math::Greater);
         Vector3 vertexTwo = box2.GetLocalContactVertex(newContact.collisionNormal, math::Less);
-
+        int featureId = SINGLE_POINT_FEATURE | (minPenetrationAxisIdx << 6) | (GetVertexFeatureId(vertexOne) << 3) | GetVertexFeatureId(vertexTwo);
 
         int testAxis1{ -1 }, testAxis2{-1};
         
@@ -470,108 +1416,355 @@ void CollisionManager::CalcOBBsContactPoints(const BoxCollider& box1, const BoxC
         //projecting the vector from closestPointOne to vertexTwo onto direction2.
         Vector3 closestPointTwo{ vertexTwo + edge2 * ((closestPointOne - vertexTwo).Dot(edge2)) };
 
-        newContact.contactPoint={{ true, closestPointOne },
-                                { true, closestPointTwo }};
+        newContact.AddPoint({{ true, closestPointOne },
+                            { true, closestPointTwo }}, penetration, featureId);
     }
 }
 
 
-//https://allenchou.net/2013/12/game-physics-constraints-sequential-impulse/
-//https://code.tutsplus.com/series/how-to-create-a-custom-physics-engine--gamedev-12715
-void CollisionManager::SequentialImpulse(CollisionManifold contact, float deltaTime) {
-    // Compute the effective mass
-    float inverseMassSum = contact.bodies[0]->GetInverseMass();
-    if (contact.bodies[1]) {
-        inverseMassSum += contact.bodies[1]->GetInverseMass();
+//which corner of the box, one bit per axis (set : negative side)
+int CollisionManager::GetVertexFeatureId(const Vector3& localVertex) const{
+    return (localVertex.x < 0.0f ? 1 : 0) | (localVertex.y < 0.0f ? 2 : 0) | (localVertex.z < 0.0f ? 4 : 0);
+}
+
+void CollisionManager::RemoveCachedContacts(const RigidBody* body){
+    for (auto itr = contactCache.begin(); itr != contactCache.end();) {
+        if (itr->first.bodies[0] == body || itr->first.bodies[1] == body) {
+            itr = contactCache.erase(itr);
+        }
+        else {
+            ++itr;
+        }
     }
-    if (inverseMassSum == 0.0f) {
+}
+
+//the contacts found again this step start from the impulses they ended with the last step,
+//so the solver doesn't have to build up the impulse that holds a resting body from scratch
+void CollisionManager::WarmStart(){
+    if (warmStarting == false) {
         return;
     }
+    for (auto& contact : contacts) {
+        //no normal (e.g. a sphere center inside a box) : the cached impulses would turn both velocities into NaN, never solved either
+        if (isnan(contact.collisionNormal.x)) {
+            continue;
+        }
+        Vector3 tangent1, tangent2;
+        contact.CalcTangents(tangent1, tangent2);
+
+        SolverBody bodies[2];
+        LoadSolverBodies(contact, bodies);
+        bool isWarmStarted = false;
+        for (int i = 0; i < contact.pointCount; ++i) {
+            ManifoldPoint& point = contact.points[i];
+            auto itr = contactCache.find(ContactKey(contact, point));
+            if (itr == contactCache.end()) {
+                continue;
+            }
+            point.accumulatedNormalImpulse = itr->second.normal;
+            point.accumulatedTangentImpulse[0] = itr->second.tangent[0];
+            point.accumulatedTangentImpulse[1] = itr->second.tangent[1];
 
-    // Contact point relative to the body's position
-    Vector3 r1 = contact.contactPoint.p1.second - contact.bodies[0]->GetPosition();
-    Vector3 r2;
+            Vector3 r1, r2;
+            CalcContactArms(contact, point, bodies, r1, r2);
 
-    // Inverse inertia tensors
-    Matrix3 i1 = contact.bodies[0]->GetInverseInertiaTensorWorld();
-    Matrix3 i2;
+            ApplyImpulses(bodies, point.accumulatedNormalImpulse, r1, r2, contact.collisionNormal);
+            ApplyImpulses(bodies, point.accumulatedTangentImpulse[0], r1, r2, tangent1);
+            ApplyImpulses(bodies, point.accumulatedTangentImpulse[1], r1, r2, tangent2);
+            isWarmStarted = true;
+        }
+        if (isWarmStarted) {
+            StoreSolverBodies(contact, bodies);
+        }
+    }
+}
 
-    // Denominator terms
-    Vector3 termInDenominator1 = (i1 * r1.Cross(contact.collisionNormal)).Cross(r1);
-    Vector3 termInDenominator2;
+//WarmStart() without applying them, SoftContactSolver::WarmStart() applies them every substep
+void CollisionManager::LoadCachedImpulses(){
+    for (auto& contact : contacts) {
+        for (int i = 0; i < contact.pointCount; ++i) {
+            ManifoldPoint& point = contact.points[i];
+            auto itr = contactCache.find(ContactKey(contact, point));
+            if (itr == contactCache.end()) {
+                continue;
+            }
+            point.accumulatedNormalImpulse = itr->second.normal;
+            point.accumulatedTangentImpulse[0] = itr->second.tangent[0];
+            point.accumulatedTangentImpulse[1] = itr->second.tangent[1];
+        }
+    }
+}
 
-    if (contact.bodies[1]) {
-        r2 = contact.contactPoint.p2.second - contact.bodies[1]->GetPosition();
-        i2 = contact.bodies[1]->GetInverseInertiaTensorWorld();
-        termInDenominator2 = (i2 * r2.Cross(contact.collisionNormal)).Cross(r2);
+//the pairs of sleeping islands aren't tested, their impulses are kept for the step the island wakes up in :
+//otherwise a stack that wakes starts from zero impulses and sags
+void CollisionManager::StoreImpulses(){
+    for (auto itr = contactCache.begin(); itr != contactCache.end();) {
+        const RigidBody* body1 = itr->first.bodies[0];
+        const RigidBody* body2 = itr->first.bodies[1];
+        if (IsActive(body1) || (body2 != nullptr && IsActive(body2))) {
+            itr = contactCache.erase(itr);
+        }
+        else {
+            ++itr;
+        }
     }
+    for (const auto& contact : contacts) {
+        for (int i = 0; i < contact.pointCount; ++i) {
+            const ManifoldPoint& point = contact.points[i];
+            contactCache[ContactKey(contact, point)] = {
+                point.accumulatedNormalImpulse,
+                { point.accumulatedTangentImpulse[0], point.accumulatedTangentImpulse[1] }
+            };
+        }
+    }
+}
 
-    // Compute the final effective mass
+//https://allenchou.net/2013/12/game-physics-constraints-sequential-impulse/
+//https://code.tutsplus.com/series/how-to-create-a-custom-physics-engine--gamedev-12715
+//the points of a manifold are solved one after another, each with its own accumulated impulses.
+//The bodies are gathered once, the points work on the copies, which are written back at the end
+float CollisionManager::SequentialImpulse(CollisionManifold& contact, float deltaTime) {
+    SolverBody bodies[2];
+    LoadSolverBodies(contact, bodies);
 
-                        //1. linear part      
-    float effectiveMass = inverseMassSum 
-                                +
-                        //2. angular part
-                        (termInDenominator1 + termInDenominator2).Dot(contact.collisionNormal);
-    if (effectiveMass == 0.0f) {
-        return;
+    // Compute the effective mass
+    float inverseMassSum = bodies[0].inverseMass + bodies[1].inverseMass;
+    if (inverseMassSum == 0.0f) {
+        return 0.0f;
     }
 
-    // Relative velocities
-    Vector3 relativeVel = contact.bodies[0]->GetLinearVelocity() + contact.bodies[0]->GetAngularVelocity().Cross(r1);
-    if (contact.bodies[1]) {
-        relativeVel -= (contact.bodies[1]->GetLinearVelocity() + contact.bodies[1]->GetAngularVelocity().Cross(r2));
+    // Inverse inertia tensors
+    const Matrix3& i1 = bodies[0].inverseInertiaTensorWorld;
+    const Matrix3& i2 = bodies[1].inverseInertiaTensorWorld;
+
+    float maxImpulseChange = 0.0f;
+    for (int i = 0; i < contact.pointCount; ++i) {
+        ManifoldPoint& point = contact.points[i];
+
+        // Contact point relative to the body's position
+        Vector3 r1, r2;
+        CalcContactArms(contact, point, bodies, r1, r2);
+
+        // Denominator terms
+        Vector3 termInDenominator1 = (i1 * r1.Cross(contact.collisionNormal)).Cross(r1);
+        Vector3 termInDenominator2;
+
+        if (contact.bodies[1]) {
+            termInDenominator2 = (i2 * r2.Cross(contact.collisionNormal)).Cross(r2);
+        }
+
+        // Compute the final effective mass
+
+                            //1. linear part      
+        float effectiveMass = inverseMassSum 
+                                    +
+                            //2. angular part
+                            (termInDenominator1 + termInDenominator2).Dot(contact.collisionNormal);
+        if (effectiveMass == 0.0f) {
+            continue;
+        }
+
+        // Relative velocities
+        Vector3 relativeVel = bodies[0].velocity + bodies[0].angularVelocity.Cross(r1);
+        if (contact.bodies[1]) {
+            relativeVel -= (bodies[1].velocity + bodies[1].angularVelocity.Cross(r2));
+        }
+
+        float relativeSpeed = relativeVel.Dot(contact.collisionNormal);
+
+        // Baumgarte Stabilization (for penetration & sinking resolution)
+        float baumgarte = 0.0f;
+        if (point.penetrationDepth > penetrationTolerance) {
+            baumgarte = ((point.penetrationDepth - penetrationTolerance) * CORRECTION_RATIO / deltaTime);
+        }
+
+        float restitutionTerm = 0.0f;
+        if (relativeSpeed > closingSpeedTolerance) {
+            restitutionTerm = contact.restitution * (relativeSpeed - closingSpeedTolerance);
+        }
+
+        // Compute the impulse
+        float jacobianImpulse = ((-(1 + restitutionTerm) * relativeSpeed) + baumgarte) / effectiveMass;
+
+        if (isnan(jacobianImpulse)) {
+            continue; 
+        }
+
+        // Clamp the accumulated impulse
+        float oldAccumulatedNormalImpulse = point.accumulatedNormalImpulse;
+        point.accumulatedNormalImpulse = std::max(oldAccumulatedNormalImpulse + jacobianImpulse, 0.0f);
+        jacobianImpulse = point.accumulatedNormalImpulse - oldAccumulatedNormalImpulse;
+        maxImpulseChange = std::max(maxImpulseChange, std::abs(jacobianImpulse));
+
+        // Apply impulses to the bodies
+        ApplyImpulses(bodies, jacobianImpulse, r1, r2, contact.collisionNormal);
+
+        // Compute and apply frictional impulses using the two tangents
+        maxImpulseChange = std::max(maxImpulseChange, ApplyFrictionImpulses(contact, bodies, point, r1, r2));
     }
+    StoreSolverBodies(contact, bodies);
+    return maxImpulseChange;
+}
 
-    float relativeSpeed = relativeVel.Dot(contact.collisionNormal);
+void CollisionManager::ResolveCollision(float deltaTime, JobSystem& jobSystem){
+    PROFILE_ZONE("Solver");
+    lastIterationCount = 0;
+    lastSolvedIslandCount = 0;
+    lastIslandIterationSum = 0;
+    WarmStart();
+    if (solverMode == SolverMode::GRAPH_COLORED) {
+        SolveColoredContacts(deltaTime, jobSystem);
+    }
+    else if (solverMode == SolverMode::SIMD_BATCHES) {
+        ColorContacts();
+        contactSolver.Prepare(contacts, colorOrder, colorStarts,
+            { deltaTime, penetrationTolerance, closingSpeedTolerance, CORRECTION_RATIO });
+        lastIterationCount = contactSolver.Solve(iterationLimit, solverTolerance, jobSystem);
+        contactSolver.Finish(contacts);
+    }
+    else {
+        SolveIslands(deltaTime);
+    }
 
-    // Baumgarte Stabilization (for penetration & sinking resolution)
-    float baumgarte = 0.0f;
-    constexpr float CORRECTION_RATIO = 0.1f;
-    if (contact.penetrationDepth > penetrationTolerance) {
-        baumgarte = ((contact.penetrationDepth - penetrationTolerance) * CORRECTION_RATIO / deltaTime);
+    //the colored solvers iterate all the contacts together, as one island
+    if (solverMode != SolverMode::SEQUENTIAL && contacts.empty() == false) {
+        lastSolvedIslandCount = 1;
+        lastIslandIterationSum = lastIterationCount;
     }
+    StoreImpulses();
+}
 
-    float restitutionTerm = 0.0f;
-    if (relativeSpeed > closingSpeedTolerance) {
-        restitutionTerm = contact.restitution * (relativeSpeed - closingSpeedTolerance);
+void CollisionManager::PrepareSubsteps(float substep){
+    //every substep solves all the contacts once, as one island
+    lastIterationCount = softContactSolver.GetSettings().substepCount;
+    lastSolvedIslandCount = contacts.empty() ? 0 : 1;
+    lastIslandIterationSum = contacts.empty() ? 0 : lastIterationCount;
+    if (warmStarting) {
+        LoadCachedImpulses();
     }
+    softContactSolver.Prepare(contacts, substep, penetrationTolerance);
+}
 
-    // Compute the impulse
-    float jacobianImpulse = ((-(1 + restitutionTerm) * relativeSpeed) + baumgarte) / effectiveMass;
+void CollisionManager::FinishSubsteps(){
+    softContactSolver.ApplyRestitution();
+    softContactSolver.Finish(contacts);
+    StoreImpulses();
+}
 
-    if (isnan(jacobianImpulse)) {
-        return; 
+//the islands share no movable body : solved one after the other, each one stops once it converged.
+//Within an island the contacts keep their detection order, so without early-out this matches one pass over all contacts
+void CollisionManager::SolveIslands(float deltaTime){
+    const int islandCount = static_cast<int>(islandStarts.size()) - 1;
+    for (int island = 0; island < islandCount; ++island) {
+        const int begin = islandStarts[island];
+        const int end = islandStarts[island + 1];
+
+        int iteration = 0;
+        while (iteration < iterationLimit) {
+            PROFILE_ZONE("Solver iteration");
+            float residual = 0.0f;
+            for (int i = begin; i < end; ++i) {
+                residual = std::max(residual, SequentialImpulse(contacts[islandContacts[i]], deltaTime));
+            }
+            ++iteration;
+            if (residual <= solverTolerance) {
+                break;
+            }
+        }
+        lastIterationCount = std::max(lastIterationCount, iteration);
+        lastIslandIterationSum += iteration;
+        ++lastSolvedIslandCount;
     }
+}
 
-    // Clamp the accumulated impulse
-    float oldAccumulatedNormalImpulse = contact.accumulatedNormalImpulse;
-    contact.accumulatedNormalImpulse = std::max(oldAccumulatedNormalImpulse + jacobianImpulse, 0.0f);
-    jacobianImpulse = contact.accumulatedNormalImpulse - oldAccumulatedNormalImpulse;
+//greedy coloring in detection order : a manifold takes the lowest color none of its movable bodies has yet.
+//fixed bodies and the ground only get read by the solver, so they don't create conflicts
+void CollisionManager::ColorContacts(){
+    const int contactCount = static_cast<int>(contacts.size());
+    bodyColorMasks.clear();
+    contactColors.resize(contactCount);
+    colorStarts.assign(MAX_COLORS + 2, 0);
+
+    for (int i = 0; i < contactCount; ++i) {
+        uint64_t* masks[2] = { nullptr, nullptr };
+        uint64_t usedColors = 0;
+        for (int j = 0; j < 2; ++j) {
+            const RigidBody* body = contacts[i].bodies[j];
+            if (body != nullptr && body->IsFixed() == false) {
+                masks[j] = &bodyColorMasks[body];
+                usedColors |= *masks[j];
+            }
+        }
 
-    // Apply impulses to the bodies
-    ApplyImpulses(contact, jacobianImpulse, r1, r2, contact.collisionNormal);
+        int color = 0;
+        while (color < MAX_COLORS && (usedColors & (uint64_t{ 1 } << color)) != 0) {
+            ++color;
+        }
+        if (color < MAX_COLORS) {
+            for (uint64_t* mask : masks) {
+                if (mask != nullptr) {
+                    *mask |= uint64_t{ 1 } << color;
+                }
+            }
+        }
+        contactColors[i] = color;
+        ++colorStarts[color + 1];
+    }
 
-    // Compute and apply frictional impulses using the two tangents
-    ApplyFrictionImpulses(contact, r1, r2);
+    //counting sort, keeps the detection order inside a color
+    for (int color = 0; color <= MAX_COLORS; ++color) {
+        colorStarts[color + 1] += colorStarts[color];
+    }
+    colorOrder.resize(contactCount);
+    std::vector<int> cursors(colorStarts.begin(), colorStarts.end() - 1);
+    for (int i = 0; i < contactCount; ++i) {
+        colorOrder[cursors[contactColors[i]]++] = i;
+    }
 }
 
-void CollisionManager::ResolveCollision(float deltaTime){
-    for (int i = 0; i < iterationLimit; ++i){
-        for (auto& contact : contacts){
-			SequentialImpulse(contact, deltaTime);
+//the manifolds of a color touch disjoint movable bodies, so solving them concurrently gives exactly
+//what solving them one after another would : still Gauss-Seidel, only in color order.
+//ParallelFor returns once the whole batch is done, which is the barrier between colors
+void CollisionManager::SolveColoredContacts(float deltaTime, JobSystem& jobSystem){
+    ColorContacts();
+
+    contactResiduals.resize(contacts.size());
+    for (int iteration = 0; iteration < iterationLimit && contacts.empty() == false; ++iteration) {
+        PROFILE_ZONE("Solver iteration");
+        for (int color = 0; color < MAX_COLORS; ++color) {
+            const int begin = colorStarts[color];
+            const int count = colorStarts[color + 1] - begin;
+            if (count == 0) {
+                break;//colors are handed out from 0 up
+            }
+            jobSystem.ParallelFor(count, CONTACT_GRAIN_SIZE, [this, begin, deltaTime](int first, int last) {
+                for (int i = first; i < last; ++i) {
+                    const int contactIdx = colorOrder[begin + i];
+                    contactResiduals[contactIdx] = SequentialImpulse(contacts[contactIdx], deltaTime);
+                }
+            });
+        }
+
+        //bodies in more than MAX_COLORS manifolds, rare enough to solve them on this thread
+        for (int i = colorStarts[MAX_COLORS]; i < colorStarts[MAX_COLORS + 1]; ++i) {
+            contactResiduals[colorOrder[i]] = SequentialImpulse(contacts[colorOrder[i]], deltaTime);
+        }
+
+        lastIterationCount = iteration + 1;
+        if (*std::max_element(contactResiduals.begin(), contactResiduals.end()) <= solverTolerance) {
+            break;
         }
     }
 }
 
-float CollisionManager::ComputeTangentialImpulses(CollisionManifold& contact, const Vector3& r1, const Vector3& r2, const Vector3& tangent) {
-    float inverseMassSum = contact.bodies[0]->GetInverseMass();
-    Vector3 termInDenominator1 = (contact.bodies[0]->GetInverseInertiaTensorWorld() * r1.Cross(tangent)).Cross(r1);
+float CollisionManager::ComputeTangentialImpulses(const CollisionManifold& contact, const SolverBody (&bodies)[2], ManifoldPoint& point, const Vector3& r1, const Vector3& r2, const Vector3& tangent, int tangentIdx) {
+    float inverseMassSum = bodies[0].inverseMass;
+    Vector3 termInDenominator1 = (bodies[0].inverseInertiaTensorWorld * r1.Cross(tangent)).Cross(r1);
     Vector3 termInDenominator2;
 
     if (contact.bodies[1]) {
-        inverseMassSum += contact.bodies[1]->GetInverseMass();
-        termInDenominator2 = (contact.bodies[1]->GetInverseInertiaTensorWorld() * r2.Cross(tangent)).Cross(r2);
+        inverseMassSum += bodies[1].inverseMass;
+        termInDenominator2 = (bodies[1].inverseInertiaTensorWorld * r2.Cross(tangent)).Cross(r2);
     }
 
     // Compute the effective mass for the friction/tangential direction
@@ -581,9 +1774,9 @@ float CollisionManager::ComputeTangentialImpulses(CollisionManifold& contact, co
     }
 
     // Calculate relative velocities along the tangent
-    Vector3 relativeVel = contact.bodies[0]->GetLinearVelocity() + contact.bodies[0]->GetAngularVelocity().Cross(r1);
+    Vector3 relativeVel = bodies[0].velocity + bodies[0].angularVelocity.Cross(r1);
     if (contact.bodies[1]) {
-        relativeVel -= (contact.bodies[1]->GetLinearVelocity() + contact.bodies[1]->GetAngularVelocity().Cross(r2));
+        relativeVel -= (bodies[1].velocity + bodies[1].angularVelocity.Cross(r2));
     }
 
     float relativeSpeedTangential = relativeVel.Dot(tangent);
@@ -591,51 +1784,42 @@ float CollisionManager::ComputeTangentialImpulses(CollisionManifold& contact, co
     // Compute the frictional impulse
     float frictionImpulseMagnitude = -relativeSpeedTangential / effectiveMassTangential;
 
-    // Coulomb's law: The frictional impulse should not be greater than the friction coefficient times the normal impulse
-    float maxFriction = contact.friction * contact.accumulatedNormalImpulse;
-    frictionImpulseMagnitude = std::clamp(frictionImpulseMagnitude, -maxFriction, maxFriction);
+    // Coulomb's law: The accumulated frictional impulse should not be greater than the friction coefficient times the normal impulse
+    float maxFriction = contact.friction * point.accumulatedNormalImpulse;
+    float oldAccumulatedTangentImpulse = point.accumulatedTangentImpulse[tangentIdx];
+    point.accumulatedTangentImpulse[tangentIdx] = std::clamp(oldAccumulatedTangentImpulse + frictionImpulseMagnitude, -maxFriction, maxFriction);
 
-    return frictionImpulseMagnitude;
+    return point.accumulatedTangentImpulse[tangentIdx] - oldAccumulatedTangentImpulse;
 }
 
-void CollisionManager::ApplyFrictionImpulses(CollisionManifold& contact, const Vector3& r1, const Vector3& r2) {
+float CollisionManager::ApplyFrictionImpulses(const CollisionManifold& contact, SolverBody (&bodies)[2], ManifoldPoint& point, const Vector3& r1, const Vector3& r2) {
 
     // Compute the two friction directions
     Vector3 tangent1, tangent2;
-    //erin catto - Box2D
-    if (abs(contact.collisionNormal.x) >= 0.57735f) {
-        tangent1 = Vector3(contact.collisionNormal.y, -contact.collisionNormal.x, 0.0f);
-    }
-    else {
-        tangent1 = Vector3(0.0f, contact.collisionNormal.z, -contact.collisionNormal.y);
-    }
-    tangent2 = contact.collisionNormal.Cross(tangent1);
+    contact.CalcTangents(tangent1, tangent2);
 
     // Compute the impulses in each direction and apply
-    float jacobianImpulseT1 = ComputeTangentialImpulses(contact, r1, r2, tangent1);
-    ApplyImpulses(contact, jacobianImpulseT1, r1, r2, tangent1);
+    float jacobianImpulseT1 = ComputeTangentialImpulses(contact, bodies, point, r1, r2, tangent1, 0);
+    ApplyImpulses(bodies, jacobianImpulseT1, r1, r2, tangent1);
+
+    float jacobianImpulseT2 = ComputeTangentialImpulses(contact, bodies, point, r1, r2, tangent2, 1);
+    ApplyImpulses(bodies, jacobianImpulseT2, r1, r2, tangent2);
 
-    float jacobianImpulseT2 = ComputeTangentialImpulses(contact, r1, r2, tangent2);
-    ApplyImpulses(contact, jacobianImpulseT2, r1, r2, tangent2);
+    return std::max(std::abs(jacobianImpulseT1), std::abs(jacobianImpulseT2));
 }
 
-void CollisionManager::ApplyImpulses(CollisionManifold& contact, float jacobianImpulse, const Vector3& r1, const Vector3& r2, const Vector3& direction) {
+//on the gathered bodies, fixed bodies (and the ground) keep their velocities
+void CollisionManager::ApplyImpulses(SolverBody (&bodies)[2], float jacobianImpulse, const Vector3& r1, const Vector3& r2, const Vector3& direction) {
     Vector3 linearImpulse = direction * jacobianImpulse;
     Vector3 angularImpulse1 = r1.Cross(direction) * jacobianImpulse;
     Vector3 angularImpulse2 = r2.Cross(direction) * jacobianImpulse;
 
-    contact.bodies[0]->SetLinearVelocity(
-        contact.bodies[0]->GetLinearVelocity() + linearImpulse * contact.bodies[0]->GetInverseMass()
-    );
-    contact.bodies[0]->SetAngularVelocity(
-        contact.bodies[0]->GetAngularVelocity() + contact.bodies[0]->GetInverseInertiaTensorWorld() * angularImpulse1
-    );
-    if (contact.bodies[1]) {
-        contact.bodies[1]->SetLinearVelocity(
-            contact.bodies[1]->GetLinearVelocity() - linearImpulse * contact.bodies[1]->GetInverseMass()
-        );
-        contact.bodies[1]->SetAngularVelocity(
-            contact.bodies[1]->GetAngularVelocity() - contact.bodies[1]->GetInverseInertiaTensorWorld() * angularImpulse2
-        );
+    if (bodies[0].inverseMass != 0.0f) {
+        bodies[0].velocity = bodies[0].velocity + linearImpulse * bodies[0].inverseMass;
+        bodies[0].angularVelocity = bodies[0].angularVelocity + bodies[0].inverseInertiaTensorWorld * angularImpulse1;
+    }
+    if (bodies[1].inverseMass != 0.0f) {
+        bodies[1].velocity = bodies[1].velocity - linearImpulse * bodies[1].inverseMass;
+        bodies[1].angularVelocity = bodies[1].angularVelocity - bodies[1].inverseInertiaTensorWorld * angularImpulse2;
     }
 }
\ No newline at end of file
@@ -1,16 +1,72 @@
 #pragma once
 
 #include "collider.h"
+#include "broadPhase.h"
+#include "jobSystem.h"
+#include "contactSolver.h"
+#include "softContactSolver.h"
+#include "stepStats.h"
 #include "simulator/object.h"
+#include <atomic>
 #include <memory>//std::unique_ptr
 #include <vector>
 #include <unordered_map>
+#include <cstdint>//uint64_t
 
 namespace physics
 {
+    enum class SolverMode
+    {
+        SEQUENTIAL,//contacts in detection order, on the calling thread
+        GRAPH_COLORED,//contacts grouped into batches sharing no movable body, each batch solved in parallel
+        SIMD_BATCHES,//GRAPH_COLORED over prepared SoA rows, 4 (SSE) or 8 (AVX2) manifolds per instruction
+        SOFT_SUBSTEPS//soft contacts, the step split into substeps of one solve and one relax pass, see SoftContactSolver
+    };
+
     class CollisionManager
     {
         friend class PhysicsWorld;
+
+    public:
+        static constexpr int PAIR_GRAIN_SIZE = 32;//narrow phase tests per job
+        static constexpr int CONTACT_GRAIN_SIZE = 16;//manifolds per job of a color batch
+        static constexpr int MAX_COLORS = 64;//one bit per color in a body mask, the rest is solved sequentially
+        static constexpr float CORRECTION_RATIO = 0.1f;//Baumgarte, share of the penetration resolved per step
+        static constexpr int AXIS_CACHE_SIZE = 4096;//slots of cachedAxes
+
+        //entries of the dispatch tables, the shapes come in the order they were registered in
+        typedef bool (*ShapeTest)(CollisionManager& manager, const Collider* shape1, const Collider* shape2, std::vector<CollisionManifold>& manifolds);
+        typedef bool (*ConstraintTest)(CollisionManager& manager, const Collider* shape, const Constraint* constraint, std::vector<CollisionManifold>& manifolds);
+        typedef float (*RayTest)(CollisionManager& manager, const Vector3& origin, const Vector3& direction, const Collider* shape);//-1 : missed
+
+    private:
+        struct ShapeTestEntry
+        {
+            ShapeTest test;//nullptr : the pair is never tested
+            ShapePairType pairType;
+            bool swapShapes;//registered as (type2, type1)
+        };
+        struct ConstraintTestEntry
+        {
+            ConstraintTest test;
+            ShapePairType pairType;
+        };
+
+        //indexed by ShapeType (and ConstraintType), filled before main() by RegisterBuiltInTests()
+        static ShapeTestEntry shapeTests[SHAPE_TYPE_COUNT][SHAPE_TYPE_COUNT];
+        static ConstraintTestEntry constraintTests[SHAPE_TYPE_COUNT][CONSTRAINT_TYPE_COUNT];
+        static RayTest rayTests[SHAPE_TYPE_COUNT];
+        static const bool builtInTestsRegistered;
+
+    private:
+        //what one chunk of the narrow phase found, chunks are contiguous ranges of the pairs (or objects)
+        //so concatenating the buffers in chunk order gives the pair order, whichever worker ran them
+        struct NarrowPhaseBuffer
+        {
+            std::vector<CollisionManifold> manifolds;
+            std::vector<RigidObject*> activatedSpawners;
+            std::array<int, SHAPE_PAIR_TYPE_COUNT> testCounts{};
+        };
         
     private:
         float friction;
@@ -18,41 +74,124 @@ namespace physics
         float groundRestitution;
 
         int iterationLimit;
-        float penetrationTolerance;
+        float solverTolerance;//an iteration applying no impulse change above it ends the solve
+        float penetrationTolerance;//slop, the overlap the Baumgarte bias leaves alone. With less a resting box stack jitters and never sleeps
         float closingSpeedTolerance;
 
         std::vector<physics::CollisionManifold> contacts;
 
+        //impulses of the last step's contacts, matched by (bodies, featureId)
+        std::unordered_map<ContactKey, CachedImpulse, ContactKeyHash> contactCache;
+        bool warmStarting;
+
+        std::unique_ptr<BroadPhase> broadPhase;
+        std::vector<ObjectPair> candidatePairs;
+        std::vector<NarrowPhaseBuffer> narrowPhaseBuffers;//reused, keeps their capacity
+        std::array<int, SHAPE_PAIR_TYPE_COUNT> narrowPhaseTestCounts{};//of the last DetectCollision()
+        //the axis that ended the last SAT of a box pair (separating or contact), tried first the next time.
+        //Slots are picked by the bodies' addresses and tagged : a slot two pairs share only costs a full test.
+        //Read and written by the narrow phase jobs : a stale entry only costs the full test, the result is the same
+        std::array<std::atomic<uint32_t>, AXIS_CACHE_SIZE> cachedAxes{};
+        //filled by PhysicsWorld from the islands : islandContacts[islandStarts[i], islandStarts[i+1]) are the contact indices of island i
+        std::vector<int> islandContacts;
+        std::vector<int> islandStarts;
+        std::vector<float> contactResiduals;//per contact, of the current iteration
+        //of the last ResolveCollision()
+        int lastIterationCount{};
+        int lastSolvedIslandCount{};
+        int lastIslandIterationSum{};
+
+        SolverMode solverMode;
+        //color c owns colorOrder[colorStarts[c], colorStarts[c+1]), color MAX_COLORS is the overflow batch
+        std::vector<int> colorOrder;//contact indices
+        std::vector<int> colorStarts;
+        std::vector<int> contactColors;
+        std::unordered_map<const RigidBody*, uint64_t> bodyColorMasks;//colors already used by the body
+        ContactSolver contactSolver;
+        SoftContactSolver softContactSolver;
+
     public:
         CollisionManager()
             : friction(0.6f), objectRestitution(0.5f), groundRestitution(0.2f),
-            iterationLimit(30), penetrationTolerance(0.0005f), closingSpeedTolerance(0.005f) {}
-    
-        void DetectCollision(const std::vector<RigidObject*>& objects, const std::vector<std::unique_ptr<Constraint>>& constraints);
-        void ResolveCollision(float deltaTime);
+            iterationLimit(30), solverTolerance(1e-4f), penetrationTolerance(0.005f), closingSpeedTolerance(0.005f),
+            warmStarting(true), broadPhase{ CreateBroadPhase(BroadPhaseType::SWEEP_AND_PRUNE) },
+            solverMode(SolverMode::SEQUENTIAL) {}
     
-    private:
-        //(1)RigidBodies
-        bool FindCollisionFeatures(const Collider*,const Collider*);
-        bool FindCollisionFeatures(const BoxCollider*,const SphereCollider*);
-        bool FindCollisionFeatures(const SphereCollider*,const SphereCollider*,bool isForBroadPhaseTest=false);
-        bool FindCollisionFeatures(const BoxCollider*,const BoxCollider*);
+        void DetectCollision(const std::vector<RigidObject*>& objects, const std::vector<std::unique_ptr<Constraint>>& constraints, JobSystem& jobSystem);
+        void ResolveCollision(float deltaTime, JobSystem& jobSystem);
+
+        //SolverMode::SOFT_SUBSTEPS, PhysicsWorld integrates between the softContactSolver passes
+        void PrepareSubsteps(float substep);
+        void FinishSubsteps();
+
+        //the collision part of the step stats : pairs, tests, contacts and solver iterations
+        void FillStepStats(StepStats& stats) const;
+
+        //drops the cached impulses of a body that is about to be freed
+        void RemoveCachedContacts(const RigidBody* body);
+
+        //a new shape registers its tests against every shape (itself included) and constraint,
+        //one registration covers both orders of a pair
+        static void RegisterShapeTest(ShapeType type1, ShapeType type2, ShapeTest test, ShapePairType pairType);
+        static void RegisterConstraintTest(ShapeType shapeType, ConstraintType constraintType, ConstraintTest test, ShapePairType pairType);
+        static void RegisterRayTest(ShapeType shapeType, RayTest test);
 
-        //(2)Constraints
-        bool FindCollisionFeatures(const Collider*,const Constraint*);
+        //distance along the (normalized) direction to the shape, -1 if the ray misses it
+        float CalcRayDistance(const Vector3& origin, const Vector3& direction, const Collider* shape);
 
-        bool FindCollisionFeatures(const SphereCollider*,const Plane*);
-        bool FindCollisionFeatures(const BoxCollider*,const Plane*);
+        //the narrow phase tests only read the bodies and append to the given manifolds, so they can run concurrently
+        //(1)RigidBodies, through the dispatch table
+        bool FindCollisionFeatures(const Collider*,const Collider*,std::vector<CollisionManifold>& manifolds);
+        bool FindCollisionFeatures(const BoxCollider*,const SphereCollider*,std::vector<CollisionManifold>& manifolds);
+        bool FindCollisionFeatures(const SphereCollider*,const SphereCollider*,std::vector<CollisionManifold>& manifolds);
+        bool FindCollisionFeatures(const BoxCollider*,const BoxCollider*,std::vector<CollisionManifold>& manifolds);
+        bool FindCollisionFeatures(const CapsuleCollider*,const CapsuleCollider*,std::vector<CollisionManifold>& manifolds);
+        bool FindCollisionFeatures(const CapsuleCollider*,const SphereCollider*,std::vector<CollisionManifold>& manifolds);
+        bool FindCollisionFeatures(const BoxCollider*,const CapsuleCollider*,std::vector<CollisionManifold>& manifolds);
+
+        //(2)Constraints, through the dispatch table
+        bool FindCollisionFeatures(const Collider*,const Constraint*,std::vector<CollisionManifold>& manifolds);
+
+        bool FindCollisionFeatures(const SphereCollider*,const Plane*,std::vector<CollisionManifold>& manifolds);
+        bool FindCollisionFeatures(const BoxCollider*,const Plane*,std::vector<CollisionManifold>& manifolds);
+        bool FindCollisionFeatures(const CapsuleCollider*,const Plane*,std::vector<CollisionManifold>& manifolds);
+        bool FindCollisionFeatures(const ConvexHullCollider*,const Plane*,std::vector<CollisionManifold>& manifolds);
+
+        //(3)the fallbacks of the shapes without a registered test : GJK/EPA (one point per manifold)
+        //and the support point against the plane
+        bool FindConvexFeatures(const Collider*,const Collider*,std::vector<CollisionManifold>& manifolds);
+        bool FindConvexFeatures(const Collider*,const Plane*,std::vector<CollisionManifold>& manifolds);
+
+        //one pass of the sequential solver over one manifold (also timed alone by the benchmarks),
+        //returns the largest impulse change it applied
+        float SequentialImpulse(CollisionManifold& contact, float deltaTime);
+    
+    private:
+        static bool RegisterBuiltInTests();
+        bool IsActive(const RigidBody* body) const;
+        static ShapePairType GetShapePairType(const Collider* shape1, const Collider* shape2);
+        static ShapePairType GetShapePairType(const Collider* collider, const Constraint* constraint);
+        void PrepareNarrowPhaseBuffers(int count);
+        void MergeNarrowPhaseBuffers();
 
         float CaclRaySphereHitPointDistance(const Vector3& origin,const Vector3& direction,const SphereCollider&);
         float RayAndBox(const Vector3& origin, const Vector3& direction, const BoxCollider&);
+        float RayAndCapsule(const Vector3& origin, const Vector3& direction, const CapsuleCollider&);
+        float RayAndConvexHull(const Vector3& origin, const Vector3& direction, const ConvexHullCollider&);
     
     private:
-        float CalcPenetration( const BoxCollider& box1, const BoxCollider& box2, const Vector3& axis);
-        void CalcOBBsContactPoints(const BoxCollider& box1, const BoxCollider& box2, CollisionManifold& newContact, int minPenetrationAxisIdx) const;
-        void SequentialImpulse(CollisionManifold contact, float deltaTime);
-        void ApplyImpulses(CollisionManifold& contact, float jacobianImpulse, const Vector3& r1, const Vector3& r2, const Vector3& direction);
-        void ApplyFrictionImpulses(CollisionManifold& contact, const Vector3& r1, const Vector3& r2);
-        float ComputeTangentialImpulses(CollisionManifold& contact, const Vector3& r1, const Vector3& r2, const Vector3& tangent);
+        void CalcOBBsContactPoints(const BoxCollider& box1, const BoxCollider& box2, CollisionManifold& newContact, float penetration, int minPenetrationAxisIdx) const;
+        bool ClipBoxFaces(const BoxCollider& box1, const BoxCollider& box2, CollisionManifold& newContact, int minPenetrationAxisIdx) const;
+        int SelectManifoldPoints(const Vector3* positions, const float* depths, int count, const Vector3& normal, int* selected) const;
+        int GetVertexFeatureId(const Vector3& localVertex) const;
+        void ColorContacts();
+        void SolveIslands(float deltaTime);
+        void SolveColoredContacts(float deltaTime, JobSystem& jobSystem);
+        void WarmStart();
+        void LoadCachedImpulses();
+        void StoreImpulses();
+        void ApplyImpulses(SolverBody (&bodies)[2], float jacobianImpulse, const Vector3& r1, const Vector3& r2, const Vector3& direction);
+        float ApplyFrictionImpulses(const CollisionManifold& contact, SolverBody (&bodies)[2], ManifoldPoint& point, const Vector3& r1, const Vector3& r2);
+        float ComputeTangentialImpulses(const CollisionManifold& contact, const SolverBody (&bodies)[2], ManifoldPoint& point, const Vector3& r1, const Vector3& r2, const Vector3& tangent, int tangentIdx);
     };
 }
\ No newline at end of file
@@ -2,7 +2,10 @@
 
 #include "body.h"
 #include <vector>
+#include <cassert>
+#include <cmath>//std::abs
 #include <utility>//std::pair
+#include <functional>//std::hash
 
 namespace physics
 {
@@ -11,19 +14,117 @@ namespace physics
         // p1 and p2 are the contacts point on the object.
         std::pair<bool, Vector3> p1, p2;
     };
+    //one point of a manifold, solved with its own impulses
+    struct ManifoldPoint
+    {
+        ContactPoint contactPoint;
+        float penetrationDepth;
+        float accumulatedNormalImpulse; //perpendicular to the collision surface, (frictions are parallel)
+        float accumulatedTangentImpulse[2]; //along the two friction directions
+        int featureId; //tells the points between the same bodies apart (e.g. which box vertex touches the ground)
+
+        ManifoldPoint() :contactPoint{}, penetrationDepth{}, accumulatedNormalImpulse{}, featureId{} {
+            accumulatedTangentImpulse[0] = accumulatedTangentImpulse[1] = 0.0f;
+        }
+    };
+
     //this struct refers to a specific space that contains all the possible initial conditions and final outcomes of a collision between objects
+    //a resting box touches with a whole face, so a manifold keeps up to MAX_POINTS points sharing one normal
     struct CollisionManifold
     {
+        static constexpr int MAX_POINTS = 4;
+
         RigidBody* bodies[2];
         Vector3 collisionNormal; //dir : body0 <--- body1
-        float penetrationDepth;
         float restitution;
         float friction;
-        float accumulatedNormalImpulse; //perpendicular to the collision surface, (frictions are parallel)
-        ContactPoint contactPoint;
+        ManifoldPoint points[MAX_POINTS];
+        int pointCount;
 
-        CollisionManifold() :collisionNormal{}, penetrationDepth{}, restitution{}, friction{}, accumulatedNormalImpulse{}, contactPoint{} {
+        CollisionManifold() :collisionNormal{}, restitution{}, friction{}, pointCount{} {
             bodies[0] = bodies[1] = nullptr;
         }
+
+        //generators reduce their points to MAX_POINTS first. Should a full manifold get another one anyway,
+        //it keeps the deepest points : the new point replaces the shallowest one or is dropped (returns false)
+        bool AddPoint(const ContactPoint& contactPoint, float penetrationDepth, int featureId) {
+            assert(pointCount < MAX_POINTS);
+            int idx = pointCount;
+            if (pointCount == MAX_POINTS) {
+                idx = 0;
+                for (int i = 1; i < MAX_POINTS; ++i) {
+                    if (points[i].penetrationDepth < points[idx].penetrationDepth) {
+                        idx = i;
+                    }
+                }
+                if (penetrationDepth <= points[idx].penetrationDepth) {
+                    return false;
+                }
+                points[idx] = ManifoldPoint();
+            }
+            else {
+                ++pointCount;
+            }
+
+            ManifoldPoint& point = points[idx];
+            point.contactPoint = contactPoint;
+            point.penetrationDepth = penetrationDepth;
+            point.featureId = featureId;
+            return true;
+        }
+
+        //erin catto - Box2D
+        //only depends on the normal, so the cached tangent impulses still point the same way in the next step
+        void CalcTangents(Vector3& tangent1, Vector3& tangent2) const {
+            if (std::abs(collisionNormal.x) >= 0.57735f) {
+                tangent1 = Vector3(collisionNormal.y, -collisionNormal.x, 0.0f);
+            }
+            else {
+                tangent1 = Vector3(0.0f, collisionNormal.z, -collisionNormal.y);
+            }
+            tangent1.Normalize();
+            tangent2 = collisionNormal.Cross(tangent1);
+        }
+
+        //from the centers of the bodies to the contact point, r2 is left untouched for the ground
+        void CalcContactArms(const ManifoldPoint& point, Vector3& r1, Vector3& r2) const {
+            r1 = point.contactPoint.p1.second - bodies[0]->GetPosition();
+            if (bodies[1]) {
+                r2 = point.contactPoint.p2.second - bodies[1]->GetPosition();
+            }
+        }
+    };
+
+    //identifies the same contact over consecutive steps
+    struct ContactKey
+    {
+        const RigidBody* bodies[2];
+        int featureId;
+
+        ContactKey(const CollisionManifold& manifold, const ManifoldPoint& point) : featureId{ point.featureId } {
+            bodies[0] = manifold.bodies[0];
+            bodies[1] = manifold.bodies[1];
+        }
+
+        bool operator==(const ContactKey& rhs) const {
+            return bodies[0] == rhs.bodies[0] && bodies[1] == rhs.bodies[1] && featureId == rhs.featureId;
+        }
+    };
+
+    struct ContactKeyHash
+    {
+        size_t operator()(const ContactKey& key) const {
+            size_t h = std::hash<const RigidBody*>()(key.bodies[0]);
+            h ^= std::hash<const RigidBody*>()(key.bodies[1]) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= std::hash<int>()(key.featureId) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    //impulses of a contact kept from the previous step, used for warm starting
+    struct CachedImpulse
+    {
+        float normal;
+        float tangent[2];
     };
 } 
\ No newline at end of file
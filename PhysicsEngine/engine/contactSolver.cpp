@@ -0,0 +1,323 @@
+#include "contactSolver.h"
+#include "profiler.h"
+#include <algorithm>//std::max
+#include <cmath>//std::isfinite
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>//__cpuid, _xgetbv
+#else
+#include <cpuid.h>
+#endif
+
+using namespace physics;
+
+#include "contactSolverKernel.h"
+
+namespace
+{
+    struct ScalarLanes
+    {
+        static constexpr int WIDTH = 1;
+        typedef float Type;
+
+        static Type Load(const float* values) { return *values; }
+        static void Store(float* values, Type value) { *values = value; }
+        static Type Set(float value) { return value; }
+        static Type Gather(const float* base, const int* slots) { return base[*slots]; }
+        static Type Add(Type a, Type b) { return a + b; }
+        static Type Sub(Type a, Type b) { return a - b; }
+        static Type Mul(Type a, Type b) { return a * b; }
+        static Type Max(Type a, Type b) { return std::max(a, b); }
+        static Type Min(Type a, Type b) { return std::min(a, b); }
+        static bool Greater(Type a, Type b) { return a > b; }
+        static Type Select(bool mask, Type a, Type b) { return mask ? a : b; }
+        static float ReduceMax(Type a) { return a; }
+    };
+
+    struct SseLanes
+    {
+        static constexpr int WIDTH = 4;
+        typedef __m128 Type;
+
+        static Type Load(const float* values) { return _mm_load_ps(values); }
+        static void Store(float* values, Type value) { _mm_store_ps(values, value); }
+        static Type Set(float value) { return _mm_set1_ps(value); }
+        static Type Gather(const float* base, const int* slots) {
+            return _mm_set_ps(base[slots[3]], base[slots[2]], base[slots[1]], base[slots[0]]);
+        }
+        static Type Add(Type a, Type b) { return _mm_add_ps(a, b); }
+        static Type Sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+        static Type Mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+        static Type Max(Type a, Type b) { return _mm_max_ps(a, b); }
+        static Type Min(Type a, Type b) { return _mm_min_ps(a, b); }
+        static Type Greater(Type a, Type b) { return _mm_cmpgt_ps(a, b); }
+        static Type Select(Type mask, Type a, Type b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+        static float ReduceMax(Type a) {
+            a = _mm_max_ps(a, _mm_movehl_ps(a, a));
+            return _mm_cvtss_f32(_mm_max_ss(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1))));
+        }
+    };
+
+    void CpuId(int leaf, int subLeaf, unsigned (&registers)[4]) {
+#if defined(_MSC_VER)
+        int values[4];
+        __cpuidex(values, leaf, subLeaf);
+        for (int i = 0; i < 4; ++i) {
+            registers[i] = static_cast<unsigned>(values[i]);
+        }
+#else
+        __cpuid_count(leaf, subLeaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    }
+
+    bool IsFinite(const Vector3& vec) {
+        return std::isfinite(vec.x) && std::isfinite(vec.y) && std::isfinite(vec.z);
+    }
+
+    unsigned long long ReadXcr0() {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+    }
+}
+
+SimdLevel physics::DetectSimdLevel(){
+    //SSE2 is part of x86-64, AVX2 needs the CPU flag and the OS saving the ymm registers
+    static const SimdLevel level = []() {
+        unsigned registers[4];
+        CpuId(0, 0, registers);
+        if (registers[0] < 7) {
+            return SimdLevel::SSE;
+        }
+
+        CpuId(1, 0, registers);
+        const bool hasOsxsave = (registers[2] & (1u << 27)) != 0;
+        const bool hasAvx = (registers[2] & (1u << 28)) != 0;
+        if (hasOsxsave == false || hasAvx == false || (ReadXcr0() & 0x6) != 0x6) {
+            return SimdLevel::SSE;
+        }
+
+        CpuId(7, 0, registers);
+        const bool hasAvx2 = (registers[1] & (1u << 5)) != 0;
+        return hasAvx2 ? SimdLevel::AVX2 : SimdLevel::SSE;
+    }();
+    return level;
+}
+
+float physics::SolveContactBatchScalar(ContactBatch& batch, SolverBodies& bodies, const ContactSolverSettings& settings){
+    float maxImpulseChange = 0.0f;
+    for (int lane = 0; lane < batch.laneCount; ++lane) {
+        maxImpulseChange = std::max(maxImpulseChange, SolveLanes<ScalarLanes>(batch, bodies, settings, lane));
+    }
+    return maxImpulseChange;
+}
+
+float physics::SolveContactBatchSse(ContactBatch& batch, SolverBodies& bodies, const ContactSolverSettings& settings){
+    float maxImpulseChange = 0.0f;
+    for (int laneOffset = 0; laneOffset < batch.laneCount; laneOffset += SseLanes::WIDTH) {
+        maxImpulseChange = std::max(maxImpulseChange, SolveLanes<SseLanes>(batch, bodies, settings, laneOffset));
+    }
+    return maxImpulseChange;
+}
+
+ContactSolver::ContactSolver()
+    : detectedSimdLevel{ DetectSimdLevel() }, simdLevel{ detectedSimdLevel }, settings{} {}
+
+void ContactSolver::SetSimdLevel(SimdLevel level){
+    simdLevel = std::min(level, detectedSimdLevel);
+}
+
+void ContactSolver::Prepare(const std::vector<CollisionManifold>& contacts, const std::vector<int>& colorOrder,
+    const std::vector<int>& colorStarts, const ContactSolverSettings& _settings)
+{
+    settings = _settings;
+
+    batches.clear();
+    colorBatchStarts.clear();
+    bodySlots.clear();
+    for (int i = 0; i < 3; ++i) {
+        bodies.linearVelocities[i].assign(1, 0.0f);
+        bodies.angularVelocities[i].assign(1, 0.0f);
+    }
+    bodies.bodies.assign(1, nullptr);//STATIC_SLOT
+
+    //the overflow manifolds may share bodies, one per batch
+    const int colorCount = static_cast<int>(colorStarts.size()) - 1;
+    for (int color = 0; color < colorCount; ++color) {
+        colorBatchStarts.push_back(static_cast<int>(batches.size()));
+        const int lanesPerBatch = (color == colorCount - 1) ? 1 : CONTACT_LANE_COUNT;
+
+        for (int begin = colorStarts[color]; begin < colorStarts[color + 1]; begin += lanesPerBatch) {
+            batches.emplace_back();//zeroed : empty lanes have no mass and use the static slot
+            ContactBatch& batch = batches.back();
+            const int end = std::min(begin + lanesPerBatch, colorStarts[color + 1]);
+            for (int i = begin; i < end; ++i) {
+                PrepareLane(batch, i - begin, contacts[colorOrder[i]], colorOrder[i]);
+            }
+        }
+    }
+    colorBatchStarts.push_back(static_cast<int>(batches.size()));
+}
+
+int ContactSolver::Solve(int maxIterations, float tolerance, JobSystem& jobSystem){
+    constexpr int BATCH_GRAIN_SIZE = 2;
+    const int colorCount = static_cast<int>(colorBatchStarts.size()) - 1;
+    if (batches.empty()) {
+        return 0;
+    }
+
+    for (int iteration = 0; iteration < maxIterations; ++iteration) {
+        PROFILE_ZONE("Solver iteration");
+        for (int color = 0; color < colorCount - 1; ++color) {
+            const int begin = colorBatchStarts[color];
+            jobSystem.ParallelFor(colorBatchStarts[color + 1] - begin, BATCH_GRAIN_SIZE, [this, begin](int first, int last) {
+                for (int i = first; i < last; ++i) {
+                    SolveBatch(batches[begin + i]);
+                }
+            });
+        }
+        if (colorCount > 0) {
+            for (int i = colorBatchStarts[colorCount - 1]; i < colorBatchStarts[colorCount]; ++i) {
+                SolveBatch(batches[i]);
+            }
+        }
+
+        float residual = 0.0f;
+        for (const ContactBatch& batch : batches) {
+            residual = std::max(residual, batch.residual);
+        }
+        if (residual <= tolerance) {
+            return iteration + 1;
+        }
+    }
+    return maxIterations;
+}
+
+void ContactSolver::Finish(std::vector<CollisionManifold>& contacts){
+    for (size_t slot = 1; slot < bodies.bodies.size(); ++slot) {
+        RigidBody* body = bodies.bodies[slot];
+        if (body->IsFixed()) {
+            continue;
+        }
+        body->SetLinearVelocity(bodies.linearVelocities[0][slot], bodies.linearVelocities[1][slot], bodies.linearVelocities[2][slot]);
+        body->SetAngularVelocity(bodies.angularVelocities[0][slot], bodies.angularVelocities[1][slot], bodies.angularVelocities[2][slot]);
+    }
+
+    for (const ContactBatch& batch : batches) {
+        for (int lane = 0; lane < batch.laneCount; ++lane) {
+            CollisionManifold& manifold = contacts[batch.manifoldIndices[lane]];
+            for (int i = 0; i < manifold.pointCount; ++i) {
+                const ContactRow& row = batch.rows[i];
+                manifold.points[i].accumulatedNormalImpulse = row.impulse[0][lane];
+                manifold.points[i].accumulatedTangentImpulse[0] = row.impulse[1][lane];
+                manifold.points[i].accumulatedTangentImpulse[1] = row.impulse[2][lane];
+            }
+        }
+    }
+}
+
+int ContactSolver::GetBodySlot(RigidBody* body){
+    auto itr = bodySlots.find(body);
+    if (itr != bodySlots.end()) {
+        return itr->second;
+    }
+
+    int slot = static_cast<int>(bodies.bodies.size());
+    Vector3 velocity = body->GetLinearVelocity();
+    Vector3 angularVelocity = body->GetAngularVelocity();
+    for (int i = 0; i < 3; ++i) {
+        bodies.linearVelocities[i].push_back(velocity[i]);
+        bodies.angularVelocities[i].push_back(angularVelocity[i]);
+    }
+    bodies.bodies.push_back(body);
+    bodySlots[body] = slot;
+    return slot;
+}
+
+void ContactSolver::PrepareLane(ContactBatch& batch, int lane, const CollisionManifold& manifold, int manifoldIdx){
+    RigidBody* bodyA = manifold.bodies[0];
+    RigidBody* bodyB = manifold.bodies[1];
+
+    batch.manifoldIndices[lane] = manifoldIdx;
+    batch.laneCount = lane + 1;
+    batch.pointCount = std::max(batch.pointCount, manifold.pointCount);
+    batch.bodyA[lane] = GetBodySlot(bodyA);
+    batch.bodyB[lane] = bodyB ? GetBodySlot(bodyB) : SolverBodies::STATIC_SLOT;
+    batch.inverseMassA[lane] = bodyA->GetInverseMass();
+    batch.inverseMassB[lane] = bodyB ? bodyB->GetInverseMass() : 0.0f;
+    batch.friction[lane] = manifold.friction;
+    batch.restitution[lane] = manifold.restitution;
+
+    const Matrix3 inverseInertiaA = bodyA->GetInverseInertiaTensorWorld();
+    const Matrix3 inverseInertiaB = bodyB ? bodyB->GetInverseInertiaTensorWorld() : Matrix3(0.0f);
+    const float inverseMassSum = batch.inverseMassA[lane] + batch.inverseMassB[lane];
+
+    //a degenerate contact (e.g. concentric spheres, no normal) stays all zero : it never produces an impulse,
+    //where SequentialImpulse skips its NaN impulses
+    Vector3 directions[3];
+    directions[0] = manifold.collisionNormal;
+    manifold.CalcTangents(directions[1], directions[2]);
+    if (IsFinite(directions[0]) == false || IsFinite(directions[1]) == false || IsFinite(directions[2]) == false) {
+        return;
+    }
+    for (int dir = 0; dir < 3; ++dir) {
+        for (int axis = 0; axis < 3; ++axis) {
+            batch.directions[dir][axis][lane] = directions[dir][axis];
+        }
+    }
+
+    for (int i = 0; i < manifold.pointCount; ++i) {
+        const ManifoldPoint& point = manifold.points[i];
+        ContactRow& row = batch.rows[i];
+
+        Vector3 r1, r2;
+        manifold.CalcContactArms(point, r1, r2);
+        if (IsFinite(r1) == false || IsFinite(r2) == false) {
+            continue;
+        }
+
+        for (int dir = 0; dir < 3; ++dir) {
+            Vector3 angularA = r1.Cross(directions[dir]);
+            Vector3 angularB = r2.Cross(directions[dir]);
+            Vector3 inertiaA = inverseInertiaA * angularA;
+            Vector3 inertiaB = inverseInertiaB * angularB;
+            for (int axis = 0; axis < 3; ++axis) {
+                row.angularA[dir][axis][lane] = angularA[axis];
+                row.angularB[dir][axis][lane] = angularB[axis];
+                row.inertiaA[dir][axis][lane] = inertiaA[axis];
+                row.inertiaB[dir][axis][lane] = inertiaB[axis];
+            }
+
+            float effectiveMass = inverseMassSum + (inertiaA.Cross(r1) + inertiaB.Cross(r2)).Dot(directions[dir]);
+            row.mass[dir][lane] = (inverseMassSum == 0.0f || effectiveMass == 0.0f) ? 0.0f : 1.0f / effectiveMass;
+        }
+
+        row.baumgarte[lane] = 0.0f;
+        if (point.penetrationDepth > settings.penetrationTolerance) {
+            row.baumgarte[lane] = (point.penetrationDepth - settings.penetrationTolerance) * settings.correctionRatio / settings.deltaTime;
+        }
+
+        row.impulse[0][lane] = point.accumulatedNormalImpulse;
+        row.impulse[1][lane] = point.accumulatedTangentImpulse[0];
+        row.impulse[2][lane] = point.accumulatedTangentImpulse[1];
+    }
+}
+
+void ContactSolver::SolveBatch(ContactBatch& batch){
+    switch (simdLevel)
+    {
+    case SimdLevel::AVX2:
+        batch.residual = SolveContactBatchAvx2(batch, bodies, settings);
+        break;
+    case SimdLevel::SSE:
+        batch.residual = SolveContactBatchSse(batch, bodies, settings);
+        break;
+    default:
+        batch.residual = SolveContactBatchScalar(batch, bodies, settings);
+        break;
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "contact.h"
+#include "jobSystem.h"
+#include <vector>
+#include <unordered_map>
+
+namespace physics
+{
+    enum class SimdLevel
+    {
+        SCALAR,
+        SSE,//4 manifolds per instruction
+        AVX2//8 manifolds per instruction
+    };
+
+    //what both the CPU and the OS support, checked once
+    SimdLevel DetectSimdLevel();
+
+    struct ContactSolverSettings
+    {
+        float deltaTime;
+        float penetrationTolerance;
+        float closingSpeedTolerance;
+        float correctionRatio;
+    };
+
+    constexpr int CONTACT_LANE_COUNT = 8;
+
+    //one manifold point of every lane, directions : 0 normal, 1-2 tangents.
+    //everything the solver needs but the velocities is computed once per step
+    struct alignas(32) ContactRow
+    {
+        float angularA[3][3][CONTACT_LANE_COUNT];//[direction][xyz] rA x direction
+        float angularB[3][3][CONTACT_LANE_COUNT];
+        float inertiaA[3][3][CONTACT_LANE_COUNT];//inverse inertia (world) * (rA x direction)
+        float inertiaB[3][3][CONTACT_LANE_COUNT];
+        float mass[3][CONTACT_LANE_COUNT];//1 / effective mass, 0 for the lanes with fewer points
+        float baumgarte[CONTACT_LANE_COUNT];
+        float impulse[3][CONTACT_LANE_COUNT];//accumulated
+    };
+
+    //up to CONTACT_LANE_COUNT manifolds of the same color, so no two lanes share a movable body
+    struct alignas(32) ContactBatch
+    {
+        int bodyA[CONTACT_LANE_COUNT];//slots in SolverBodies, empty lanes use the static slot
+        int bodyB[CONTACT_LANE_COUNT];
+        int manifoldIndices[CONTACT_LANE_COUNT];
+
+        float inverseMassA[CONTACT_LANE_COUNT];
+        float inverseMassB[CONTACT_LANE_COUNT];
+        float directions[3][3][CONTACT_LANE_COUNT];//[direction][xyz]
+        float friction[CONTACT_LANE_COUNT];
+        float restitution[CONTACT_LANE_COUNT];
+
+        ContactRow rows[CollisionManifold::MAX_POINTS];
+
+        //after the arrays, which have to stay 32-byte aligned
+        int laneCount;
+        int pointCount;//the most points of its manifolds
+        float residual;//largest impulse change of its last solve
+    };
+
+    //velocities of the bodies taking part in the contacts, one array per component (gathered by slot)
+    struct SolverBodies
+    {
+        static constexpr int STATIC_SLOT = 0;//the ground and empty lanes, never moves
+
+        std::vector<float> linearVelocities[3];
+        std::vector<float> angularVelocities[3];
+        std::vector<RigidBody*> bodies;//nullptr for STATIC_SLOT
+    };
+
+    //kernels, one per SimdLevel (the AVX2 one lives in its own translation unit), return the largest impulse change
+    float SolveContactBatchScalar(ContactBatch& batch, SolverBodies& bodies, const ContactSolverSettings& settings);
+    float SolveContactBatchSse(ContactBatch& batch, SolverBodies& bodies, const ContactSolverSettings& settings);
+    float SolveContactBatchAvx2(ContactBatch& batch, SolverBodies& bodies, const ContactSolverSettings& settings);
+
+    //Sequential impulse over prepared structure-of-arrays rows. The manifolds are packed into batches of one color,
+    //a kernel solves all the lanes of a batch at once : still Gauss-Seidel, since the lanes touch disjoint bodies.
+    //Same maths as CollisionManager::SequentialImpulse, without the getters and Matrix3 copies in the loop.
+    class ContactSolver
+    {
+    private:
+        SimdLevel detectedSimdLevel;
+        SimdLevel simdLevel;
+        ContactSolverSettings settings;
+
+        std::vector<ContactBatch> batches;
+        //color c owns batches[colorBatchStarts[c], colorBatchStarts[c+1]), the last range is the overflow (not parallel)
+        std::vector<int> colorBatchStarts;
+
+        SolverBodies bodies;
+        std::unordered_map<const RigidBody*, int> bodySlots;
+
+    public:
+        ContactSolver();
+
+        //e.g. SCALAR to compare against, can't go above what the CPU supports
+        void SetSimdLevel(SimdLevel level);
+        SimdLevel GetSimdLevel() const { return simdLevel; }
+
+        //colorOrder/colorStarts as built by CollisionManager::ColorContacts(), the last color being the overflow
+        void Prepare(const std::vector<CollisionManifold>& contacts, const std::vector<int>& colorOrder,
+            const std::vector<int>& colorStarts, const ContactSolverSettings& _settings);
+        //stops before maxIterations once an iteration changed no impulse by more than the tolerance, returns the iterations run
+        int Solve(int maxIterations, float tolerance, JobSystem& jobSystem);
+
+        //writes the velocities back to the bodies and the impulses back to the manifold points
+        void Finish(std::vector<CollisionManifold>& contacts);
+
+    private:
+        int GetBodySlot(RigidBody* body);
+        void PrepareLane(ContactBatch& batch, int lane, const CollisionManifold& manifold, int manifoldIdx);
+        void SolveBatch(ContactBatch& batch);
+    };
+}
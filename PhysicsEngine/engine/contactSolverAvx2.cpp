@@ -0,0 +1,41 @@
+#include "contactSolver.h"
+#include <immintrin.h>
+
+//only called after DetectSimdLevel() found AVX2, MSVC emits the intrinsics without /arch:AVX2
+#if defined(__GNUC__) || defined(__clang__)
+#define CONTACT_KERNEL_TARGET __attribute__((target("avx2")))
+#endif
+
+#include "contactSolverKernel.h"
+
+namespace
+{
+    struct Avx2Lanes
+    {
+        static constexpr int WIDTH = 8;
+        typedef __m256 Type;
+
+        CONTACT_KERNEL_TARGET static Type Load(const float* values) { return _mm256_load_ps(values); }
+        CONTACT_KERNEL_TARGET static void Store(float* values, Type value) { _mm256_store_ps(values, value); }
+        CONTACT_KERNEL_TARGET static Type Set(float value) { return _mm256_set1_ps(value); }
+        CONTACT_KERNEL_TARGET static Type Gather(const float* base, const int* slots) {
+            return _mm256_i32gather_ps(base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(slots)), 4);
+        }
+        CONTACT_KERNEL_TARGET static Type Add(Type a, Type b) { return _mm256_add_ps(a, b); }
+        CONTACT_KERNEL_TARGET static Type Sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+        CONTACT_KERNEL_TARGET static Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+        CONTACT_KERNEL_TARGET static Type Max(Type a, Type b) { return _mm256_max_ps(a, b); }
+        CONTACT_KERNEL_TARGET static Type Min(Type a, Type b) { return _mm256_min_ps(a, b); }
+        CONTACT_KERNEL_TARGET static Type Greater(Type a, Type b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        CONTACT_KERNEL_TARGET static Type Select(Type mask, Type a, Type b) { return _mm256_blendv_ps(b, a, mask); }
+        CONTACT_KERNEL_TARGET static float ReduceMax(Type a) {
+            __m128 half = _mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+            half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+            return _mm_cvtss_f32(_mm_max_ss(half, _mm_shuffle_ps(half, half, _MM_SHUFFLE(1, 1, 1, 1))));
+        }
+    };
+}
+
+CONTACT_KERNEL_TARGET float physics::SolveContactBatchAvx2(ContactBatch& batch, SolverBodies& bodies, const ContactSolverSettings& settings){
+    return SolveLanes<Avx2Lanes>(batch, bodies, settings, 0);
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+//Shared body of the contact solver kernels, included by the translation unit of every SimdLevel.
+//A lane type provides the SIMD operations, CONTACT_KERNEL_TARGET is the target attribute the kernel needs
+//(e.g. avx2 for GCC/Clang). The anonymous namespace keeps each unit's instantiation to itself,
+//so the linker can't pick the AVX2 copy for a CPU without it.
+
+#include "contactSolver.h"
+
+#ifndef CONTACT_KERNEL_TARGET
+#define CONTACT_KERNEL_TARGET
+#endif
+
+namespace
+{
+    using namespace physics;
+
+    template<typename Lanes>
+    struct LaneVector
+    {
+        typename Lanes::Type x, y, z;
+    };
+
+    template<typename Lanes>
+    CONTACT_KERNEL_TARGET inline LaneVector<Lanes> LoadLaneVector(const float (&components)[3][CONTACT_LANE_COUNT], int laneOffset) {
+        return { Lanes::Load(components[0] + laneOffset), Lanes::Load(components[1] + laneOffset), Lanes::Load(components[2] + laneOffset) };
+    }
+
+    template<typename Lanes>
+    CONTACT_KERNEL_TARGET inline typename Lanes::Type Dot(const LaneVector<Lanes>& a, const LaneVector<Lanes>& b) {
+        return Lanes::Add(Lanes::Add(Lanes::Mul(a.x, b.x), Lanes::Mul(a.y, b.y)), Lanes::Mul(a.z, b.z));
+    }
+
+    //vector += direction * scale
+    template<typename Lanes>
+    CONTACT_KERNEL_TARGET inline void AddScaled(LaneVector<Lanes>& vector, const LaneVector<Lanes>& direction, typename Lanes::Type scale) {
+        vector.x = Lanes::Add(vector.x, Lanes::Mul(direction.x, scale));
+        vector.y = Lanes::Add(vector.y, Lanes::Mul(direction.y, scale));
+        vector.z = Lanes::Add(vector.z, Lanes::Mul(direction.z, scale));
+    }
+
+    template<typename Lanes>
+    CONTACT_KERNEL_TARGET inline LaneVector<Lanes> GatherLaneVector(const std::vector<float> (&components)[3], const int* slots) {
+        return { Lanes::Gather(components[0].data(), slots), Lanes::Gather(components[1].data(), slots), Lanes::Gather(components[2].data(), slots) };
+    }
+
+    //the static slot and fixed bodies are only read, several lanes (and threads) can share them
+    template<typename Lanes>
+    CONTACT_KERNEL_TARGET inline void ScatterLaneVector(std::vector<float> (&components)[3], const int* slots, const float* inverseMasses, const LaneVector<Lanes>& vector) {
+        alignas(32) float values[3][Lanes::WIDTH];
+        Lanes::Store(values[0], vector.x);
+        Lanes::Store(values[1], vector.y);
+        Lanes::Store(values[2], vector.z);
+        for (int lane = 0; lane < Lanes::WIDTH; ++lane) {
+            if (inverseMasses[lane] == 0.0f) {
+                continue;
+            }
+            components[0][slots[lane]] = values[0][lane];
+            components[1][slots[lane]] = values[1][lane];
+            components[2][slots[lane]] = values[2][lane];
+        }
+    }
+
+    //solves lanes [laneOffset, laneOffset + Lanes::WIDTH) of the batch, see CollisionManager::SequentialImpulse().
+    //returns the largest impulse change of the lanes
+    template<typename Lanes>
+    CONTACT_KERNEL_TARGET float SolveLanes(ContactBatch& batch, SolverBodies& bodies, const ContactSolverSettings& settings, int laneOffset) {
+        typedef typename Lanes::Type Type;
+        typedef LaneVector<Lanes> Vector;
+
+        const int* slotsA = batch.bodyA + laneOffset;
+        const int* slotsB = batch.bodyB + laneOffset;
+        Vector velocityA = GatherLaneVector<Lanes>(bodies.linearVelocities, slotsA);
+        Vector angularVelocityA = GatherLaneVector<Lanes>(bodies.angularVelocities, slotsA);
+        Vector velocityB = GatherLaneVector<Lanes>(bodies.linearVelocities, slotsB);
+        Vector angularVelocityB = GatherLaneVector<Lanes>(bodies.angularVelocities, slotsB);
+
+        const Type inverseMassA = Lanes::Load(batch.inverseMassA + laneOffset);
+        const Type inverseMassB = Lanes::Load(batch.inverseMassB + laneOffset);
+        const Type friction = Lanes::Load(batch.friction + laneOffset);
+        const Type restitution = Lanes::Load(batch.restitution + laneOffset);
+        const Type zero = Lanes::Set(0.0f);
+        const Type one = Lanes::Set(1.0f);
+        const Type closingSpeedTolerance = Lanes::Set(settings.closingSpeedTolerance);
+
+        Type maxImpulseChange = zero;
+
+        Vector directions[3];
+        for (int dir = 0; dir < 3; ++dir) {
+            directions[dir] = LoadLaneVector<Lanes>(batch.directions[dir], laneOffset);
+        }
+
+        //the velocities stay in registers over the points, the points of a manifold share the bodies
+        for (int pointIdx = 0; pointIdx < batch.pointCount; ++pointIdx) {
+            ContactRow& row = batch.rows[pointIdx];
+            Type maxFriction = zero;
+
+            for (int dir = 0; dir < 3; ++dir) {
+                Vector angularA = LoadLaneVector<Lanes>(row.angularA[dir], laneOffset);
+                Vector angularB = LoadLaneVector<Lanes>(row.angularB[dir], laneOffset);
+
+                Type relativeSpeed = Lanes::Sub(
+                    Lanes::Add(Dot<Lanes>(directions[dir], velocityA), Dot<Lanes>(angularA, angularVelocityA)),
+                    Lanes::Add(Dot<Lanes>(directions[dir], velocityB), Dot<Lanes>(angularB, angularVelocityB)));
+
+                Type mass = Lanes::Load(row.mass[dir] + laneOffset);
+                Type oldImpulse = Lanes::Load(row.impulse[dir] + laneOffset);
+                Type newImpulse;
+
+                if (dir == 0) {
+                    //restitution only above the closing speed tolerance
+                    Type restitutionTerm = Lanes::Select(Lanes::Greater(relativeSpeed, closingSpeedTolerance),
+                        Lanes::Mul(restitution, Lanes::Sub(relativeSpeed, closingSpeedTolerance)), zero);
+                    Type impulse = Lanes::Mul(Lanes::Sub(Lanes::Load(row.baumgarte + laneOffset),
+                        Lanes::Mul(Lanes::Add(one, restitutionTerm), relativeSpeed)), mass);
+                    newImpulse = Lanes::Max(Lanes::Add(oldImpulse, impulse), zero);
+                    maxFriction = Lanes::Mul(friction, newImpulse);
+                }
+                else {
+                    //Coulomb's law, bounded by the accumulated normal impulse of the point
+                    Type impulse = Lanes::Mul(Lanes::Sub(zero, relativeSpeed), mass);
+                    newImpulse = Lanes::Min(Lanes::Max(Lanes::Add(oldImpulse, impulse), Lanes::Sub(zero, maxFriction)), maxFriction);
+                }
+                Lanes::Store(row.impulse[dir] + laneOffset, newImpulse);
+                Type delta = Lanes::Sub(newImpulse, oldImpulse);
+                maxImpulseChange = Lanes::Max(maxImpulseChange, Lanes::Max(delta, Lanes::Sub(zero, delta)));
+
+                Type deltaB = Lanes::Sub(zero, delta);
+                AddScaled<Lanes>(velocityA, directions[dir], Lanes::Mul(delta, inverseMassA));
+                AddScaled<Lanes>(angularVelocityA, LoadLaneVector<Lanes>(row.inertiaA[dir], laneOffset), delta);
+                AddScaled<Lanes>(velocityB, directions[dir], Lanes::Mul(deltaB, inverseMassB));
+                AddScaled<Lanes>(angularVelocityB, LoadLaneVector<Lanes>(row.inertiaB[dir], laneOffset), deltaB);
+            }
+        }
+
+        ScatterLaneVector<Lanes>(bodies.linearVelocities, slotsA, batch.inverseMassA + laneOffset, velocityA);
+        ScatterLaneVector<Lanes>(bodies.angularVelocities, slotsA, batch.inverseMassA + laneOffset, angularVelocityA);
+        ScatterLaneVector<Lanes>(bodies.linearVelocities, slotsB, batch.inverseMassB + laneOffset, velocityB);
+        ScatterLaneVector<Lanes>(bodies.angularVelocities, slotsB, batch.inverseMassB + laneOffset, angularVelocityB);
+        return Lanes::ReduceMax(maxImpulseChange);
+    }
+}
@@ -0,0 +1,556 @@
+#include "convexHull.h"
+#include <algorithm>//std::max,find,swap
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>//std::memcmp
+#include <fstream>
+#include <numeric>//std::iota
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+using namespace physics;
+
+namespace
+{
+    constexpr char COOKED_MAGIC[4] = { 'H','U','L','L' };
+    constexpr uint32_t COOKED_VERSION = 1;
+
+    //the cooked file is the arrays as they are in memory (little-endian on every target of the engine)
+    static_assert(sizeof(Vector3) == 12 && std::is_trivially_copyable<Vector3>::value, "cooked hulls store Vector3 as 3 floats");
+    static_assert(sizeof(ConvexHull::HalfEdge) == 16, "cooked hulls store a half-edge as 4 ints");
+    static_assert(sizeof(ConvexHull::Face) == 20, "cooked hulls store a face as an int and 4 floats");
+
+    //a triangle of the hull being built, with the points still outside of it
+    struct BuildFace
+    {
+        int vertices[3];
+        Vector3 normal;
+        float distance;
+        std::vector<int> outside;
+        bool isRemoved = false;
+    };
+
+    uint64_t EdgeKey(int from, int to){
+        return (static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32) | static_cast<uint32_t>(to);
+    }
+
+    //counter-clockwise seen from the outside. A sliver (collinear points) gets no normal : nothing is ever above it
+    BuildFace MakeFace(const std::vector<Vector3>& points, int a, int b, int c){
+        BuildFace face;
+        face.vertices[0] = a;
+        face.vertices[1] = b;
+        face.vertices[2] = c;
+        //the cross product of the two shortest edges rounds the least
+        const Vector3 ab = points[b] - points[a], bc = points[c] - points[b], ca = points[a] - points[c];
+        const float abLength = ab.LengthSquared(), bcLength = bc.LengthSquared(), caLength = ca.LengthSquared();
+        if (abLength >= bcLength && abLength >= caLength) {
+            face.normal = bc.Cross(ca);
+        }
+        else if (bcLength >= caLength) {
+            face.normal = ca.Cross(ab);
+        }
+        else {
+            face.normal = ab.Cross(bc);
+        }
+        const float length = face.normal.Length();
+        face.normal = length > FLT_MIN ? face.normal * (1.0f / length) : Vector3{};
+        face.distance = face.normal.Dot(points[a]);
+        return face;
+    }
+
+    int FindGroup(std::vector<int>& parents, int i){
+        while (parents[i] != i) {
+            parents[i] = parents[parents[i]];
+            i = parents[i];
+        }
+        return i;
+    }
+}
+
+//quickhull (Barber, Dobkin, Huhdanpaa) : from a tetrahedron, the farthest point outside of a face is added and
+//the faces it sees are replaced by a cone from their horizon, until no point is left outside.
+//Then the coplanar triangles are merged and the half-edge mesh is laid out
+ConvexHull ConvexHull::Build(const std::vector<Vector3>& points){
+    const int pointCount = static_cast<int>(points.size());
+    if (pointCount < 4) {
+        throw std::runtime_error("ConvexHull::Build, at least 4 points are needed");
+    }
+
+    //1. the rounding tolerance, relative to the size of the coordinates (as qhull)
+    Vector3 maxAbs;
+    for (const Vector3& point : points) {
+        maxAbs.x = std::max(maxAbs.x, std::abs(point.x));
+        maxAbs.y = std::max(maxAbs.y, std::abs(point.y));
+        maxAbs.z = std::max(maxAbs.z, std::abs(point.z));
+    }
+    const float tolerance = 3.0f * FLT_EPSILON * (maxAbs.x + maxAbs.y + maxAbs.z);
+
+    //2. the initial tetrahedron : the farthest pair of the extreme points, the point farthest from their line,
+    //then the one farthest from their plane
+    int extremes[6]{};
+    for (int i = 1; i < pointCount; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            if (points[i][axis] > points[extremes[axis * 2]][axis]) {
+                extremes[axis * 2] = i;
+            }
+            if (points[i][axis] < points[extremes[axis * 2 + 1]][axis]) {
+                extremes[axis * 2 + 1] = i;
+            }
+        }
+    }
+    int i0 = 0, i1 = 0;
+    float maxDistanceSquared = 0.0f;
+    for (int a = 0; a < 6; ++a) {
+        for (int b = a + 1; b < 6; ++b) {
+            const float distanceSquared = (points[extremes[a]] - points[extremes[b]]).LengthSquared();
+            if (distanceSquared > maxDistanceSquared) {
+                maxDistanceSquared = distanceSquared;
+                i0 = extremes[a];
+                i1 = extremes[b];
+            }
+        }
+    }
+    const Vector3 lineDirection = points[i1] - points[i0];
+    int i2 = i0;
+    float maxLineDistanceSquared = 0.0f;
+    for (int i = 0; i < pointCount; ++i) {
+        const float distanceSquared = (points[i] - points[i0]).Cross(lineDirection).LengthSquared() / std::max(maxDistanceSquared, FLT_MIN);
+        if (distanceSquared > maxLineDistanceSquared) {
+            maxLineDistanceSquared = distanceSquared;
+            i2 = i;
+        }
+    }
+    Vector3 planeNormal = (points[i1] - points[i0]).Cross(points[i2] - points[i0]);
+    planeNormal.Normalize();
+    int i3 = i0;
+    float maxPlaneDistance = 0.0f;
+    for (int i = 0; i < pointCount; ++i) {
+        const float distance = std::abs(planeNormal.Dot(points[i] - points[i0]));
+        if (distance > maxPlaneDistance) {
+            maxPlaneDistance = distance;
+            i3 = i;
+        }
+    }
+    if (maxDistanceSquared <= tolerance * tolerance || maxLineDistanceSquared <= tolerance * tolerance || maxPlaneDistance <= tolerance) {
+        throw std::runtime_error("ConvexHull::Build, the points are coplanar");
+    }
+    if (planeNormal.Dot(points[i3] - points[i0]) > 0.0f) {
+        std::swap(i1, i2);//the fourth point behind the first face
+    }
+
+    std::vector<BuildFace> buildFaces;
+    std::unordered_map<uint64_t, int> edgeFaces;//directed edge -> its face
+    auto addFace = [&](int a, int b, int c) {
+        const int index = static_cast<int>(buildFaces.size());
+        buildFaces.push_back(MakeFace(points, a, b, c));
+        edgeFaces[EdgeKey(a, b)] = index;
+        edgeFaces[EdgeKey(b, c)] = index;
+        edgeFaces[EdgeKey(c, a)] = index;
+    };
+    addFace(i0, i1, i2);
+    addFace(i0, i3, i1);
+    addFace(i1, i3, i2);
+    addFace(i2, i3, i0);
+
+    auto height = [&](int face, int point) {
+        return buildFaces[face].normal.Dot(points[point]) - buildFaces[face].distance;
+    };
+    for (int i = 0; i < pointCount; ++i) {
+        if (i == i0 || i == i1 || i == i2 || i == i3) {
+            continue;
+        }
+        for (int face = 0; face < 4; ++face) {
+            if (height(face, i) > tolerance) {
+                buildFaces[face].outside.push_back(i);
+                break;
+            }
+        }
+    }
+
+    //3. the new faces go at the back and only they get points : one pass over the growing list is enough
+    std::vector<int> visitStamps;
+    std::vector<int> visible;
+    std::vector<int> horizon;//pairs of vertices
+    std::vector<int> orphans;
+    for (int current = 0; current < static_cast<int>(buildFaces.size()); ++current) {
+        if (buildFaces[current].isRemoved || buildFaces[current].outside.empty()) {
+            continue;
+        }
+        int eye = buildFaces[current].outside.front();
+        for (int point : buildFaces[current].outside) {
+            if (height(current, point) > height(current, eye)) {
+                eye = point;
+            }
+        }
+
+        //the faces the eye sees, flooded from the current one, and the edges where they stop
+        visitStamps.resize(buildFaces.size(), -1);
+        visible.clear();
+        horizon.clear();
+        visible.push_back(current);
+        visitStamps[current] = current;
+        for (size_t i = 0; i < visible.size(); ++i) {
+            const BuildFace& face = buildFaces[visible[i]];
+            for (int k = 0; k < 3; ++k) {
+                const int a = face.vertices[k], b = face.vertices[(k + 1) % 3];
+                const int neighbor = edgeFaces.at(EdgeKey(b, a));
+                if (visitStamps[neighbor] == current) {
+                    continue;
+                }
+                if (height(neighbor, eye) > tolerance) {
+                    visitStamps[neighbor] = current;
+                    visible.push_back(neighbor);
+                }
+                else {
+                    horizon.push_back(a);
+                    horizon.push_back(b);
+                }
+            }
+        }
+
+        orphans.clear();
+        for (int index : visible) {
+            BuildFace& face = buildFaces[index];
+            face.isRemoved = true;
+            for (int k = 0; k < 3; ++k) {
+                edgeFaces.erase(EdgeKey(face.vertices[k], face.vertices[(k + 1) % 3]));
+            }
+            for (int point : face.outside) {
+                if (point != eye) {
+                    orphans.push_back(point);
+                }
+            }
+            std::vector<int>().swap(face.outside);
+        }
+
+        const int firstNewFace = static_cast<int>(buildFaces.size());
+        for (size_t i = 0; i < horizon.size(); i += 2) {
+            addFace(horizon[i], horizon[i + 1], eye);
+        }
+        for (int point : orphans) {
+            for (int face = firstNewFace; face < static_cast<int>(buildFaces.size()); ++face) {
+                if (height(face, point) > tolerance) {
+                    buildFaces[face].outside.push_back(point);
+                    break;
+                }
+            }
+        }
+    }
+
+    //4. the coplanar neighbors (each one's far vertex within the tolerance of the other's plane) become one face
+    std::vector<int> parents(buildFaces.size());
+    std::iota(parents.begin(), parents.end(), 0);
+    auto farVertex = [&](const BuildFace& face, int a, int b) {
+        for (int vertex : face.vertices) {
+            if (vertex != a && vertex != b) {
+                return vertex;
+            }
+        }
+        return a;
+    };
+    for (int index = 0; index < static_cast<int>(buildFaces.size()); ++index) {
+        const BuildFace& face = buildFaces[index];
+        if (face.isRemoved) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            const int a = face.vertices[k], b = face.vertices[(k + 1) % 3];
+            const int neighbor = edgeFaces.at(EdgeKey(b, a));
+            if (face.normal.Dot(buildFaces[neighbor].normal) > 0.0f
+                && std::abs(height(index, farVertex(buildFaces[neighbor], a, b))) <= tolerance
+                && std::abs(height(neighbor, farVertex(face, a, b))) <= tolerance) {
+                parents[FindGroup(parents, index)] = FindGroup(parents, neighbor);
+            }
+        }
+    }
+    //the members of each group, as linked lists in the order of the faces
+    std::vector<int> firstMembers(buildFaces.size(), -1);
+    std::vector<int> nextMembers(buildFaces.size(), -1);
+    for (int index = static_cast<int>(buildFaces.size()) - 1; index >= 0; --index) {
+        if (buildFaces[index].isRemoved == false) {
+            const int group = FindGroup(parents, index);
+            nextMembers[index] = firstMembers[group];
+            firstMembers[group] = index;
+        }
+    }
+
+    //5. the half-edge mesh : the boundary of each group walked counter-clockwise
+    ConvexHull hull;
+    std::vector<int> vertexIndices(pointCount, -1);
+    std::vector<std::pair<int, int>> boundary;
+    for (int index = 0; index < static_cast<int>(buildFaces.size()); ++index) {
+        const int group = FindGroup(parents, index);
+        if (buildFaces[index].isRemoved || firstMembers[group] != index) {
+            continue;
+        }
+        const int faceIndex = static_cast<int>(hull.faces.size());
+
+        boundary.clear();
+        Vector3 normal;
+        for (int member = index; member >= 0; member = nextMembers[member]) {
+            const BuildFace& face = buildFaces[member];
+            const Vector3& a = points[face.vertices[0]];
+            normal += (points[face.vertices[1]] - a).Cross(points[face.vertices[2]] - a);
+            for (int k = 0; k < 3; ++k) {
+                const int from = face.vertices[k], to = face.vertices[(k + 1) % 3];
+                if (FindGroup(parents, edgeFaces.at(EdgeKey(to, from))) != group) {
+                    boundary.emplace_back(from, to);
+                }
+            }
+        }
+        normal.Normalize();
+
+        Face newFace;
+        newFace.edge = static_cast<int>(hull.edges.size());
+        newFace.normal = normal;
+        newFace.distance = -FLT_MAX;
+        int from = boundary.front().first;
+        for (size_t i = 0; i < boundary.size(); ++i) {
+            auto itr = std::find_if(boundary.begin(), boundary.end(), [from](const std::pair<int, int>& edge) { return edge.first == from; });
+            if (itr == boundary.end()) {
+                throw std::runtime_error("ConvexHull::Build, a merged face isn't a polygon");
+            }
+            if (vertexIndices[from] < 0) {
+                vertexIndices[from] = static_cast<int>(hull.vertices.size());
+                hull.vertices.push_back(points[from]);
+            }
+            newFace.distance = std::max(newFace.distance, normal.Dot(points[from]));//every vertex below the plane
+            const int edgeIndex = static_cast<int>(hull.edges.size());
+            hull.edges.push_back({ vertexIndices[from], -1, edgeIndex + 1, faceIndex });
+            from = itr->second;
+        }
+        if (from != boundary.front().first) {
+            throw std::runtime_error("ConvexHull::Build, a merged face isn't a polygon");
+        }
+        hull.edges.back().next = newFace.edge;
+        hull.faces.push_back(newFace);
+    }
+
+    std::unordered_map<uint64_t, int> edgeIndices;
+    for (int i = 0; i < static_cast<int>(hull.edges.size()); ++i) {
+        edgeIndices[EdgeKey(hull.edges[i].origin, hull.edges[hull.edges[i].next].origin)] = i;
+    }
+    for (HalfEdge& edge : hull.edges) {
+        edge.twin = edgeIndices.at(EdgeKey(hull.edges[edge.next].origin, edge.origin));
+    }
+    hull.Finish();
+    return hull;
+}
+
+void ConvexHull::Finish(){
+    //every half-edge leaves its origin towards a neighbor
+    neighborOffsets.assign(vertices.size() + 1, 0);
+    for (const HalfEdge& edge : edges) {
+        ++neighborOffsets[edge.origin + 1];
+    }
+    for (size_t i = 1; i < neighborOffsets.size(); ++i) {
+        neighborOffsets[i] += neighborOffsets[i - 1];
+    }
+    neighbors.resize(edges.size());
+    std::vector<int> filled(neighborOffsets.begin(), neighborOffsets.end() - 1);
+    for (const HalfEdge& edge : edges) {
+        neighbors[filled[edge.origin]++] = edges[edge.next].origin;
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        extremeVertices[axis * 2] = extremeVertices[axis * 2 + 1] = 0;
+        for (int i = 1; i < static_cast<int>(vertices.size()); ++i) {
+            if (vertices[i][axis] > vertices[extremeVertices[axis * 2]][axis]) {
+                extremeVertices[axis * 2] = i;
+            }
+            if (vertices[i][axis] < vertices[extremeVertices[axis * 2 + 1]][axis]) {
+                extremeVertices[axis * 2 + 1] = i;
+            }
+        }
+    }
+}
+
+bool ConvexHull::LoadCooked(const std::string& path, ConvexHull& hull){
+    std::ifstream file(path, std::ios::binary);
+    if (file.is_open() == false) {
+        return false;
+    }
+    char magic[sizeof(COOKED_MAGIC)];
+    uint32_t header[4];//version, vertex count, half-edge count, face count
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || std::memcmp(magic, COOKED_MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("ConvexHull::LoadCooked, not a cooked hull: " + path);
+    }
+    if (header[0] != COOKED_VERSION) {
+        throw std::runtime_error("ConvexHull::LoadCooked, unsupported version: " + path);
+    }
+
+    ConvexHull loaded;
+    loaded.vertices.resize(header[1]);
+    loaded.edges.resize(header[2]);
+    loaded.faces.resize(header[3]);
+    file.read(reinterpret_cast<char*>(loaded.vertices.data()), sizeof(Vector3) * loaded.vertices.size());
+    file.read(reinterpret_cast<char*>(loaded.edges.data()), sizeof(HalfEdge) * loaded.edges.size());
+    file.read(reinterpret_cast<char*>(loaded.faces.data()), sizeof(Face) * loaded.faces.size());
+    if (!file) {
+        throw std::runtime_error("ConvexHull::LoadCooked, truncated file: " + path);
+    }
+
+    const int vertexCount = static_cast<int>(header[1]);
+    const int edgeCount = static_cast<int>(header[2]);
+    const int faceCount = static_cast<int>(header[3]);
+    auto isValid = [](int index, int count) { return index >= 0 && index < count; };
+    bool isMeshValid = vertexCount >= 4 && faceCount >= 4;
+    for (const HalfEdge& edge : loaded.edges) {
+        isMeshValid = isMeshValid && isValid(edge.origin, vertexCount) && isValid(edge.twin, edgeCount)
+            && isValid(edge.next, edgeCount) && isValid(edge.face, faceCount);
+    }
+    for (const Face& face : loaded.faces) {
+        isMeshValid = isMeshValid && isValid(face.edge, edgeCount);
+    }
+    if (isMeshValid == false) {
+        throw std::runtime_error("ConvexHull::LoadCooked, invalid indices: " + path);
+    }
+    loaded.Finish();
+    hull = std::move(loaded);
+    return true;
+}
+
+bool ConvexHull::SaveCooked(const std::string& path) const{
+    std::ofstream file(path, std::ios::binary);
+    if (file.is_open() == false) {
+        return false;
+    }
+    const uint32_t header[4] = { COOKED_VERSION, static_cast<uint32_t>(vertices.size()), static_cast<uint32_t>(edges.size()), static_cast<uint32_t>(faces.size()) };
+    file.write(COOKED_MAGIC, sizeof(COOKED_MAGIC));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(vertices.data()), sizeof(Vector3) * vertices.size());
+    file.write(reinterpret_cast<const char*>(edges.data()), sizeof(HalfEdge) * edges.size());
+    file.write(reinterpret_cast<const char*>(faces.data()), sizeof(Face) * faces.size());
+    return file.good();
+}
+
+//steepest ascent over the neighbors : a local maximum of a linear function on a convex polyhedron is the maximum.
+//The dot products are written out, Vector3::Dot() isn't inlined
+int ConvexHull::GetSupportVertex(const Vector3& direction) const{
+    const float dx = direction.x, dy = direction.y, dz = direction.z;
+    const Vector3* vertexData = vertices.data();
+    const int vertexCount = static_cast<int>(vertices.size());
+    if (vertexCount < HILL_CLIMBING_MIN_VERTICES) {
+        int best = 0;
+        float bestDot = vertexData[0].x * dx + vertexData[0].y * dy + vertexData[0].z * dz;
+        for (int i = 1; i < vertexCount; ++i) {
+            const float dot = vertexData[i].x * dx + vertexData[i].y * dy + vertexData[i].z * dz;
+            if (dot > bestDot) {
+                bestDot = dot;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    const float ax = std::abs(dx), ay = std::abs(dy), az = std::abs(dz);
+    int best;
+    if (ax >= ay && ax >= az) {
+        best = extremeVertices[dx < 0.0f ? 1 : 0];
+    }
+    else if (ay >= az) {
+        best = extremeVertices[dy < 0.0f ? 3 : 2];
+    }
+    else {
+        best = extremeVertices[dz < 0.0f ? 5 : 4];
+    }
+    const int* neighborData = neighbors.data();
+    float bestDot = vertexData[best].x * dx + vertexData[best].y * dy + vertexData[best].z * dz;
+    while (true) {
+        const int current = best;
+        for (int i = neighborOffsets[current]; i < neighborOffsets[current + 1]; ++i) {
+            const Vector3& neighbor = vertexData[neighborData[i]];
+            const float dot = neighbor.x * dx + neighbor.y * dy + neighbor.z * dz;
+            if (dot > bestDot) {
+                bestDot = dot;
+                best = neighborData[i];
+            }
+        }
+        if (best == current) {
+            return best;
+        }
+    }
+}
+
+int ConvexHull::GetVerticesBelow(const Vector3& normal, float distance, int start, int* result, int maxCount) const{
+    const float nx = normal.x, ny = normal.y, nz = normal.z;
+    auto isBelow = [&](const Vector3& vertex) { return vertex.x * nx + vertex.y * ny + vertex.z * nz < distance; };
+    if (maxCount <= 0 || isBelow(vertices[start]) == false) {
+        return 0;
+    }
+    int count = 0;
+    result[count++] = start;
+    for (int i = 0; i < count; ++i) {//the result is the queue
+        const int vertex = result[i];
+        for (int j = neighborOffsets[vertex]; j < neighborOffsets[vertex + 1]; ++j) {
+            const int neighbor = neighbors[j];
+            if (isBelow(vertices[neighbor]) && std::find(result, result + count, neighbor) == result + count) {
+                if (count == maxCount) {
+                    return count;
+                }
+                result[count++] = neighbor;
+            }
+        }
+    }
+    return count;
+}
+
+//the tetrahedra from an inner point to the triangles of the faces (Eberly, Polyhedral Mass Properties) :
+//the covariance of the tetrahedron (0,a,b,c) is det/120 (aa' + bb' + cc' + (a+b+c)(a+b+c)')
+ConvexHull::MassProperties ConvexHull::ComputeMassProperties() const{
+    Vector3 reference;
+    for (const Vector3& vertex : vertices) {
+        reference += vertex;
+    }
+    reference *= 1.0f / static_cast<float>(vertices.size());
+
+    float volume = 0.0f;
+    Vector3 weightedCenter;
+    float covariance[3][3]{};
+    for (const Face& face : faces) {
+        const Vector3 a = vertices[edges[face.edge].origin] - reference;
+        for (int edge = edges[face.edge].next; edges[edge].next != face.edge; edge = edges[edge].next) {
+            const Vector3 b = vertices[edges[edge].origin] - reference;
+            const Vector3 c = vertices[edges[edges[edge].next].origin] - reference;
+            const float determinant = a.Dot(b.Cross(c));
+            const Vector3 sum = a + b + c;
+            volume += determinant / 6.0f;
+            weightedCenter += sum * (determinant / 24.0f);
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    covariance[i][j] += determinant / 120.0f * (a[i] * a[j] + b[i] * b[j] + c[i] * c[j] + sum[i] * sum[j]);
+                }
+            }
+        }
+    }
+
+    MassProperties properties;
+    properties.volume = volume;
+    const Vector3 center = weightedCenter * (1.0f / volume);
+    properties.centerOfMass = reference + center;
+    //moved to the center of mass, then I = trace(C) - C
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            covariance[i][j] -= volume * center[i] * center[j];
+        }
+    }
+    const float trace = covariance[0][0] + covariance[1][1] + covariance[2][2];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            properties.inertiaTensor[i * 3 + j] = (i == j ? trace : 0.0f) - covariance[i][j];
+        }
+    }
+    return properties;
+}
+
+void ConvexHull::Translate(const Vector3& offset){
+    for (Vector3& vertex : vertices) {
+        vertex += offset;
+    }
+    for (Face& face : faces) {
+        face.distance += face.normal.Dot(offset);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "math/vector3.h"
+#include "math/matrix3.h"
+#include <string>
+#include <vector>
+
+namespace physics
+{
+    using math::Matrix3;
+    using math::Vector3;
+
+    //A convex polyhedron as a half-edge mesh, in contiguous arrays : the faces are polygons (coplanar triangles
+    //of the quickhull merged), counter-clockwise seen from the outside. Built once (or loaded cooked) and
+    //shared by all the colliders of the same shape
+    class ConvexHull
+    {
+    public:
+        struct HalfEdge
+        {
+            int origin;//vertex
+            int twin;//the same edge the other way, in the neighboring face
+            int next;//counter-clockwise in the face
+            int face;
+        };
+
+        struct Face
+        {
+            int edge;//one of its half-edges
+            Vector3 normal;//outward
+            float distance;//normal.Dot(x) == distance on the face
+        };
+
+        struct MassProperties
+        {
+            float volume;
+            Vector3 centerOfMass;
+            Matrix3 inertiaTensor;//about the center of mass, for a density of 1
+        };
+
+        static constexpr int HILL_CLIMBING_MIN_VERTICES = 32;//below, a loop over the vertices is faster
+
+    private:
+        std::vector<Vector3> vertices;
+        std::vector<HalfEdge> edges;
+        std::vector<Face> faces;
+        //the neighbors of vertex i are neighbors[neighborOffsets[i]] to neighbors[neighborOffsets[i + 1]] (excluded) :
+        //the hill climbing reads them in a row instead of following the half-edges
+        std::vector<int> neighborOffsets;
+        std::vector<int> neighbors;
+        int extremeVertices[6]{};//along +x,-x,+y,-y,+z,-z : where the hill climbing starts
+
+        void Finish();//the adjacency and extremeVertices from the mesh
+
+    public:
+        //quickhull, throws if the points are (nearly) coplanar
+        static ConvexHull Build(const std::vector<Vector3>& points);
+
+        //cooked binary : the arrays as they are in memory, nothing to rebuild at startup.
+        //false if the file can't be opened, throws if it isn't a cooked hull
+        static bool LoadCooked(const std::string& path, ConvexHull& hull);
+        bool SaveCooked(const std::string& path) const;//false if the file can't be written
+
+        //the vertex furthest along 'direction' (not normalized) : climbs the vertex graph from the extreme vertex
+        //of the dominant axis, O(sqrt(n)) steps on a round hull
+        int GetSupportVertex(const Vector3& direction) const;
+        //the vertices with normal.Dot(v) < distance, found from 'start' (one of them) through the edges :
+        //they are connected on a convex polyhedron. Up to maxCount, the count is returned
+        int GetVerticesBelow(const Vector3& normal, float distance, int start, int* result, int maxCount) const;
+
+        MassProperties ComputeMassProperties() const;
+        void Translate(const Vector3& offset);//e.g. to move the center of mass to the origin
+
+        const std::vector<Vector3>& GetVertices() const { return vertices; }
+        const std::vector<HalfEdge>& GetEdges() const { return edges; }
+        const std::vector<Face>& GetFaces() const { return faces; }
+    };
+}
@@ -0,0 +1,348 @@
+#include "dynamicAABBTree.h"
+#include <algorithm>//std::max, std::find
+
+using namespace physics;
+
+//https://box2d.org/files/ErinCatto_DynamicBVH_GDC2019.pdf
+
+void DynamicAABBTree::AddObject(RigidObject* obj){
+    if (leafIndices.find(obj) != leafIndices.end()) {
+        return;
+    }
+
+    int leaf = AllocateNode();
+    Node& node = nodes[leaf];
+    node.object = obj;
+    node.order = nextOrder++;
+    node.height = 0;
+    node.bounds = obj->GetCollider()->ComputeAABB();
+    node.fatBounds = Fatten(node.bounds, obj);
+
+    InsertLeaf(leaf);
+    leaves.push_back(leaf);
+    leafIndices[obj] = leaf;
+}
+
+void DynamicAABBTree::RemoveObject(RigidObject* obj){
+    auto itr = leafIndices.find(obj);
+    if (itr == leafIndices.end()) {
+        return;
+    }
+    int leaf = itr->second;
+    leafIndices.erase(itr);
+    leaves.erase(std::find(leaves.begin(), leaves.end(), leaf));//keeps the registration order
+
+    RemoveLeaf(leaf);
+    FreeNode(leaf);
+}
+
+void DynamicAABBTree::ComputePairs(std::vector<ObjectPair>& pairs){
+    pairs.clear();
+
+    //1. refit, only the leaves that escaped their fat bounds are reinserted
+    for (int leaf : leaves) {
+        RigidObject* obj = nodes[leaf].object;
+        nodes[leaf].bounds = obj->GetCollider()->ComputeAABB();
+        if (nodes[leaf].fatBounds.Contains(nodes[leaf].bounds) == false) {
+            RemoveLeaf(leaf);
+            nodes[leaf].fatBounds = Fatten(nodes[leaf].bounds, obj);
+            InsertLeaf(leaf);
+        }
+    }
+
+    //2. query the tree with every leaf, each pair is reported by its earlier registered object
+    for (int i = 0; i < static_cast<int>(nodes.size()); ++i) {
+        if (nodes[i].height != 0) {//internal or free
+            continue;
+        }
+        const Node& leaf = nodes[i];
+
+        queryStack.clear();
+        queryStack.push_back(root);
+        while (queryStack.empty() == false) {
+            int nodeIdx = queryStack.back();
+            queryStack.pop_back();
+
+            const Node& node = nodes[nodeIdx];
+            if (node.fatBounds.Overlaps(leaf.bounds) == false) {
+                continue;
+            }
+
+            if (node.IsLeaf()) {
+                if (node.order > leaf.order && node.bounds.Overlaps(leaf.bounds)) {
+                    pairs.emplace_back(leaf.object, node.object);
+                }
+            }
+            else {
+                queryStack.push_back(node.child1);
+                queryStack.push_back(node.child2);
+            }
+        }
+    }
+}
+
+int DynamicAABBTree::AllocateNode(){
+    int nodeIdx;
+    if (freeList != NULL_NODE) {
+        nodeIdx = freeList;
+        freeList = nodes[nodeIdx].parent;
+    }
+    else {
+        nodeIdx = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    Node& node = nodes[nodeIdx];
+    node.object = nullptr;
+    node.order = 0;
+    node.parent = NULL_NODE;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = 0;
+    return nodeIdx;
+}
+
+void DynamicAABBTree::FreeNode(int nodeIdx){
+    nodes[nodeIdx].object = nullptr;
+    nodes[nodeIdx].height = -1;
+    nodes[nodeIdx].parent = freeList;
+    freeList = nodeIdx;
+}
+
+AABB DynamicAABBTree::Fatten(const AABB& bounds, const RigidObject* obj) const{
+    Vector3 margin{ AABB_MARGIN, AABB_MARGIN, AABB_MARGIN };
+    AABB fat{ bounds.min - margin, bounds.max + margin };
+
+    //stretch towards where the body is heading
+    Vector3 displacement = obj->GetLinearVelocity() * AABB_PREDICTION_TIME;
+    for (int i = 0; i < 3; ++i) {
+        if (displacement[i] < 0.0f) {
+            fat.min[i] += displacement[i];
+        }
+        else {
+            fat.max[i] += displacement[i];
+        }
+    }
+    return fat;
+}
+
+void DynamicAABBTree::InsertLeaf(int leaf){
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    //1. find the best sibling (surface area heuristic)
+    const AABB leafBounds = nodes[leaf].fatBounds;
+    int index = root;
+    while (nodes[index].IsLeaf() == false) {
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float area = nodes[index].fatBounds.HalfSurfaceArea();
+        float combinedArea = nodes[index].fatBounds.Union(leafBounds).HalfSurfaceArea();
+
+        //cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedArea;
+        //minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int child) {
+            float newArea = nodes[child].fatBounds.Union(leafBounds).HalfSurfaceArea();
+            if (nodes[child].IsLeaf()) {
+                return newArea + inheritanceCost;
+            }
+            return (newArea - nodes[child].fatBounds.HalfSurfaceArea()) + inheritanceCost;
+        };
+        float cost1 = descendCost(child1);
+        float cost2 = descendCost(child2);
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = (cost1 < cost2) ? child1 : child2;
+    }
+    int sibling = index;
+
+    //2. create a new parent
+    int oldParent = nodes[sibling].parent;
+    int newParent = AllocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].fatBounds = leafBounds.Union(nodes[sibling].fatBounds);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_NODE) {
+        if (nodes[oldParent].child1 == sibling) {
+            nodes[oldParent].child1 = newParent;
+        }
+        else {
+            nodes[oldParent].child2 = newParent;
+        }
+    }
+    else {
+        root = newParent;
+    }
+
+    //3. walk back up, refitting and rebalancing
+    RefitAncestors(nodes[leaf].parent);
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf){
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+    //the sibling takes the place of the parent
+    if (grandParent != NULL_NODE) {
+        if (nodes[grandParent].child1 == parent) {
+            nodes[grandParent].child1 = sibling;
+        }
+        else {
+            nodes[grandParent].child2 = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        FreeNode(parent);
+
+        RefitAncestors(grandParent);
+    }
+    else {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        FreeNode(parent);
+    }
+    nodes[leaf].parent = NULL_NODE;
+}
+
+void DynamicAABBTree::RefitAncestors(int nodeIdx){
+    while (nodeIdx != NULL_NODE) {
+        nodeIdx = Balance(nodeIdx);
+
+        Node& node = nodes[nodeIdx];
+        node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+        node.fatBounds = nodes[node.child1].fatBounds.Union(nodes[node.child2].fatBounds);
+
+        nodeIdx = node.parent;
+    }
+}
+
+//Performs a left or right rotation if node A is imbalanced, returns the new root of the subtree.
+//  A has the children B and C, C has the children F and G (B has D and E)
+int DynamicAABBTree::Balance(int iA){
+    Node& A = nodes[iA];
+    if (A.IsLeaf() || A.height < 2) {
+        return iA;
+    }
+
+    int iB = A.child1;
+    int iC = A.child2;
+    Node& B = nodes[iB];
+    Node& C = nodes[iC];
+
+    int balance = C.height - B.height;
+
+    //rotate C up
+    if (balance > 1) {
+        int iF = C.child1;
+        int iG = C.child2;
+        Node& F = nodes[iF];
+        Node& G = nodes[iG];
+
+        //swap A and C
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        //A's old parent should point to C
+        if (C.parent != NULL_NODE) {
+            if (nodes[C.parent].child1 == iA) {
+                nodes[C.parent].child1 = iC;
+            }
+            else {
+                nodes[C.parent].child2 = iC;
+            }
+        }
+        else {
+            root = iC;
+        }
+
+        //the taller grandchild stays under C
+        if (F.height > G.height) {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.fatBounds = B.fatBounds.Union(G.fatBounds);
+            C.fatBounds = A.fatBounds.Union(F.fatBounds);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        }
+        else {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.fatBounds = B.fatBounds.Union(F.fatBounds);
+            C.fatBounds = A.fatBounds.Union(G.fatBounds);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return iC;
+    }
+
+    //rotate B up
+    if (balance < -1) {
+        int iD = B.child1;
+        int iE = B.child2;
+        Node& D = nodes[iD];
+        Node& E = nodes[iE];
+
+        //swap A and B
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        //A's old parent should point to B
+        if (B.parent != NULL_NODE) {
+            if (nodes[B.parent].child1 == iA) {
+                nodes[B.parent].child1 = iB;
+            }
+            else {
+                nodes[B.parent].child2 = iB;
+            }
+        }
+        else {
+            root = iB;
+        }
+
+        //the taller grandchild stays under B
+        if (D.height > E.height) {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.fatBounds = C.fatBounds.Union(E.fatBounds);
+            B.fatBounds = A.fatBounds.Union(D.fatBounds);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        }
+        else {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.fatBounds = C.fatBounds.Union(D.fatBounds);
+            B.fatBounds = A.fatBounds.Union(E.fatBounds);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "broadPhase.h"
+#include "aabb.h"
+#include <unordered_map>
+#include <vector>
+
+namespace physics
+{
+    //Dynamic bounding volume hierarchy with one leaf per collider (Box2D b2DynamicTree style).
+    //Leaves store a fattened AABB, so a slowly moving body is only reinserted once it leaves it.
+    //Insertion picks the sibling with the surface area heuristic and the tree is kept balanced
+    //with AVL-like rotations, so add/remove/reinsert are O(logn).
+    class DynamicAABBTree : public BroadPhase
+    {
+    public:
+        static constexpr int NULL_NODE = -1;
+        static constexpr float AABB_MARGIN = 0.1f;//fixed fattening
+        static constexpr float AABB_PREDICTION_TIME = 2.0f / 60.0f;//velocity fattening, two steps ahead
+
+    private:
+        struct Node
+        {
+            AABB fatBounds;//leaves : fattened, internal nodes : union of the children
+            AABB bounds;//leaves only, the tight bounds of the current step
+            RigidObject* object;//nullptr for internal nodes
+            unsigned order;//registration order
+            int parent;//next free node while in the free list
+            int child1;
+            int child2;
+            int height;//leaf : 0, free : -1
+
+            bool IsLeaf() const { return child1 == NULL_NODE; }
+        };
+
+        std::vector<Node> nodes;
+        int root;
+        int freeList;
+        unsigned nextOrder;
+
+        std::vector<int> leaves;//in registration order, so that refitting reinserts deterministically
+        std::unordered_map<RigidObject*, int> leafIndices;//object -> leaf node
+        std::vector<int> queryStack;
+
+    public:
+        DynamicAABBTree() : root{ NULL_NODE }, freeList{ NULL_NODE }, nextOrder{} {}
+
+        BroadPhaseType GetType() const override { return BroadPhaseType::DYNAMIC_AABB_TREE; }
+
+        void AddObject(RigidObject* obj) override;
+        void RemoveObject(RigidObject* obj) override;
+        void ComputePairs(std::vector<ObjectPair>& pairs) override;
+
+        int GetHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+    private:
+        int AllocateNode();
+        void FreeNode(int nodeIdx);
+
+        AABB Fatten(const AABB& bounds, const RigidObject* obj) const;
+
+        void InsertLeaf(int leaf);
+        void RemoveLeaf(int leaf);
+        int Balance(int nodeIdx);
+        void RefitAncestors(int nodeIdx);
+    };
+}
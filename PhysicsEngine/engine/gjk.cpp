@@ -0,0 +1,493 @@
+#include "gjk.h"
+#include <cfloat>//FLT_MAX
+#include <cmath>//std::abs
+#include <utility>//std::swap
+
+using namespace physics;
+
+//https://caseymuratori.com/blog_0003
+//https://winter.dev/articles/gjk-algorithm, https://winter.dev/articles/epa-algorithm
+namespace
+{
+    constexpr int MAX_GJK_ITERATIONS = 64;
+    constexpr int MAX_EPA_ITERATIONS = 64;
+    constexpr int MAX_EPA_VERTICES = 64;
+    constexpr int MAX_EPA_FACES = 128;
+    constexpr float EPA_TOLERANCE = 1e-4f;//support distance gained by a new vertex, below : converged
+    constexpr float GJK_RELATIVE_TOLERANCE = 1e-6f;//of the squared distance gained by a new vertex, below : converged
+    constexpr float GJK_OVERLAP_DISTANCE_SQUARED = 1e-10f;
+
+    SupportPoint GetCoreSupportPoint(const Collider& shape1, const Collider& shape2, const Vector3& direction) {
+        SupportPoint support;
+        support.point1 = shape1.GetSupport(direction);
+        support.point2 = shape2.GetSupport(direction * -1.0f);
+        support.point = support.point1 - support.point2;
+        return support;
+    }
+
+    //the simplex of GjkDistance(), weights are the barycentric coordinates of its point closest to the origin
+    struct WeightedSimplex
+    {
+        SupportPoint points[4];
+        float weights[4];
+        int count;
+    };
+
+    void SetVertex(WeightedSimplex& result, const SupportPoint& a) {
+        result.points[0] = a;
+        result.weights[0] = 1.0f;
+        result.count = 1;
+    }
+
+    void SetEdge(WeightedSimplex& result, const SupportPoint& a, const SupportPoint& b, float t) {
+        result.points[0] = a;
+        result.points[1] = b;
+        result.weights[0] = 1.0f - t;
+        result.weights[1] = t;
+        result.count = 2;
+    }
+
+    void ReduceSegment(const SupportPoint& a, const SupportPoint& b, WeightedSimplex& result) {
+        const Vector3 ab = b.point - a.point;
+        const float t = -a.point.Dot(ab);
+        if (t <= 0.0f) {
+            SetVertex(result, a);
+        }
+        else if (t >= ab.LengthSquared()) {
+            SetVertex(result, b);
+        }
+        else {
+            SetEdge(result, a, b, t / ab.LengthSquared());
+        }
+    }
+
+    //Voronoi regions of the triangle (Ericson, Real-Time Collision Detection 5.1.5) with the origin as the query point
+    void ReduceTriangle(const SupportPoint& a, const SupportPoint& b, const SupportPoint& c, WeightedSimplex& result) {
+        const Vector3 ab = b.point - a.point;
+        const Vector3 ac = c.point - a.point;
+        const float d1 = -ab.Dot(a.point), d2 = -ac.Dot(a.point);
+        if (d1 <= 0.0f && d2 <= 0.0f) {
+            return SetVertex(result, a);
+        }
+        const float d3 = -ab.Dot(b.point), d4 = -ac.Dot(b.point);
+        if (d3 >= 0.0f && d4 <= d3) {
+            return SetVertex(result, b);
+        }
+        const float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+            return SetEdge(result, a, b, d1 / (d1 - d3));
+        }
+        const float d5 = -ab.Dot(c.point), d6 = -ac.Dot(c.point);
+        if (d6 >= 0.0f && d5 <= d6) {
+            return SetVertex(result, c);
+        }
+        const float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+            return SetEdge(result, a, c, d2 / (d2 - d6));
+        }
+        const float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+            return SetEdge(result, b, c, (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+        const float denominator = va + vb + vc;
+        if (denominator <= 0.0f) {//flat triangle : its longest edge stands for it
+            return ReduceSegment(a, ab.LengthSquared() > ac.LengthSquared() ? b : c, result);
+        }
+        result.points[0] = a;
+        result.points[1] = b;
+        result.points[2] = c;
+        result.weights[1] = vb / denominator;
+        result.weights[2] = vc / denominator;
+        result.weights[0] = 1.0f - result.weights[1] - result.weights[2];
+        result.count = 3;
+    }
+
+    bool IsInSimplex(const WeightedSimplex& simplex, const Vector3& point) {
+        for (int i = 0; i < simplex.count; ++i) {
+            if (simplex.points[i].point == point) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Vector3 GetWeightedPoint(const WeightedSimplex& simplex) {
+        Vector3 point;
+        for (int i = 0; i < simplex.count; ++i) {
+            point += simplex.points[i].point * simplex.weights[i];
+        }
+        return point;
+    }
+
+    //the closest face of a tetrahedron is one the origin is in front of, false if it is behind all of them (inside)
+    bool ReduceTetrahedron(const WeightedSimplex& simplex, WeightedSimplex& result) {
+        static constexpr int FACES[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };//3 vertices, the one opposite
+        float closestDistanceSquared = FLT_MAX;
+        for (const int (&face)[4] : FACES) {
+            const SupportPoint& a = simplex.points[face[0]];
+            const Vector3 normal = (simplex.points[face[1]].point - a.point).Cross(simplex.points[face[2]].point - a.point);
+            const float originSide = -normal.Dot(a.point);
+            const float oppositeSide = normal.Dot(simplex.points[face[3]].point - a.point);
+            if (originSide * oppositeSide > 0.0f) {
+                continue;
+            }
+            WeightedSimplex faceResult;
+            ReduceTriangle(a, simplex.points[face[1]], simplex.points[face[2]], faceResult);
+            const float distanceSquared = GetWeightedPoint(faceResult).LengthSquared();
+            if (distanceSquared < closestDistanceSquared) {
+                closestDistanceSquared = distanceSquared;
+                result = faceResult;
+            }
+        }
+        return closestDistanceSquared != FLT_MAX;
+    }
+
+    bool SameDirection(const Vector3& direction, const Vector3& towardsOrigin) {
+        return direction.Dot(towardsOrigin) > 0.0f;
+    }
+
+    //any vector perpendicular to 'vec'
+    Vector3 GetPerpendicular(const Vector3& vec) {
+        return std::abs(vec.x) < 0.57735f ? vec.Cross(Vector3(1.0f, 0.0f, 0.0f)) : vec.Cross(Vector3(0.0f, 1.0f, 0.0f));
+    }
+
+    void SetSimplex(Simplex& simplex, const SupportPoint& a, const SupportPoint& b) {
+        simplex.points[0] = a;
+        simplex.points[1] = b;
+        simplex.count = 2;
+    }
+
+    void SetSimplex(Simplex& simplex, const SupportPoint& a, const SupportPoint& b, const SupportPoint& c) {
+        simplex.points[0] = a;
+        simplex.points[1] = b;
+        simplex.points[2] = c;
+        simplex.count = 3;
+    }
+
+    //points[0] is the newest point : the origin can only be in the regions facing it
+    bool UpdateLine(Simplex& simplex, Vector3& direction) {
+        const SupportPoint a = simplex.points[0];
+        const Vector3 ab = simplex.points[1].point - a.point;
+        const Vector3 ao = a.point * -1.0f;
+        if (SameDirection(ab, ao)) {
+            direction = ab.Cross(ao).Cross(ab);
+            if (direction.LengthSquared() < FLT_EPSILON * FLT_EPSILON) {
+                direction = GetPerpendicular(ab);//the origin is on the segment : any side
+            }
+        }
+        else {
+            simplex.count = 1;
+            direction = ao;
+        }
+        return false;
+    }
+
+    bool UpdateTriangle(Simplex& simplex, Vector3& direction) {
+        const SupportPoint a = simplex.points[0];
+        const SupportPoint b = simplex.points[1];
+        const SupportPoint c = simplex.points[2];
+        const Vector3 ab = b.point - a.point;
+        const Vector3 ac = c.point - a.point;
+        const Vector3 ao = a.point * -1.0f;
+        const Vector3 abc = ab.Cross(ac);
+
+        if (SameDirection(abc.Cross(ac), ao)) {
+            if (SameDirection(ac, ao)) {
+                SetSimplex(simplex, a, c);
+                direction = ac.Cross(ao).Cross(ac);
+                return false;
+            }
+            SetSimplex(simplex, a, b);
+            return UpdateLine(simplex, direction);
+        }
+        if (SameDirection(ab.Cross(abc), ao)) {
+            SetSimplex(simplex, a, b);
+            return UpdateLine(simplex, direction);
+        }
+        if (SameDirection(abc, ao)) {
+            direction = abc;
+        }
+        else {
+            SetSimplex(simplex, a, c, b);//the tetrahedron grows on the other side
+            direction = abc * -1.0f;
+        }
+        return false;
+    }
+
+    bool UpdateTetrahedron(Simplex& simplex, Vector3& direction) {
+        const SupportPoint a = simplex.points[0];
+        const SupportPoint b = simplex.points[1];
+        const SupportPoint c = simplex.points[2];
+        const SupportPoint d = simplex.points[3];
+        const Vector3 ab = b.point - a.point;
+        const Vector3 ac = c.point - a.point;
+        const Vector3 ad = d.point - a.point;
+        const Vector3 ao = a.point * -1.0f;
+
+        if (SameDirection(ab.Cross(ac), ao)) {
+            SetSimplex(simplex, a, b, c);
+            return UpdateTriangle(simplex, direction);
+        }
+        if (SameDirection(ac.Cross(ad), ao)) {
+            SetSimplex(simplex, a, c, d);
+            return UpdateTriangle(simplex, direction);
+        }
+        if (SameDirection(ad.Cross(ab), ao)) {
+            SetSimplex(simplex, a, d, b);
+            return UpdateTriangle(simplex, direction);
+        }
+        return true;
+    }
+
+    struct EpaFace
+    {
+        int vertices[3];//counterclockwise seen from outside
+        Vector3 normal;//outwards
+        float distance;//of the plane to the origin
+    };
+
+    struct EpaEdge
+    {
+        int from, to;
+    };
+
+    //a flat face (a sliver of the polytope) gets an infinite distance : never the closest, never seen
+    EpaFace MakeFace(const SupportPoint* vertices, int a, int b, int c) {
+        EpaFace face{ { a, b, c }, Vector3(), 0.0f };
+        face.normal = (vertices[b].point - vertices[a].point).Cross(vertices[c].point - vertices[a].point);
+        const float length = face.normal.Length();
+        if (length < FLT_EPSILON) {
+            face.normal = Vector3();
+            face.distance = FLT_MAX;
+            return face;
+        }
+        face.normal *= 1.0f / length;
+        face.distance = face.normal.Dot(vertices[a].point);
+        return face;
+    }
+
+    //an edge shared by two removed faces is inside the hole : only the horizon is kept
+    void AddHorizonEdge(EpaEdge* edges, int& edgeCount, int from, int to) {
+        for (int i = 0; i < edgeCount; ++i) {
+            if (edges[i].from == to && edges[i].to == from) {
+                edges[i] = edges[--edgeCount];
+                return;
+            }
+        }
+        edges[edgeCount++] = { from, to };
+    }
+
+    bool IsVisible(const SupportPoint* vertices, const EpaFace& face, const Vector3& point) {
+        return face.normal.Dot(point - vertices[face.vertices[0]].point) > 0.0f;
+    }
+
+    int FindClosestFace(const EpaFace* faces, int faceCount) {
+        int closest = 0;
+        for (int i = 1; i < faceCount; ++i) {
+            if (faces[i].distance < faces[closest].distance) {
+                closest = i;
+            }
+        }
+        return closest;
+    }
+}
+
+SupportPoint physics::GetSupportPoint(const Collider& shape1, const Collider& shape2, const Vector3& direction){
+    SupportPoint support = GetCoreSupportPoint(shape1, shape2, direction);
+    const float margin1 = shape1.GetMargin();
+    const float margin2 = shape2.GetMargin();
+    if (margin1 + margin2 > 0.0f) {
+        const float length = direction.Length();
+        if (length > FLT_EPSILON) {
+            const Vector3 unitDirection = direction * (1.0f / length);
+            support.point1 += unitDirection * margin1;
+            support.point2 -= unitDirection * margin2;
+            support.point = support.point1 - support.point2;
+        }
+    }
+    return support;
+}
+
+bool physics::GjkDistance(const Collider& shape1, const Collider& shape2, ClosestPoints& closest){
+    WeightedSimplex simplex;
+    SetVertex(simplex, GetCoreSupportPoint(shape1, shape2, Vector3(1.0f, 0.0f, 0.0f)));
+    Vector3 closestPoint = simplex.points[0].point;
+
+    for (int iteration = 0; iteration < MAX_GJK_ITERATIONS; ++iteration) {
+        const float distanceSquared = closestPoint.LengthSquared();
+        if (distanceSquared < GJK_OVERLAP_DISTANCE_SQUARED) {
+            return false;
+        }
+        const SupportPoint support = GetCoreSupportPoint(shape1, shape2, closestPoint * -1.0f);
+        if (distanceSquared - closestPoint.Dot(support.point) <= GJK_RELATIVE_TOLERANCE * distanceSquared
+            || IsInSimplex(simplex, support.point)) {
+            break;//no point of the difference is much closer
+        }
+
+        WeightedSimplex reduced;
+        switch (simplex.count) {
+        case 1:
+            ReduceSegment(support, simplex.points[0], reduced);
+            break;
+        case 2:
+            ReduceTriangle(support, simplex.points[0], simplex.points[1], reduced);
+            break;
+        default: {
+            WeightedSimplex tetrahedron = simplex;
+            tetrahedron.points[3] = support;
+            tetrahedron.count = 4;
+            if (ReduceTetrahedron(tetrahedron, reduced) == false) {
+                return false;
+            }
+            break;
+        }
+        }
+        const Vector3 reducedPoint = GetWeightedPoint(reduced);
+        if (!(reducedPoint.LengthSquared() < distanceSquared)) {
+            break;//the rounding errors have the last word
+        }
+        simplex = reduced;
+        closestPoint = reducedPoint;
+    }
+
+    closest.point1 = Vector3();
+    closest.point2 = Vector3();
+    for (int i = 0; i < simplex.count; ++i) {
+        closest.point1 += simplex.points[i].point1 * simplex.weights[i];
+        closest.point2 += simplex.points[i].point2 * simplex.weights[i];
+    }
+    closest.distance = closestPoint.Length();
+    return true;
+}
+
+bool physics::Gjk(const Collider& shape1, const Collider& shape2, Simplex& simplex){
+    Vector3 direction(1.0f, 0.0f, 0.0f);
+    simplex.points[0] = GetSupportPoint(shape1, shape2, direction);
+    simplex.count = 1;
+    direction = simplex.points[0].point * -1.0f;
+
+    for (int iteration = 0; iteration < MAX_GJK_ITERATIONS; ++iteration) {
+        if (direction.LengthSquared() < FLT_EPSILON * FLT_EPSILON) {
+            return false;//the origin is a vertex : touching
+        }
+        SupportPoint support = GetSupportPoint(shape1, shape2, direction);
+        if (support.point.Dot(direction) <= 0.0f) {
+            return false;//the furthest point doesn't pass the origin : separated
+        }
+
+        for (int i = simplex.count; i > 0; --i) {
+            simplex.points[i] = simplex.points[i - 1];
+        }
+        simplex.points[0] = support;
+        ++simplex.count;
+
+        bool enclosesOrigin = false;
+        switch (simplex.count) {
+        case 2:
+            enclosesOrigin = UpdateLine(simplex, direction);
+            break;
+        case 3:
+            enclosesOrigin = UpdateTriangle(simplex, direction);
+            break;
+        default:
+            enclosesOrigin = UpdateTetrahedron(simplex, direction);
+            break;
+        }
+        if (enclosesOrigin) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool physics::Epa(const Collider& shape1, const Collider& shape2, const Simplex& simplex, Penetration& penetration){
+    SupportPoint vertices[MAX_EPA_VERTICES];
+    EpaFace faces[MAX_EPA_FACES];
+    EpaEdge edges[MAX_EPA_FACES * 3];
+    int vertexCount = simplex.count;
+    for (int i = 0; i < simplex.count; ++i) {
+        vertices[i] = simplex.points[i];
+    }
+    //the winding of the tetrahedron decides on which side its faces are seen from
+    const Vector3 edge1 = vertices[1].point - vertices[0].point;
+    const Vector3 edge2 = vertices[2].point - vertices[0].point;
+    const Vector3 edge3 = vertices[3].point - vertices[0].point;
+    if (edge1.Cross(edge2).Dot(edge3) > 0.0f) {
+        std::swap(vertices[1], vertices[2]);
+    }
+    int faceCount = 0;
+    faces[faceCount++] = MakeFace(vertices, 0, 1, 2);
+    faces[faceCount++] = MakeFace(vertices, 0, 3, 1);
+    faces[faceCount++] = MakeFace(vertices, 0, 2, 3);
+    faces[faceCount++] = MakeFace(vertices, 1, 3, 2);
+
+    bool converged = false;
+    for (int iteration = 0; iteration < MAX_EPA_ITERATIONS; ++iteration) {
+        const int closest = FindClosestFace(faces, faceCount);
+        const SupportPoint support = GetSupportPoint(shape1, shape2, faces[closest].normal);
+        if (support.point.Dot(faces[closest].normal) - faces[closest].distance < EPA_TOLERANCE) {
+            converged = true;
+            break;
+        }
+        if (vertexCount == MAX_EPA_VERTICES) {
+            break;
+        }
+
+        //the faces the new vertex sees are replaced by a fan from it to their outline (the horizon)
+        int edgeCount = 0;
+        int visibleCount = 0;
+        for (int i = 0; i < faceCount; ++i) {
+            const EpaFace& face = faces[i];
+            if (IsVisible(vertices, face, support.point)) {
+                AddHorizonEdge(edges, edgeCount, face.vertices[0], face.vertices[1]);
+                AddHorizonEdge(edges, edgeCount, face.vertices[1], face.vertices[2]);
+                AddHorizonEdge(edges, edgeCount, face.vertices[2], face.vertices[0]);
+                ++visibleCount;
+            }
+        }
+        if (faceCount - visibleCount + edgeCount > MAX_EPA_FACES) {
+            break;//the polytope is left whole, its closest face is still a lower bound
+        }
+        for (int i = 0; i < faceCount;) {
+            if (IsVisible(vertices, faces[i], support.point)) {
+                faces[i] = faces[--faceCount];
+            }
+            else {
+                ++i;
+            }
+        }
+        vertices[vertexCount] = support;
+        for (int i = 0; i < edgeCount; ++i) {
+            faces[faceCount++] = MakeFace(vertices, edges[i].from, edges[i].to, vertexCount);
+        }
+        ++vertexCount;
+    }
+    const EpaFace& face = faces[FindClosestFace(faces, faceCount)];
+    if (face.distance == FLT_MAX) {
+        penetration.depth = 0.0f;//flat polytope : touching
+        return false;
+    }
+
+    //the origin projected on the face, as barycentric coordinates of its vertices
+    const SupportPoint& a = vertices[face.vertices[0]];
+    const SupportPoint& b = vertices[face.vertices[1]];
+    const SupportPoint& c = vertices[face.vertices[2]];
+    const Vector3 ab = b.point - a.point;
+    const Vector3 ac = c.point - a.point;
+    const Vector3 aq = face.normal * face.distance - a.point;
+    const float d00 = ab.Dot(ab), d01 = ab.Dot(ac), d11 = ac.Dot(ac);
+    const float d20 = aq.Dot(ab), d21 = aq.Dot(ac);
+    const float denominator = d00 * d11 - d01 * d01;
+    float v = 0.0f, w = 0.0f;
+    if (denominator > FLT_EPSILON) {
+        v = (d11 * d20 - d01 * d21) / denominator;
+        w = (d00 * d21 - d01 * d20) / denominator;
+    }
+    const float u = 1.0f - v - w;
+
+    penetration.normal = face.normal * -1.0f;
+    penetration.depth = face.distance;
+    penetration.point1 = a.point1 * u + b.point1 * v + c.point1 * w;
+    penetration.point2 = a.point2 * u + b.point2 * v + c.point2 * w;
+    return converged;
+}
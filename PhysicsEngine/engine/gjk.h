@@ -0,0 +1,49 @@
+#pragma once
+
+#include "collider.h"
+
+namespace physics
+{
+    //a point of the Minkowski difference shape1 - shape2, with the support points of the shapes it came from
+    struct SupportPoint
+    {
+        Vector3 point;
+        Vector3 point1;//on shape1
+        Vector3 point2;//on shape2
+    };
+
+    //the last simplex of Gjk(), EPA starts from it
+    struct Simplex
+    {
+        SupportPoint points[4];
+        int count{};
+    };
+
+    struct ClosestPoints
+    {
+        Vector3 point1;//on the core of shape1
+        Vector3 point2;//on the core of shape2
+        float distance;
+    };
+
+    struct Penetration
+    {
+        Vector3 normal;//from shape2 to shape1 : moving shape1 along it by depth separates them
+        float depth;
+        Vector3 point1;//deepest point of shape1 in shape2
+        Vector3 point2;//its counterpart on the surface of shape2
+    };
+
+    //on the whole shapes, margins included
+    SupportPoint GetSupportPoint(const Collider& shape1, const Collider& shape2, const Vector3& direction);
+
+    //GJK distance between the cores (margins left out) : false if they overlap, the margins then can't tell the contact
+    bool GjkDistance(const Collider& shape1, const Collider& shape2, ClosestPoints& closest);
+
+    //GJK intersection of the whole shapes : true if they overlap (touching counts as apart), the simplex then encloses the origin
+    bool Gjk(const Collider& shape1, const Collider& shape2, Simplex& simplex);
+
+    //EPA : expands the simplex of an overlap up to the face of the Minkowski difference closest to the origin.
+    //No allocation : false if the polytope outgrew its buffers before converging (the closest face so far is used anyway)
+    bool Epa(const Collider& shape1, const Collider& shape2, const Simplex& simplex, Penetration& penetration);
+}
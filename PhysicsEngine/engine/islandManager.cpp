@@ -0,0 +1,197 @@
+#include "islandManager.h"
+#include <algorithm>//std::min, std::remove
+#include <cfloat>//FLT_MAX
+
+using namespace physics;
+
+void IslandManager::WakeMarkedIslands(){
+    for (RigidBody* body : touchedBodies) {
+        body->SetAwake(true);
+    }
+    touchedBodies.clear();
+
+    for (size_t i = 0; i < sleepingIslands.size();) {
+        bool shouldWake = false;
+        for (const RigidBody* body : sleepingIslands[i]) {
+            if (body->IsAwake()) {
+                shouldWake = true;
+                break;
+            }
+        }
+        if (shouldWake) {
+            WakeSleepingIsland(i);//swaps the last island in, i is visited again
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+void IslandManager::BuildIslands(const std::vector<RigidObject*>& objects, const std::vector<CollisionManifold>& contacts){
+    const int count = static_cast<int>(objects.size());
+    parents.resize(count);
+    bodyIndices.clear();
+    for (int i = 0; i < count; ++i) {
+        parents[i] = i;
+        bodyIndices[objects[i]->GetRigidBody()] = i;
+    }
+
+    for (const CollisionManifold& contact : contacts) {
+        if (contact.bodies[1] == nullptr || contact.bodies[0]->IsFixed() || contact.bodies[1]->IsFixed()) {
+            continue;
+        }
+        Union(bodyIndices[contact.bodies[0]], bodyIndices[contact.bodies[1]]);
+    }
+
+    //touched : an awake body in the same island as a sleeping one
+    hasAwakeBody.assign(count, false);
+    for (int i = 0; i < count; ++i) {
+        const RigidBody* body = objects[i]->GetRigidBody();
+        if (body->IsFixed() == false && body->IsAwake()) {
+            hasAwakeBody[FindRoot(i)] = true;
+        }
+    }
+
+    //they keep sleeping for this step (not integrated), the impulses they get are their velocities once woken
+    for (int i = 0; i < count; ++i) {
+        RigidBody* body = objects[i]->GetRigidBody();
+        if (body->IsFixed() == false && body->IsAwake() == false && hasAwakeBody[FindRoot(i)]) {
+            touchedBodies.push_back(body);
+        }
+    }
+
+    islandCount = 0;
+    for (int i = 0; i < count; ++i) {
+        if (hasAwakeBody[i] && FindRoot(i) == i) {
+            ++islandCount;
+        }
+    }
+}
+
+void IslandManager::GroupContacts(const std::vector<CollisionManifold>& contacts, std::vector<int>& contactOrder, std::vector<int>& islandStarts){
+    //a fixed body is in no island but its own, the other body decides
+    const int contactCount = static_cast<int>(contacts.size());
+    contactRoots.resize(contactCount);
+    islandSizes.assign(parents.size(), 0);
+    for (int i = 0; i < contactCount; ++i) {
+        const CollisionManifold& contact = contacts[i];
+        const RigidBody* body = contact.bodies[0];
+        if (body->IsFixed() && contact.bodies[1] != nullptr) {
+            body = contact.bodies[1];
+        }
+        contactRoots[i] = FindRoot(bodyIndices[body]);
+        ++islandSizes[contactRoots[i]];
+    }
+
+    islandStarts.clear();
+    int start = 0;
+    for (int& size : islandSizes) {
+        if (size == 0) {
+            continue;
+        }
+        islandStarts.push_back(start);
+        start += size;
+        size = islandStarts.back();//now the next free slot of the island
+    }
+    islandStarts.push_back(start);
+
+    contactOrder.resize(contactCount);
+    for (int i = 0; i < contactCount; ++i) {
+        contactOrder[islandSizes[contactRoots[i]]++] = i;
+    }
+}
+
+void IslandManager::UpdateSleep(const std::vector<RigidObject*>& objects, float deltaTime){
+    if (isSleepingEnabled == false) {
+        return;
+    }
+
+    //1. the island sleeps as long as its most restless body allows
+    const int count = static_cast<int>(objects.size());
+    islandSleepTimes.assign(count, FLT_MAX);
+    for (int i = 0; i < count; ++i) {
+        RigidBody* body = objects[i]->GetRigidBody();
+        if (body->IsFixed() || body->IsAwake() == false) {
+            continue;
+        }
+
+        body->SetSleepTime(IsResting(body) ? body->GetSleepTime() + deltaTime : 0.0f);
+        int root = FindRoot(i);
+        islandSleepTimes[root] = std::min(islandSleepTimes[root], body->GetSleepTime());
+    }
+
+    //2. put the islands that have rested long enough to sleep
+    islandSlots.assign(count, -1);
+    for (int i = 0; i < count; ++i) {
+        RigidBody* body = objects[i]->GetRigidBody();
+        if (body->IsFixed() || body->IsAwake() == false) {
+            continue;
+        }
+        int root = FindRoot(i);
+        if (islandSleepTimes[root] < TIME_TO_SLEEP) {
+            continue;
+        }
+
+        if (islandSlots[root] < 0) {
+            islandSlots[root] = static_cast<int>(sleepingIslands.size());
+            sleepingIslands.emplace_back();
+        }
+        sleepingIslands[islandSlots[root]].push_back(body);
+        body->SetAwake(false);
+    }
+}
+
+void IslandManager::WakeAll(const std::vector<RigidObject*>& objects){
+    for (RigidObject* obj : objects) {
+        obj->GetRigidBody()->SetAwake(true);
+    }
+    sleepingIslands.clear();
+    touchedBodies.clear();
+}
+
+void IslandManager::RemoveBody(const RigidBody* body){
+    touchedBodies.erase(std::remove(touchedBodies.begin(), touchedBodies.end(), body), touchedBodies.end());
+    for (size_t i = 0; i < sleepingIslands.size(); ++i) {
+        if (std::find(sleepingIslands[i].begin(), sleepingIslands[i].end(), body) != sleepingIslands[i].end()) {
+            WakeSleepingIsland(i);//the rest may have been resting on it
+            return;
+        }
+    }
+}
+
+int IslandManager::FindRoot(int idx){
+    //path halving
+    while (parents[idx] != idx) {
+        parents[idx] = parents[parents[idx]];
+        idx = parents[idx];
+    }
+    return idx;
+}
+
+void IslandManager::Union(int idx1, int idx2){
+    int root1 = FindRoot(idx1);
+    int root2 = FindRoot(idx2);
+    if (root1 == root2) {
+        return;
+    }
+    //the smaller index becomes the root, keeps the islands independent of the contact order
+    if (root1 < root2) {
+        parents[root2] = root1;
+    }
+    else {
+        parents[root1] = root2;
+    }
+}
+
+void IslandManager::WakeSleepingIsland(size_t islandIdx){
+    for (RigidBody* body : sleepingIslands[islandIdx]) {
+        body->SetAwake(true);
+    }
+    sleepingIslands[islandIdx] = std::move(sleepingIslands.back());
+    sleepingIslands.pop_back();
+}
+
+bool IslandManager::IsResting(const RigidBody* body) const{
+    return body->GetLinearVelocity().LengthSquared() < linearSleepTolerance * linearSleepTolerance
+        && body->GetAngularVelocity().LengthSquared() < angularSleepTolerance * angularSleepTolerance;
+}
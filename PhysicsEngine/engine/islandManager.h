@@ -0,0 +1,73 @@
+#pragma once
+
+#include "contact.h"
+#include "simulator/object.h"
+#include <vector>
+#include <unordered_map>
+
+namespace physics
+{
+    //Groups the bodies touching each other (union-find over the contact graph) into islands.
+    //An island falls asleep once all of its bodies stayed slower than the tolerances for TIME_TO_SLEEP,
+    //and wakes up as a whole when one of its bodies is touched or woken up from outside.
+    //A touched island wakes at the start of the next step : its contacts, its plane contacts and its gravity
+    //were skipped by the step that found the touch, solving it without them would let it sink.
+    //Fixed bodies (e.g. the ground) don't connect islands.
+    class IslandManager
+    {
+        friend class PhysicsWorld;
+
+    public:
+        static constexpr float TIME_TO_SLEEP = 0.5f;
+
+    private:
+        float linearSleepTolerance;
+        float angularSleepTolerance;
+        bool isSleepingEnabled;
+
+        //built every step, indices into the objects of the world
+        std::vector<int> parents;
+        std::vector<float> islandSleepTimes;
+        std::vector<int> islandSlots;//root -> sleepingIslands index, while putting islands to sleep
+        std::vector<bool> hasAwakeBody;//per root
+        std::vector<int> contactRoots;
+        std::vector<int> islandSizes;//per root, then the island's start in the order
+        std::unordered_map<const RigidBody*, int> bodyIndices;
+        int islandCount;
+
+        //the members of the islands put to sleep, to wake them up together
+        std::vector<std::vector<RigidBody*>> sleepingIslands;
+        std::vector<RigidBody*> touchedBodies;//sleeping bodies touched by awake ones, woken by the next WakeMarkedIslands()
+
+    public:
+        IslandManager()
+            : linearSleepTolerance(0.05f), angularSleepTolerance(0.05f), isSleepingEnabled(true), islandCount{} {}
+
+        //a sleeping island with an awake body (e.g. woken by an event) or a touched body is woken up completely.
+        //Call at the start of a step, before the gravity and the collision detection
+        void WakeMarkedIslands();
+
+        //unions the bodies of every manifold, then marks the sleeping bodies touched by awake ones
+        void BuildIslands(const std::vector<RigidObject*>& objects, const std::vector<CollisionManifold>& contacts);
+
+        //groups the contact indices by island (counting sort, detection order kept within an island),
+        //island i owns contactOrder[islandStarts[i], islandStarts[i+1]). Call after BuildIslands()
+        void GroupContacts(const std::vector<CollisionManifold>& contacts, std::vector<int>& contactOrder, std::vector<int>& islandStarts);
+
+        //advances the sleep timers and puts the islands that came to rest to sleep
+        void UpdateSleep(const std::vector<RigidObject*>& objects, float deltaTime);
+
+        void WakeAll(const std::vector<RigidObject*>& objects);
+
+        //wakes up the island the body is sleeping in, and forgets the body
+        void RemoveBody(const RigidBody* body);
+
+        int GetIslandCount() const { return islandCount; }//awake ones, as of the last step
+
+    private:
+        int FindRoot(int idx);
+        void Union(int idx1, int idx2);
+        void WakeSleepingIsland(size_t islandIdx);
+        bool IsResting(const RigidBody* body) const;
+    };
+}
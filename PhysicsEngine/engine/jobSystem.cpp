@@ -0,0 +1,214 @@
+#include "jobSystem.h"
+#include <algorithm>//std::max, std::min
+#include <stdexcept>
+
+using namespace physics;
+
+namespace
+{
+    //which queue the current thread owns, threads outside of the system use queue 0
+    thread_local const JobSystem* currentSystem = nullptr;
+    thread_local int currentQueueIdx = 0;
+}
+
+JobSystem::JobSystem(int threadCount)
+    : queuedJobs{}, isStopping{ false }
+{
+    if (threadCount < 1) {
+        throw std::runtime_error("JobSystem::JobSystem(), thread count must be at least 1");
+    }
+    StartWorkers(threadCount);
+}
+
+JobSystem::~JobSystem(){
+    StopWorkers();
+}
+
+void JobSystem::SetThreadCount(int threadCount){
+    if (threadCount < 1) {
+        throw std::runtime_error("JobSystem::SetThreadCount(), thread count must be at least 1");
+    }
+    if (threadCount == GetThreadCount()) {
+        return;
+    }
+    StopWorkers();
+    StartWorkers(threadCount);
+}
+
+int JobSystem::GetHardwareThreadCount(){
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+JobHandle JobSystem::Schedule(std::function<void()> task, std::initializer_list<JobHandle> dependencies){
+    JobHandle job = std::make_shared<Job>();
+    job->task = std::move(task);
+    job->pendingDependencies = 1;//held until every dependency is registered
+
+    for (const JobHandle& dependency : dependencies) {
+        if (dependency == nullptr) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(dependency->dependentsMutex);
+        if (dependency->isFinished == false) {
+            ++job->pendingDependencies;
+            dependency->dependents.push_back(job);
+        }
+    }
+
+    if (--job->pendingDependencies == 0) {
+        Enqueue(job);
+    }
+    return job;
+}
+
+void JobSystem::Wait(const JobHandle& job){
+    const int queueIdx = GetCurrentQueueIdx();
+    while (job->isFinished == false) {
+        if (RunOneJob(queueIdx) == false) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::ParallelFor(int count, int grainSize, const std::function<void(int, int)>& task){
+    ParallelForChunks(count, grainSize, [&task](int, int begin, int end) { task(begin, end); });
+}
+
+void JobSystem::ParallelForChunks(int count, int grainSize, const std::function<void(int, int, int)>& task){
+    if (count <= 0) {
+        return;
+    }
+    grainSize = std::max(grainSize, 1);
+
+    //1 thread : inline, in order
+    if (GetThreadCount() == 1 || count <= grainSize) {
+        task(0, 0, count);
+        return;
+    }
+
+    std::vector<JobHandle> chunks;
+    chunks.reserve(GetChunkCount(count, grainSize));
+    for (int begin = 0; begin < count; begin += grainSize) {
+        int end = std::min(begin + grainSize, count);
+        int chunkIdx = static_cast<int>(chunks.size());
+        chunks.push_back(Schedule([&task, chunkIdx, begin, end]() { task(chunkIdx, begin, end); }));
+    }
+    for (const JobHandle& chunk : chunks) {
+        Wait(chunk);
+    }
+}
+
+int JobSystem::GetChunkCount(int count, int grainSize){
+    grainSize = std::max(grainSize, 1);
+    return std::max(0, (count + grainSize - 1) / grainSize);
+}
+
+void JobSystem::StartWorkers(int threadCount){
+    isStopping = false;
+    queues.clear();
+    for (int i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (int i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+void JobSystem::StopWorkers(){
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        isStopping = true;
+    }
+    sleepCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void JobSystem::WorkerLoop(int queueIdx){
+    currentSystem = this;
+    currentQueueIdx = queueIdx;
+
+    while (true) {
+        if (RunOneJob(queueIdx)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCondition.wait(lock, [this]() { return isStopping || queuedJobs > 0; });
+        if (isStopping) {
+            return;
+        }
+    }
+}
+
+void JobSystem::Enqueue(JobHandle job){
+    WorkerQueue& queue = *queues[GetCurrentQueueIdx()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    {
+        //under the sleep mutex, so a worker can't miss it between its check and its wait
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        ++queuedJobs;
+    }
+    sleepCondition.notify_one();
+}
+
+bool JobSystem::RunOneJob(int queueIdx){
+    JobHandle job = PopOrSteal(queueIdx);
+    if (job == nullptr) {
+        return false;
+    }
+    job->task();
+    Finish(job);
+    return true;
+}
+
+JobHandle JobSystem::PopOrSteal(int queueIdx){
+    const int queueCount = GetThreadCount();
+
+    //own queue first, newest job (its data is likely still in the cache)
+    {
+        WorkerQueue& queue = *queues[queueIdx];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty() == false) {
+            JobHandle job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            --queuedJobs;
+            return job;
+        }
+    }
+
+    //then steal the oldest job of the others
+    for (int i = 1; i < queueCount; ++i) {
+        WorkerQueue& victim = *queues[(queueIdx + i) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.jobs.empty() == false) {
+            JobHandle job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            --queuedJobs;
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::Finish(const JobHandle& job){
+    std::vector<JobHandle> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->dependentsMutex);
+        job->isFinished = true;
+        dependents.swap(job->dependents);
+    }
+    for (JobHandle& dependent : dependents) {
+        if (--dependent->pendingDependencies == 0) {
+            Enqueue(std::move(dependent));
+        }
+    }
+}
+
+int JobSystem::GetCurrentQueueIdx() const{
+    return (currentSystem == this) ? currentQueueIdx : 0;
+}
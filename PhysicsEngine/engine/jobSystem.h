@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>//std::shared_ptr, std::unique_ptr
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace physics
+{
+    struct Job
+    {
+        std::function<void()> task;
+        std::atomic<int> pendingDependencies;
+        std::atomic<bool> isFinished;
+
+        std::mutex dependentsMutex;
+        std::vector<std::shared_ptr<Job>> dependents;//queued once this job finishes
+
+        Job() : pendingDependencies{}, isFinished{ false } {}
+    };
+    typedef std::shared_ptr<Job> JobHandle;
+
+    //Work-stealing scheduler : every worker owns a deque, takes its newest job from the back
+    //and steals the oldest ones from the front of the others' deques when it runs dry.
+    //The thread calling Wait()/ParallelFor() owns deque 0 and runs jobs as well,
+    //so with a thread count of 1 no thread is started and everything runs inline, in order.
+    class JobSystem
+    {
+    private:
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<JobHandle> jobs;
+        };
+
+        std::vector<std::unique_ptr<WorkerQueue>> queues;//[0] : the calling thread
+        std::vector<std::thread> workers;//own queues[1..]
+
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+        std::atomic<int> queuedJobs;
+        bool isStopping;
+
+    public:
+        JobSystem(int threadCount = 1);//at least 1, the calling thread counts as one
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        //restarts the workers, don't call while jobs are in flight
+        void SetThreadCount(int threadCount);
+        int GetThreadCount() const { return static_cast<int>(queues.size()); }
+        static int GetHardwareThreadCount();
+
+        //the job is queued once all of its dependencies finished
+        JobHandle Schedule(std::function<void()> task, std::initializer_list<JobHandle> dependencies = {});
+
+        //runs queued jobs on the calling thread until the job is finished
+        void Wait(const JobHandle& job);
+
+        //calls task(begin, end) over [0, count) in chunks of about grainSize, returns once all of them are done
+        void ParallelFor(int count, int grainSize, const std::function<void(int, int)>& task);
+        //same, task(chunkIdx, begin, end) : every chunk of the call gets its own chunkIdx, below GetChunkCount()
+        //and increasing with begin, e.g. to write into per-chunk buffers merged in range order
+        void ParallelForChunks(int count, int grainSize, const std::function<void(int, int, int)>& task);
+        static int GetChunkCount(int count, int grainSize);
+
+    private:
+        void StartWorkers(int threadCount);
+        void StopWorkers();
+        void WorkerLoop(int queueIdx);
+
+        void Enqueue(JobHandle job);
+        bool RunOneJob(int queueIdx);
+        JobHandle PopOrSteal(int queueIdx);
+        void Finish(const JobHandle& job);
+        int GetCurrentQueueIdx() const;
+    };
+}
@@ -1,12 +1,28 @@
 #include "physicsWorld.h"
 #include "simulator/object.h"
+#include "profiler.h"
 #include <iterator>
-#include <typeinfo>
 #include <cmath>
 #include <iostream>
+#include <chrono>
+#include <atomic>
 
 using namespace physics;
 
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    //ms since 'start', which moves to now : one call per phase
+    float Lap(Clock::time_point& start)
+    {
+        Clock::time_point now = Clock::now();
+        float elapsed = std::chrono::duration<float, std::milli>(now - start).count();
+        start = now;
+        return elapsed;
+    }
+}
+
 float PhysicsWorld::gravity = 9.8f;
 
 PhysicsWorld::PhysicsWorld()  {
@@ -15,35 +31,145 @@ PhysicsWorld::PhysicsWorld()  {
 
 PhysicsWorld::~PhysicsWorld(){
     for (auto& obj : objects) {
-        obj->FreePhysicsComponents();
+        FreePhysicsComponents(obj);
     }
 }
 
 void PhysicsWorld::Simulate(float duration)
 {
-    //0. reset
+    PROFILE_ZONE("Simulate");
+    const uint64_t allocationsAtStart = GetHeapAllocationCount();
+    const Clock::time_point stepStart = Clock::now();
+    Clock::time_point phaseStart = stepStart;
+
+    //0. reset, the islands touched during the last step wake up before their gravity and contacts
     collisionManager.contacts.clear();
+    islandManager.WakeMarkedIslands();
 
     //1. gravity
-    for (auto& obj : objects) {
-        obj->GetRigidBody()->AddForce(Vector3{ 0.f,-gravity,0.f } * obj->GetRigidBody()->GetMass());
+    {
+        PROFILE_ZONE("Gravity");
+        jobSystem.ParallelFor(bodyStorage.GetSimulatedCount(), BODY_GRAIN_SIZE, [this](int begin, int end) {
+            bodyStorage.ApplyGravity(begin, end, gravity);
+        });
+    }
+    lastStepTimings.gravity = Lap(phaseStart);
+
+    //2. detect collisions (pairs of sleeping/fixed bodies are skipped)
+    collisionManager.DetectCollision(objects, constraints, jobSystem);
+    lastStepTimings.collisionDetection = Lap(phaseStart);
+
+    //3. islands, the sleeping bodies touched by awake ones wake up at the start of the next step
+    {
+        PROFILE_ZONE("Islands");
+        islandManager.BuildIslands(objects, collisionManager.contacts);
+        islandManager.GroupContacts(collisionManager.contacts, collisionManager.islandContacts, collisionManager.islandStarts);
+    }
+    lastStepTimings.islands = Lap(phaseStart);
+
+    std::atomic<int> integratedCount{ 0 };
+    if (collisionManager.solverMode == SolverMode::SOFT_SUBSTEPS) {
+        //4. + 5. interleaved, see SolveSubsteps()
+        integratedCount = SolveSubsteps(duration);
+        phaseStart = Clock::now();
+    }
+    else {
+        //4. resolve collisions
+        collisionManager.ResolveCollision(duration, jobSystem);
+        lastStepTimings.solver = Lap(phaseStart);
+
+        //5. Integrate (sleeping bodies are skipped)
+        {
+            PROFILE_ZONE("Integration");
+            jobSystem.ParallelFor(bodyStorage.GetSimulatedCount(), BODY_GRAIN_SIZE, [this, duration, &integratedCount](int begin, int end) {
+                PROFILE_ZONE("Integration job");
+                integratedCount.fetch_add(bodyStorage.Integrate(begin, end, duration), std::memory_order_relaxed);
+            });
+        }
+        lastStepTimings.integration = Lap(phaseStart);
+    }
+
+    //6. sleep, after the integration : the Baumgarte bias and the gravity cancel out for a resting body
+    {
+        PROFILE_ZONE("Sleep");
+        islandManager.UpdateSleep(objects, duration);
     }
+    lastStepTimings.sleep = Lap(phaseStart);
 
-    //2. detect collisions
-    collisionManager.DetectCollision(objects, constraints);
+    lastStepTimings.total = std::chrono::duration<float, std::milli>(phaseStart - stepStart).count();
 
-    //3. resolve collisions
-    collisionManager.ResolveCollision(duration);
+    StepStats stats;
+    collisionManager.FillStepStats(stats);
+    stats.bodiesIntegrated = integratedCount.load(std::memory_order_relaxed);
+    stats.heapAllocations = static_cast<int>(GetHeapAllocationCount() - allocationsAtStart);
+    stepStats.Add(stats);
+}
+
+//every substep : gravity into the velocities, warm start, a solve with the soft bias, the positions move,
+//a relax pass without the bias. The contacts found at the start of the step are kept for all the substeps
+int PhysicsWorld::SolveSubsteps(float duration){
+    const int substepCount = collisionManager.softContactSolver.GetSettings().substepCount;
+    const float substep = duration / substepCount;
+    const int bodyCount = bodyStorage.GetSimulatedCount();
+    SoftContactSolver& solver = collisionManager.softContactSolver;
+
+    Clock::time_point phaseStart = Clock::now();
+    lastStepTimings.solver = 0.0f;
+    lastStepTimings.integration = 0.0f;
+    {
+        PROFILE_ZONE("Solver");
+        collisionManager.PrepareSubsteps(substep);
+    }
+    lastStepTimings.solver += Lap(phaseStart);
 
-    //4. Integrate
-    for (auto& obj : objects){
-        obj->GetRigidBody()->Integrate(duration);
+    std::atomic<int> integratedCount{ 0 };
+    for (int i = 0; i < substepCount; ++i) {
+        {
+            PROFILE_ZONE("Integration");
+            jobSystem.ParallelFor(bodyCount, BODY_GRAIN_SIZE, [this, substep, i, &integratedCount](int begin, int end) {
+                const int count = bodyStorage.IntegrateVelocities(begin, end, substep);
+                if (i == 0) {
+                    integratedCount.fetch_add(count, std::memory_order_relaxed);
+                }
+            });
+        }
+        lastStepTimings.integration += Lap(phaseStart);
+        {
+            PROFILE_ZONE("Solver iteration");
+            solver.WarmStart();
+            solver.Solve(true);
+        }
+        lastStepTimings.solver += Lap(phaseStart);
+        {
+            PROFILE_ZONE("Integration");
+            jobSystem.ParallelFor(bodyCount, BODY_GRAIN_SIZE, [this, substep](int begin, int end) {
+                PROFILE_ZONE("Integration job");
+                bodyStorage.IntegratePositions(begin, end, substep);
+            });
+        }
+        lastStepTimings.integration += Lap(phaseStart);
+        {
+            PROFILE_ZONE("Solver iteration");
+            solver.Solve(false);
+        }
+        lastStepTimings.solver += Lap(phaseStart);
     }
+
+    {
+        PROFILE_ZONE("Solver");
+        collisionManager.FinishSubsteps();
+    }
+    lastStepTimings.solver += Lap(phaseStart);
+    jobSystem.ParallelFor(bodyCount, BODY_GRAIN_SIZE, [this](int begin, int end) {
+        bodyStorage.ClearForces(begin, end);
+    });
+    lastStepTimings.integration += Lap(phaseStart);
+    return integratedCount.load(std::memory_order_relaxed);
 }
 
 void PhysicsWorld::AddRigidBody(float posX, float posY, float posZ,RigidObject* obj)
 {
-    RigidBody* newBody = new RigidBody;
+    RigidBody* newBody = CreateRigidBody();
     newBody->SetMass(5.0f);
     newBody->SetPosition(posX, posY, posZ);
     newBody->SetLinearAcceleration(0.0f, -gravity, 0.0f);
@@ -58,6 +184,12 @@ void PhysicsWorld::AddRigidBody(float posX, float posY, float posZ,RigidObject*
         float value = newBody->GetMass() / 6.0f;
         inertiaTensor.SetDiagonal(value);
     }
+    else if (dynamic_cast<CapsuleObject*>(obj)!=nullptr){
+        inertiaTensor = CapsuleObject::CalcInertiaTensor(newBody->GetMass(), 0.5f, 0.5f);//the collider of AddCollider()
+    }
+    else if (dynamic_cast<ConvexHullObject*>(obj)!=nullptr){
+        inertiaTensor = static_cast<ConvexHullObject*>(obj)->CalcInertiaTensor(newBody->GetMass());
+    }
     newBody->SetInertiaTensor(inertiaTensor);
 
     obj->SetRigidBody(newBody);
@@ -67,24 +199,115 @@ void PhysicsWorld::AddCollider(RigidBody* rigidBody, RigidObject* obj){
     Collider* newCollider{nullptr};
 
     if (dynamic_cast<SphereObject*>(obj) != nullptr) {
-        newCollider = new SphereCollider(rigidBody, 1.0f);
+        newCollider = CreateSphereCollider(rigidBody, 1.0f);
     }
     else if (dynamic_cast<BoxObject*>(obj) != nullptr) {
-        newCollider = new BoxCollider(rigidBody, 0.5f, 0.5f, 0.5f);
+        newCollider = CreateBoxCollider(rigidBody, Vector3(0.5f, 0.5f, 0.5f));
+    }
+    else if (dynamic_cast<CapsuleObject*>(obj) != nullptr) {
+        newCollider = CreateCapsuleCollider(rigidBody, 0.5f, 0.5f);
+    }
+    else if (dynamic_cast<ConvexHullObject*>(obj) != nullptr) {
+        newCollider = CreateConvexHullCollider(rigidBody, static_cast<ConvexHullObject*>(obj)->GetHull());
     }
 
     obj->SetCollider(newCollider);
 }
 
 void physics::PhysicsWorld::AddPhysicalObject(RigidObject* obj) {
+    objectIndices[obj] = static_cast<int>(objects.size());
     objects.push_back(obj);
+    bodyStorage.SetSimulated(obj->GetRigidBody()->GetHandle(), true);
+    collisionManager.broadPhase->AddObject(obj);
 }
 
-void PhysicsWorld::RemovePhysicsObject(RigidObject* obj){
+std::vector<RigidObject*>::iterator PhysicsWorld::RemovePhysicsObject(RigidObject* obj){
     if (obj == nullptr) {
         throw std::runtime_error("nullptr passed to removePhysicsObject");
     }
-    obj->FreePhysicsComponents();
+    collisionManager.broadPhase->RemoveObject(obj);
+    collisionManager.RemoveCachedContacts(obj->GetRigidBody());
+    islandManager.RemoveBody(obj->GetRigidBody());
+    FreePhysicsComponents(obj);
+
+    //e.g. the objects of a spawner's pool were never added
+    auto itr = objectIndices.find(obj);
+    if (itr == objectIndices.end()) {
+        return objects.end();
+    }
+    const int idx = itr->second;
+    objectIndices.erase(itr);
+
+    objects[idx] = objects.back();
+    objects.pop_back();
+    if (idx == static_cast<int>(objects.size())) {
+        return objects.end();
+    }
+    objectIndices[objects[idx]] = idx;
+    return objects.begin() + idx;
+}
+
+void PhysicsWorld::FreePhysicsComponents(RigidObject* obj){
+    Collider* collider = obj->GetCollider();
+    if (collider != nullptr) {
+        if (collider->GetShapeType() == ShapeType::SPHERE) {
+            sphereColliders.Destroy(static_cast<SphereCollider*>(collider));
+        }
+        else if (collider->GetShapeType() == ShapeType::BOX) {
+            boxColliders.Destroy(static_cast<BoxCollider*>(collider));
+        }
+        else if (collider->GetShapeType() == ShapeType::CAPSULE) {
+            capsuleColliders.Destroy(static_cast<CapsuleCollider*>(collider));
+        }
+        else if (collider->GetShapeType() == ShapeType::CONVEX_HULL) {
+            convexHullColliders.Destroy(static_cast<ConvexHullCollider*>(collider));
+        }
+    }
+    rigidBodies.Destroy(obj->GetRigidBody());
+    obj->SetCollider(nullptr);
+    obj->SetRigidBody(nullptr);
+}
+
+SlotHandle PhysicsWorld::GetColliderHandle(const Collider* collider) const{
+    if (collider->GetShapeType() == ShapeType::SPHERE) {
+        return sphereColliders.GetHandle(static_cast<const SphereCollider*>(collider));
+    }
+    else if (collider->GetShapeType() == ShapeType::BOX) {
+        return boxColliders.GetHandle(static_cast<const BoxCollider*>(collider));
+    }
+    else if (collider->GetShapeType() == ShapeType::CAPSULE) {
+        return capsuleColliders.GetHandle(static_cast<const CapsuleCollider*>(collider));
+    }
+    else if (collider->GetShapeType() == ShapeType::CONVEX_HULL) {
+        return convexHullColliders.GetHandle(static_cast<const ConvexHullCollider*>(collider));
+    }
+    throw std::runtime_error("PhysicsWorld::GetColliderHandle(): unknown shape type");
+}
+
+Collider* PhysicsWorld::GetCollider(ShapeType type, SlotHandle handle) const{
+    if (type == ShapeType::SPHERE) {
+        return sphereColliders.Get(handle);
+    }
+    else if (type == ShapeType::BOX) {
+        return boxColliders.Get(handle);
+    }
+    else if (type == ShapeType::CAPSULE) {
+        return capsuleColliders.Get(handle);
+    }
+    else if (type == ShapeType::CONVEX_HULL) {
+        return convexHullColliders.Get(handle);
+    }
+    return nullptr;
+}
+
+void PhysicsWorld::SetBroadPhase(BroadPhaseType type){
+    if (type == GetBroadPhaseType()) {
+        return;
+    }
+    collisionManager.broadPhase = CreateBroadPhase(type);
+    for (RigidObject* obj : objects) {
+        collisionManager.broadPhase->AddObject(obj);
+    }
 }
 
 float PhysicsWorld::CalcDistanceBetweenRayAndObject(
@@ -93,21 +316,7 @@ float PhysicsWorld::CalcDistanceBetweenRayAndObject(
     RigidObject* obj
 )
 {
-    float distance;
-    Collider* collider=obj->GetCollider();
-
-    if (typeid(*collider) == typeid(SphereCollider))
-    {
-        SphereCollider* sphere = static_cast<SphereCollider*>(collider);
-        distance = collisionManager.CaclRaySphereHitPointDistance(rayOrigin, rayDirection, *sphere);
-    }
-    else if (typeid(*collider) == typeid(BoxCollider))
-    {
-        BoxCollider* box = static_cast<BoxCollider*>(collider);
-        distance = collisionManager.RayAndBox(rayOrigin, rayDirection, *box);
-    }
-
-    return distance;
+    return collisionManager.CalcRayDistance(rayOrigin, rayDirection, obj->GetCollider());
 }
 
 void PhysicsWorld::SetGroundRestitution(float value){
@@ -118,8 +327,48 @@ void PhysicsWorld::SetObjectRestitution(float value){
     collisionManager.objectRestitution = value;
 }
 
+void PhysicsWorld::SetSolverIterations(int value){
+    collisionManager.iterationLimit = value;
+}
+
+void PhysicsWorld::SetSolverTolerance(float value){
+    collisionManager.solverTolerance = value;
+}
+
+void PhysicsWorld::SetSolverMode(SolverMode mode){
+    collisionManager.solverMode = mode;
+}
+
+void PhysicsWorld::SetSoftContactSettings(const SoftContactSettings& settings){
+    if (settings.substepCount < 1) {
+        throw std::runtime_error("at least one substep is needed");
+    }
+    collisionManager.softContactSolver.SetSettings(settings);
+}
+
+void PhysicsWorld::SetSimdLevel(SimdLevel level){
+    collisionManager.contactSolver.SetSimdLevel(level);
+}
+
+void PhysicsWorld::SetWarmStarting(bool value){
+    collisionManager.warmStarting = value;
+    collisionManager.contactCache.clear();
+}
+
+void PhysicsWorld::SetSleepingEnabled(bool value){
+    islandManager.isSleepingEnabled = value;
+    if (value == false) {
+        islandManager.WakeAll(objects);
+    }
+}
+
+void PhysicsWorld::SetThreadCount(int value){
+    jobSystem.SetThreadCount(value);
+}
+
 void PhysicsWorld::SetGravity(float value){
     gravity = value;
+    islandManager.WakeAll(objects);
     for(auto& obj:objects){
         obj->GetRigidBody()->SetLinearAcceleration(0.0f, -gravity, 0.0f);
     }
@@ -1,7 +1,12 @@
 #pragma once
 
 #include "body.h"
+#include "bodyStorage.h"
 #include "collisionManager.h"
+#include "islandManager.h"
+#include "jobSystem.h"
+#include "slotMap.h"
+#include "stepStats.h"
 #include "engine/contact.h"
 #include "simulator/object.h"
 #include <memory>//std::unique_ptr
@@ -10,38 +15,86 @@
 
 namespace physics
 {
+    //wall-clock time of the phases of one Simulate(), in ms
+    struct StepTimings
+    {
+        float gravity{};
+        float collisionDetection{};//broad + narrow phase
+        float islands{};
+        float solver{};
+        float integration{};
+        float sleep{};
+        float total{};
+    };
+
     class PhysicsWorld
     {
     public:
         typedef std::vector<physics::CollisionManifold> Manifolds;
 
         static float gravity;
+        static constexpr int BODY_GRAIN_SIZE = 64;//bodies per job of the gravity/integration loops
 
     private:
+        BodyStorage bodyStorage;//first : outlives the bodies the other members point to
+        SlotMap<RigidBody> rigidBodies;
+        SlotMap<SphereCollider> sphereColliders;
+        SlotMap<BoxCollider> boxColliders;
+        SlotMap<CapsuleCollider> capsuleColliders;
+        SlotMap<ConvexHullCollider> convexHullColliders;
 
         std::vector<RigidObject*> objects;
+        std::unordered_map<const RigidObject*, int> objectIndices;//index in objects
         std::vector<std::unique_ptr<Constraint>> constraints;//plane has no rigid rigidBody
         // http://gamedev.tutsplus.com/tutorials/implementation/create-custom-2d-physics-engine-aabb-circle-impulse-resolution/
 
         CollisionManager collisionManager;
+        IslandManager islandManager;
+        JobSystem jobSystem;
+
+        StepTimings lastStepTimings;
+        StepStatsWindow stepStats;
 
+        void FreePhysicsComponents(RigidObject* obj);
+        int SolveSubsteps(float duration);
 
     public:
         PhysicsWorld();
         ~PhysicsWorld();
 
-        Manifolds GetManifold() const { return collisionManager.contacts; }
+        const Manifolds& GetContacts() const { return collisionManager.contacts; }//of the last step
 
         std::vector<RigidObject*>& GetObjects() { return objects; }
 
         void Simulate(float duration);
+        const StepTimings& GetLastStepTimings() const { return lastStepTimings; }
+        const StepStatsWindow& GetStepStats() const { return stepStats; }//counters of the last steps
+
+        //the body lives in the world's storage, it is simulated once its object is added by AddPhysicalObject()
+        RigidBody* CreateRigidBody() { return rigidBodies.Create(bodyStorage); }
+        SphereCollider* CreateSphereCollider(RigidBody* body, float radius) { return sphereColliders.Create(body, radius); }
+        BoxCollider* CreateBoxCollider(RigidBody* body, const Vector3& extents) { return boxColliders.Create(body, extents.x, extents.y, extents.z); }
+        CapsuleCollider* CreateCapsuleCollider(RigidBody* body, float radius, float halfHeight) { return capsuleColliders.Create(body, radius, halfHeight); }
+        ConvexHullCollider* CreateConvexHullCollider(RigidBody* body, std::shared_ptr<const ConvexHull> hull) { return convexHullColliders.Create(body, std::move(hull)); }
+
+        //nullptr once the body is destroyed, even if its slot was reused
+        SlotHandle GetRigidBodyHandle(const RigidBody* body) const { return rigidBodies.GetHandle(body); }
+        RigidBody* GetRigidBody(SlotHandle handle) const { return rigidBodies.Get(handle); }
+        //same for the colliders, whose handles are only valid in the SlotMap of their shape type
+        SlotHandle GetColliderHandle(const Collider* collider) const;
+        Collider* GetCollider(ShapeType type, SlotHandle handle) const;
 
         void AddRigidBody(float posX, float posY, float posZ, RigidObject* obj);
-
         void AddCollider(RigidBody*, RigidObject* obj);
         void AddPhysicalObject(RigidObject* obj);
 
-        void RemovePhysicsObject(RigidObject* id);
+        //O(1), the last object takes its place : returns the iterator to it (end() if there is none)
+        std::vector<RigidObject*>::iterator RemovePhysicsObject(RigidObject* obj);
+
+        //switches the broad phase used by the collision detection, e.g. to benchmark against BRUTE_FORCE
+        void SetBroadPhase(BroadPhaseType type);
+        BroadPhaseType GetBroadPhaseType() const { return collisionManager.broadPhase->GetType(); }
+        const BroadPhase* GetBroadPhase() const { return collisionManager.broadPhase.get(); }//e.g. for SpatialHashGrid::GetStats()
 
         float CalcDistanceBetweenRayAndObject(
             const Vector3& rayOrigin,
@@ -51,6 +104,21 @@ namespace physics
 
         void SetGroundRestitution(float value);
         void SetObjectRestitution(float value);
+        void SetSolverIterations(int value);//at most, see SetSolverTolerance()
+        void SetSolverTolerance(float value);//largest impulse change (N.s) of a converged iteration, 0 : always every iteration
+        void SetSolverMode(SolverMode mode);//GRAPH_COLORED spreads the contacts over the job system's threads
+        SolverMode GetSolverMode() const { return collisionManager.solverMode; }
+        void SetSoftContactSettings(const SoftContactSettings& settings);//of SOFT_SUBSTEPS
+        const SoftContactSettings& GetSoftContactSettings() const { return collisionManager.softContactSolver.GetSettings(); }
+        void SetSimdLevel(SimdLevel level);//kernel of SIMD_BATCHES, capped to what the CPU supports
+        SimdLevel GetSimdLevel() const { return collisionManager.contactSolver.GetSimdLevel(); }
+        void SetWarmStarting(bool value);//reuse the impulses of the persisting contacts
+        void SetSleepingEnabled(bool value);
+        int GetIslandCount() const { return islandManager.GetIslandCount(); }
         void SetGravity(float value);
+
+        //1 (default) : the step runs on the calling thread only
+        void SetThreadCount(int value);
+        int GetThreadCount() const { return jobSystem.GetThreadCount(); }
     };
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "profiler.h"
+#include <algorithm>//std::max
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>//std::setprecision
+#include <memory>//std::unique_ptr
+#include <mutex>
+
+using namespace physics;
+
+namespace
+{
+    //a sequence lock per slot : 2 * j + 1 while the owner writes its event j into the slot, 2 * j + 2 once written.
+    //The fields are atomics too (relaxed), so that a reader racing the owner reads a torn event, never undefined behavior
+    struct EventSlot
+    {
+        std::atomic<uint64_t> sequence{ 0 };
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<int64_t> start{ 0 };
+        std::atomic<int64_t> duration{ 0 };
+    };
+
+    struct ThreadBuffer
+    {
+        std::array<EventSlot, Profiler::RING_SIZE> slots;
+        std::atomic<uint64_t> writeCount{ 0 };
+        int threadIdx{};
+    };
+
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    //the buffers are never freed : the events of a finished thread (e.g. a resized job system) stay readable
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+    thread_local ThreadBuffer* localBuffer = nullptr;
+
+    ThreadBuffer& GetLocalBuffer()
+    {
+        if (localBuffer == nullptr) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            threadBuffers.push_back(std::make_unique<ThreadBuffer>());
+            localBuffer = threadBuffers.back().get();
+            localBuffer->threadIdx = static_cast<int>(threadBuffers.size()) - 1;
+        }
+        return *localBuffer;
+    }
+}
+
+int64_t Profiler::Now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Profiler::Record(const char* name, int64_t start, int64_t end){
+    ThreadBuffer& buffer = GetLocalBuffer();
+    const uint64_t count = buffer.writeCount.load(std::memory_order_relaxed);
+    EventSlot& slot = buffer.slots[count % RING_SIZE];
+    slot.sequence.store(2 * count + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);//the odd sequence is visible before any field changes
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(end - start, std::memory_order_relaxed);
+    slot.sequence.store(2 * count + 2, std::memory_order_release);
+    buffer.writeCount.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::Collect(std::vector<ProfileEvent>& events, Cursors& cursors){
+    std::lock_guard<std::mutex> lock(registryMutex);
+    cursors.resize(threadBuffers.size(), 0);
+
+    for (size_t i = 0; i < threadBuffers.size(); ++i) {
+        const ThreadBuffer& buffer = *threadBuffers[i];
+        const uint64_t end = buffer.writeCount.load(std::memory_order_acquire);
+        const uint64_t begin = std::max(cursors[i], end > RING_SIZE ? end - RING_SIZE : 0);
+
+        for (uint64_t j = begin; j < end; ++j) {
+            //the owner may be recording meanwhile : an event overwritten before or while being copied is dropped
+            const EventSlot& slot = buffer.slots[j % RING_SIZE];
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence != 2 * j + 2) {
+                continue;
+            }
+            ProfileEvent event{ slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                slot.duration.load(std::memory_order_relaxed), buffer.threadIdx };
+            std::atomic_thread_fence(std::memory_order_acquire);//the fields are read before the sequence again
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+                events.push_back(event);
+            }
+        }
+        cursors[i] = end;
+    }
+}
+
+bool Profiler::WriteChromeTrace(const std::string& filePath){
+    std::vector<ProfileEvent> events;
+    Cursors cursors;
+    Collect(events, cursors);
+
+    std::ofstream outputFile(filePath);
+    if (!outputFile.is_open()) {
+        return false;
+    }
+    //complete events ("X"), times in microseconds
+    outputFile << std::fixed << std::setprecision(3);
+    outputFile << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const ProfileEvent& event = events[i];
+        outputFile << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.threadIdx
+            << ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}"
+            << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    outputFile << "],\"displayTimeUnit\":\"ms\"}\n";
+    return true;
+}
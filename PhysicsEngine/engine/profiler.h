@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//PROFILE_ZONE("name") times the rest of the scope, PHYSICS_NO_PROFILER compiles the zones out
+#ifndef PHYSICS_NO_PROFILER
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name) physics::ProfileZone PROFILER_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
+
+namespace physics
+{
+    //one closed zone, in ns since the start of the program
+    struct ProfileEvent
+    {
+        const char* name;//a string literal, never copied
+        int64_t start;
+        int64_t duration;
+        int threadIdx;//order in which the threads recorded their first zone
+    };
+
+    //Every thread records its zones into its own ring buffer : no lock, the oldest events get overwritten.
+    //Readers copy the rings, e.g. the GUI panel every frame or the trace export, while the threads may still record :
+    //every slot carries a sequence number, the events rewritten during the copy are dropped rather than torn.
+    class Profiler
+    {
+    public:
+        static constexpr int RING_SIZE = 8192;//events per thread
+
+        typedef std::vector<uint64_t> Cursors;//per thread, number of its events already read
+
+        static int64_t Now();
+        static void Record(const char* name, int64_t start, int64_t end);
+
+        //appends the events recorded after the cursors (those still in the rings), then moves the cursors
+        static void Collect(std::vector<ProfileEvent>& events, Cursors& cursors);
+
+        //Chrome trace_event JSON (chrome://tracing, ui.perfetto.dev) of every event still in the rings
+        static bool WriteChromeTrace(const std::string& filePath);
+    };
+
+    class ProfileZone
+    {
+        const char* name;
+        int64_t start;
+
+    public:
+        explicit ProfileZone(const char* _name) : name{ _name }, start{ Profiler::Now() } {}
+        ~ProfileZone() { Profiler::Record(name, start, Profiler::Now()); }
+
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+    };
+}
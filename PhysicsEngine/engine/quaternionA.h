@@ -0,0 +1,131 @@
+#pragma once
+
+#include "quaternion.h"
+#include "math/vector3a.h"
+
+namespace physics
+{
+    using math::Vector3A;
+
+    //Quaternion in one __m128 (w, x, y, z : the order of Quaternion), inline like Vector3A.
+    //Same results as Quaternion, e.g. for the orientation update of the integration.
+    struct alignas(16) QuaternionA
+    {
+#ifdef MATH_SIMD_SSE
+        __m128 value;
+
+        QuaternionA(float _w = 1.f, float _x = 0.f, float _y = 0.f, float _z = 0.f) : value(_mm_set_ps(_z, _y, _x, _w)) {}
+        explicit QuaternionA(__m128 _value) : value(_value) {}
+        explicit QuaternionA(const Quaternion& quat) : value(_mm_loadu_ps(&quat.w)) {}
+#else
+        float value[4];
+
+        QuaternionA(float _w = 1.f, float _x = 0.f, float _y = 0.f, float _z = 0.f) : value{ _w, _x, _y, _z } {}
+        explicit QuaternionA(const Quaternion& quat) : value{ quat.w, quat.x, quat.y, quat.z } {}
+#endif
+
+        Quaternion ToQuaternion() const;
+
+        void Normalize();
+        QuaternionA RotateByScaledVector(const Vector3A& vec, const float scale) const;
+
+        QuaternionA operator+(const QuaternionA& other) const;
+        void operator+=(const QuaternionA& other) { *this = *this + other; }
+
+        QuaternionA operator*(const QuaternionA& other) const;
+        void operator*=(const QuaternionA& other) { *this = *this * other; }
+
+        QuaternionA operator*(const float scale) const;
+        void operator*=(const float scale) { *this = *this * scale; }
+    };
+
+#ifdef MATH_SIMD_SSE
+    inline Quaternion QuaternionA::ToQuaternion() const {
+        Quaternion result;
+        _mm_storeu_ps(&result.w, value);
+        return result;
+    }
+
+    inline void QuaternionA::Normalize() {
+        //((w*w + x*x) + y*y) + z*z, the order of Quaternion::Normalize()
+        __m128 square = _mm_mul_ps(value, value);
+        __m128 magnitude = _mm_add_ss(square, _mm_shuffle_ps(square, square, _MM_SHUFFLE(1, 1, 1, 1)));
+        magnitude = _mm_add_ss(magnitude, _mm_shuffle_ps(square, square, _MM_SHUFFLE(2, 2, 2, 2)));
+        magnitude = _mm_add_ss(magnitude, _mm_shuffle_ps(square, square, _MM_SHUFFLE(3, 3, 3, 3)));
+        if (_mm_cvtss_f32(magnitude) == 0.0f) {
+            value = _mm_move_ss(value, _mm_set_ss(1.0f));
+            return;
+        }
+        magnitude = _mm_div_ss(_mm_set_ss(1.0f), _mm_sqrt_ss(magnitude));
+        value = _mm_mul_ps(value, _mm_shuffle_ps(magnitude, magnitude, _MM_SHUFFLE(0, 0, 0, 0)));
+    }
+
+    inline QuaternionA QuaternionA::RotateByScaledVector(const Vector3A& vec, const float scale) const {
+        //(x, y, z, -) -> (0, x, y, z)
+        __m128 scaled = _mm_mul_ps(vec.value, _mm_set1_ps(scale));
+        scaled = _mm_shuffle_ps(scaled, scaled, _MM_SHUFFLE(2, 1, 0, 3));
+        return *this * QuaternionA(_mm_move_ss(scaled, _mm_setzero_ps()));
+    }
+
+    inline QuaternionA QuaternionA::operator+(const QuaternionA& other) const {
+        return QuaternionA(_mm_add_ps(value, other.value));
+    }
+
+    //one column of the product per component of this, added in the order of Quaternion::operator*()
+    inline QuaternionA QuaternionA::operator*(const QuaternionA& other) const {
+        const __m128 o = other.value;
+        __m128 result = _mm_mul_ps(_mm_shuffle_ps(value, value, _MM_SHUFFLE(0, 0, 0, 0)), o);//w * ( w,  x,  y,  z)
+
+        __m128 column = _mm_shuffle_ps(o, o, _MM_SHUFFLE(2, 3, 0, 1));//( x, w, z, y)
+        column = _mm_xor_ps(column, _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f));//(-x, w, -z, y)
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 1, 1, 1)), column));
+
+        column = _mm_shuffle_ps(o, o, _MM_SHUFFLE(1, 0, 3, 2));//( y, z, w, x)
+        column = _mm_xor_ps(column, _mm_set_ps(-0.0f, 0.0f, 0.0f, -0.0f));//(-y, z, w, -x)
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 2, 2, 2)), column));
+
+        column = _mm_shuffle_ps(o, o, _MM_SHUFFLE(0, 1, 2, 3));//( z, y, x, w)
+        column = _mm_xor_ps(column, _mm_set_ps(0.0f, 0.0f, -0.0f, -0.0f));//(-z, -y, x, w)
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(value, value, _MM_SHUFFLE(3, 3, 3, 3)), column));
+
+        return QuaternionA(result);
+    }
+
+    inline QuaternionA QuaternionA::operator*(const float scale) const {
+        return QuaternionA(_mm_mul_ps(value, _mm_set1_ps(scale)));
+    }
+#else
+    inline Quaternion QuaternionA::ToQuaternion() const {
+        return Quaternion(value[0], value[1], value[2], value[3]);
+    }
+
+    inline void QuaternionA::Normalize() {
+        Quaternion quat = ToQuaternion();
+        quat.Normalize();
+        *this = QuaternionA(quat);
+    }
+
+    inline QuaternionA QuaternionA::RotateByScaledVector(const Vector3A& vec, const float scale) const {
+        return *this * QuaternionA(0.0f, vec.value[0] * scale, vec.value[1] * scale, vec.value[2] * scale);
+    }
+
+    inline QuaternionA QuaternionA::operator+(const QuaternionA& other) const {
+        return QuaternionA(value[0] + other.value[0], value[1] + other.value[1], value[2] + other.value[2], value[3] + other.value[3]);
+    }
+
+    inline QuaternionA QuaternionA::operator*(const QuaternionA& other) const {
+        const float w = value[0], x = value[1], y = value[2], z = value[3];
+        const float* o = other.value;
+        return QuaternionA(
+            w*o[0] - x*o[1] - y*o[2] - z*o[3],
+            w*o[1] + x*o[0] + y*o[3] - z*o[2],
+            w*o[2] - x*o[3] + y*o[0] + z*o[1],
+            w*o[3] + x*o[2] - y*o[1] + z*o[0]
+        );
+    }
+
+    inline QuaternionA QuaternionA::operator*(const float scale) const {
+        return QuaternionA(value[0] * scale, value[1] * scale, value[2] * scale, value[3] * scale);
+    }
+#endif
+}
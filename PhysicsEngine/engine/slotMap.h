@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>//std::unique_ptr
+#include <new>//placement new
+#include <stdexcept>
+#include <utility>//std::forward
+#include <vector>
+
+namespace physics
+{
+    //index of the slot + generation of the slot when the object was created
+    struct SlotHandle
+    {
+        uint32_t index = 0;
+        uint32_t generation = 0;//0 : never valid
+
+        bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+    };
+
+    //Generational pool : O(1) create/destroy, the slots are reused without going back to the allocator.
+    //Objects never move (they live in fixed blocks), so raw pointers stay valid until Destroy().
+    //A handle of a destroyed object is detected as stale, even if its slot was reused since.
+    //The live objects are also kept in a dense array for the loops over all of them.
+    template<typename T>
+    class SlotMap
+    {
+    public:
+        static constexpr int BLOCK_SIZE = 256;
+
+    private:
+        struct Slot
+        {
+            alignas(T) unsigned char storage[sizeof(T)];//first : a T* is also a Slot*
+            uint32_t index;
+            uint32_t generation;
+            int denseIndex;//-1 while free
+        };
+
+        std::vector<std::unique_ptr<Slot[]>> blocks;
+        std::vector<uint32_t> freeSlots;
+        std::vector<T*> dense;
+
+    public:
+        SlotMap() = default;
+        SlotMap(const SlotMap&) = delete;
+        SlotMap& operator=(const SlotMap&) = delete;
+        ~SlotMap() { Clear(); }
+
+        template<typename... Args>
+        T* Create(Args&&... args);
+        void Destroy(T* object);
+        void Destroy(SlotHandle handle);
+        void Clear();
+
+        //nullptr for a stale handle
+        T* Get(SlotHandle handle) const;
+        SlotHandle GetHandle(const T* object) const;
+        bool IsValid(SlotHandle handle) const { return Get(handle) != nullptr; }
+
+        int GetCount() const { return static_cast<int>(dense.size()); }
+        typename std::vector<T*>::const_iterator begin() const { return dense.begin(); }
+        typename std::vector<T*>::const_iterator end() const { return dense.end(); }
+
+    private:
+        Slot& GetSlot(uint32_t index) const { return blocks[index / BLOCK_SIZE][index % BLOCK_SIZE]; }
+        static Slot& GetSlot(const T* object) { return *reinterpret_cast<Slot*>(const_cast<T*>(object)); }
+    };
+
+    template<typename T>
+    template<typename... Args>
+    inline T* SlotMap<T>::Create(Args&&... args){
+        if (freeSlots.empty()) {
+            const uint32_t firstIndex = static_cast<uint32_t>(blocks.size() * BLOCK_SIZE);
+            blocks.push_back(std::make_unique<Slot[]>(BLOCK_SIZE));
+            for (int i = BLOCK_SIZE - 1; i >= 0; --i) {//lowest index popped first
+                Slot& slot = blocks.back()[i];
+                slot.index = firstIndex + i;
+                slot.generation = 1;
+                slot.denseIndex = -1;
+                freeSlots.push_back(slot.index);
+            }
+        }
+        Slot& slot = GetSlot(freeSlots.back());
+
+        T* object = new (slot.storage) T(std::forward<Args>(args)...);
+        freeSlots.pop_back();
+        slot.denseIndex = static_cast<int>(dense.size());
+        dense.push_back(object);
+        return object;
+    }
+
+    template<typename T>
+    inline void SlotMap<T>::Destroy(T* object){
+        if (object == nullptr) {
+            return;
+        }
+        Slot& slot = GetSlot(object);
+        if (slot.denseIndex < 0) {
+            throw std::runtime_error("SlotMap::Destroy(), object already destroyed");
+        }
+
+        //swap with the last one to keep the dense array packed
+        T* last = dense.back();
+        dense[slot.denseIndex] = last;
+        GetSlot(last).denseIndex = slot.denseIndex;
+        dense.pop_back();
+
+        object->~T();
+        slot.denseIndex = -1;
+        ++slot.generation;
+        if (slot.generation == 0) {//wrapped, 0 is never valid
+            slot.generation = 1;
+        }
+        freeSlots.push_back(slot.index);
+    }
+
+    template<typename T>
+    inline void SlotMap<T>::Destroy(SlotHandle handle){
+        T* object = Get(handle);
+        if (object == nullptr) {
+            throw std::runtime_error("SlotMap::Destroy(), stale handle");
+        }
+        Destroy(object);
+    }
+
+    template<typename T>
+    inline void SlotMap<T>::Clear(){
+        while (dense.empty() == false) {
+            Destroy(dense.back());
+        }
+    }
+
+    template<typename T>
+    inline T* SlotMap<T>::Get(SlotHandle handle) const{
+        if (handle.index >= blocks.size() * BLOCK_SIZE) {
+            return nullptr;
+        }
+        Slot& slot = GetSlot(handle.index);
+        if (slot.denseIndex < 0 || slot.generation != handle.generation) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(slot.storage);
+    }
+
+    template<typename T>
+    inline SlotHandle SlotMap<T>::GetHandle(const T* object) const{
+        const Slot& slot = GetSlot(object);
+        return { slot.index, slot.generation };
+    }
+}
@@ -0,0 +1,242 @@
+#include "softContactSolver.h"
+#include "math/mathConstants.h"//PI
+#include <algorithm>//std::max, std::min, std::clamp
+#include <cmath>//std::isfinite
+
+using namespace physics;
+
+namespace
+{
+    bool IsFinite(const Vector3& vec) {
+        return std::isfinite(vec.x) && std::isfinite(vec.y) && std::isfinite(vec.z);
+    }
+}
+
+void SoftContactSolver::Prepare(const std::vector<CollisionManifold>& contacts, float substep, float penetrationTolerance){
+    inverseSubstep = 1.0f / substep;
+
+    //a damped spring integrated implicitly over one substep (Box2D's b2MakeSoft),
+    //it can't be stiffer than what the substeps are able to follow
+    const float hertz = std::min(settings.contactHertz, 0.25f * inverseSubstep);
+    const float omega = 2.0f * math::PI * hertz;
+    const float a1 = 2.0f * settings.dampingRatio + substep * omega;
+    const float a2 = substep * omega * a1;
+    const float a3 = 1.0f / (1.0f + a2);
+    softness = { omega / a1, a2 * a3, a3 };
+
+    manifolds.clear();
+    for (int contactIdx = 0; contactIdx < static_cast<int>(contacts.size()); ++contactIdx) {
+        const CollisionManifold& contact = contacts[contactIdx];
+        SoftManifold manifold;
+        manifold.contactIdx = contactIdx;
+        manifold.bodies[0] = contact.bodies[0];
+        manifold.bodies[1] = contact.bodies[1];
+        manifold.inverseMasses[0] = contact.bodies[0]->GetInverseMass();
+        manifold.inverseMasses[1] = contact.bodies[1] ? contact.bodies[1]->GetInverseMass() : 0.0f;
+        const float inverseMassSum = manifold.inverseMasses[0] + manifold.inverseMasses[1];
+
+        //degenerate (e.g. concentric spheres, no normal) or between fixed bodies : never solved
+        manifold.directions[0] = contact.collisionNormal;
+        contact.CalcTangents(manifold.directions[1], manifold.directions[2]);
+        if (inverseMassSum == 0.0f || IsFinite(manifold.directions[0]) == false || IsFinite(manifold.directions[1]) == false) {
+            continue;
+        }
+        manifold.inverseInertias[0] = contact.bodies[0]->GetInverseInertiaTensorWorld();
+        manifold.inverseInertias[1] = contact.bodies[1] ? contact.bodies[1]->GetInverseInertiaTensorWorld() : Matrix3(0.0f);
+        manifold.friction = contact.friction;
+        manifold.restitution = contact.restitution;
+        manifold.pointCount = 0;
+
+        Vector3 velocities[2], angularVelocities[2];
+        LoadVelocities(manifold, velocities, angularVelocities);
+        //Extract3x3Matrix() stores the columns as rows : it already is the inverse rotation
+        const Matrix3 worldToLocal1 = contact.bodies[0]->GetLocalToWorldMatrix().Extract3x3Matrix();
+        const Matrix3 worldToLocal2 = contact.bodies[1] ? contact.bodies[1]->GetLocalToWorldMatrix().Extract3x3Matrix() : Matrix3(0.0f);
+
+        for (int i = 0; i < contact.pointCount; ++i) {
+            const ManifoldPoint& contactPoint = contact.points[i];
+            SoftPoint& point = manifold.points[manifold.pointCount];
+
+            contact.CalcContactArms(contactPoint, point.r1, point.r2);
+            if (contact.bodies[1] == nullptr) {
+                point.r2 = Vector3();
+            }
+            if (IsFinite(point.r1) == false || IsFinite(point.r2) == false) {
+                continue;
+            }
+            point.anchor1 = contact.bodies[0]->GetPosition() + point.r1;
+            point.localAnchor1 = worldToLocal1 * point.r1;
+            if (contact.bodies[1]) {
+                point.anchor2 = contact.bodies[1]->GetPosition() + point.r2;
+                point.localAnchor2 = worldToLocal2 * point.r2;
+            }
+            point.separation = penetrationTolerance - contactPoint.penetrationDepth;
+
+            for (int dir = 0; dir < 3; ++dir) {
+                const Vector3& direction = manifold.directions[dir];
+                Vector3 inertia1 = manifold.inverseInertias[0] * point.r1.Cross(direction);
+                Vector3 inertia2 = manifold.inverseInertias[1] * point.r2.Cross(direction);
+                float effectiveMass = inverseMassSum + (inertia1.Cross(point.r1) + inertia2.Cross(point.r2)).Dot(direction);
+                float mass = effectiveMass == 0.0f ? 0.0f : 1.0f / effectiveMass;
+                if (dir == 0) {
+                    point.normalMass = mass;
+                }
+                else {
+                    point.tangentMass[dir - 1] = mass;
+                }
+            }
+
+            point.relativeVelocity = GetRelativeSpeed(point, manifold.directions[0], velocities, angularVelocities);
+            point.maxNormalImpulse = 0.0f;
+            point.normalImpulse = contactPoint.accumulatedNormalImpulse;
+            point.tangentImpulse[0] = contactPoint.accumulatedTangentImpulse[0];
+            point.tangentImpulse[1] = contactPoint.accumulatedTangentImpulse[1];
+            point.pointIdx = i;
+            ++manifold.pointCount;
+        }
+        manifolds.push_back(manifold);
+    }
+}
+
+void SoftContactSolver::WarmStart(){
+    for (const SoftManifold& manifold : manifolds) {
+        Vector3 velocities[2], angularVelocities[2];
+        LoadVelocities(manifold, velocities, angularVelocities);
+        for (int i = 0; i < manifold.pointCount; ++i) {
+            const SoftPoint& point = manifold.points[i];
+            ApplyImpulse(manifold, point, manifold.directions[0], point.normalImpulse, velocities, angularVelocities);
+            ApplyImpulse(manifold, point, manifold.directions[1], point.tangentImpulse[0], velocities, angularVelocities);
+            ApplyImpulse(manifold, point, manifold.directions[2], point.tangentImpulse[1], velocities, angularVelocities);
+        }
+        StoreVelocities(manifold, velocities, angularVelocities);
+    }
+}
+
+float SoftContactSolver::Solve(bool useBias){
+    float maxImpulseChange = 0.0f;
+    for (SoftManifold& manifold : manifolds) {
+        Vector3 velocities[2], angularVelocities[2];
+        LoadVelocities(manifold, velocities, angularVelocities);
+        const Vector3& normal = manifold.directions[0];
+        const Matrix4 localToWorld1 = manifold.bodies[0]->GetLocalToWorldMatrix();
+        const Matrix4 localToWorld2 = manifold.bodies[1] ? manifold.bodies[1]->GetLocalToWorldMatrix() : Matrix4();
+
+        for (int i = 0; i < manifold.pointCount; ++i) {
+            SoftPoint& point = manifold.points[i];
+
+            //the current separation : the anchors moved with the bodies since Prepare()
+            Vector3 displacement = localToWorld1 * point.localAnchor1 - point.anchor1;
+            if (manifold.bodies[1]) {
+                displacement -= localToWorld2 * point.localAnchor2 - point.anchor2;
+            }
+            const float separation = point.separation + displacement.Dot(normal);
+
+            float bias = 0.0f;
+            float massScale = 1.0f;
+            float impulseScale = 0.0f;
+            if (separation > 0.0f) {
+                bias = separation * inverseSubstep;//speculative : only what closes the gap within the substep
+            }
+            else if (useBias) {
+                bias = std::max(softness.biasRate * separation, -settings.maxPushVelocity);
+                massScale = softness.massScale;
+                impulseScale = softness.impulseScale;
+            }
+
+            float relativeSpeed = GetRelativeSpeed(point, normal, velocities, angularVelocities);
+            float impulse = -point.normalMass * massScale * (relativeSpeed + bias) - impulseScale * point.normalImpulse;
+            float newImpulse = std::max(point.normalImpulse + impulse, 0.0f);
+            impulse = newImpulse - point.normalImpulse;
+            point.normalImpulse = newImpulse;
+            point.maxNormalImpulse = std::max(point.maxNormalImpulse, impulse);
+            maxImpulseChange = std::max(maxImpulseChange, std::abs(impulse));
+            ApplyImpulse(manifold, point, normal, impulse, velocities, angularVelocities);
+
+            //Coulomb's law, bounded by the normal impulse of this substep
+            const float maxFriction = manifold.friction * point.normalImpulse;
+            for (int tangentIdx = 0; tangentIdx < 2; ++tangentIdx) {
+                const Vector3& tangent = manifold.directions[tangentIdx + 1];
+                float tangentImpulse = -point.tangentMass[tangentIdx] * GetRelativeSpeed(point, tangent, velocities, angularVelocities);
+                float newTangentImpulse = std::clamp(point.tangentImpulse[tangentIdx] + tangentImpulse, -maxFriction, maxFriction);
+                tangentImpulse = newTangentImpulse - point.tangentImpulse[tangentIdx];
+                point.tangentImpulse[tangentIdx] = newTangentImpulse;
+                maxImpulseChange = std::max(maxImpulseChange, std::abs(tangentImpulse));
+                ApplyImpulse(manifold, point, tangent, tangentImpulse, velocities, angularVelocities);
+            }
+        }
+        StoreVelocities(manifold, velocities, angularVelocities);
+    }
+    return maxImpulseChange;
+}
+
+void SoftContactSolver::ApplyRestitution(){
+    for (SoftManifold& manifold : manifolds) {
+        if (manifold.restitution == 0.0f) {
+            continue;
+        }
+        Vector3 velocities[2], angularVelocities[2];
+        LoadVelocities(manifold, velocities, angularVelocities);
+        const Vector3& normal = manifold.directions[0];
+
+        for (int i = 0; i < manifold.pointCount; ++i) {
+            SoftPoint& point = manifold.points[i];
+            if (point.relativeVelocity > -settings.restitutionThreshold || point.maxNormalImpulse == 0.0f) {
+                continue;
+            }
+            float relativeSpeed = GetRelativeSpeed(point, normal, velocities, angularVelocities);
+            float impulse = -point.normalMass * (relativeSpeed + manifold.restitution * point.relativeVelocity);
+            float newImpulse = std::max(point.normalImpulse + impulse, 0.0f);
+            impulse = newImpulse - point.normalImpulse;
+            point.normalImpulse = newImpulse;
+            ApplyImpulse(manifold, point, normal, impulse, velocities, angularVelocities);
+        }
+        StoreVelocities(manifold, velocities, angularVelocities);
+    }
+}
+
+void SoftContactSolver::Finish(std::vector<CollisionManifold>& contacts) const{
+    for (const SoftManifold& manifold : manifolds) {
+        CollisionManifold& contact = contacts[manifold.contactIdx];
+        for (int i = 0; i < manifold.pointCount; ++i) {
+            const SoftPoint& point = manifold.points[i];
+            ManifoldPoint& contactPoint = contact.points[point.pointIdx];
+            contactPoint.accumulatedNormalImpulse = point.normalImpulse;
+            contactPoint.accumulatedTangentImpulse[0] = point.tangentImpulse[0];
+            contactPoint.accumulatedTangentImpulse[1] = point.tangentImpulse[1];
+        }
+    }
+}
+
+void SoftContactSolver::ApplyImpulse(const SoftManifold& manifold, const SoftPoint& point, const Vector3& direction, float impulse,
+    Vector3 (&velocities)[2], Vector3 (&angularVelocities)[2]) const
+{
+    velocities[0] += direction * (impulse * manifold.inverseMasses[0]);
+    angularVelocities[0] += manifold.inverseInertias[0] * (point.r1.Cross(direction) * impulse);
+    velocities[1] -= direction * (impulse * manifold.inverseMasses[1]);
+    angularVelocities[1] -= manifold.inverseInertias[1] * (point.r2.Cross(direction) * impulse);
+}
+
+float SoftContactSolver::GetRelativeSpeed(const SoftPoint& point, const Vector3& direction,
+    const Vector3 (&velocities)[2], const Vector3 (&angularVelocities)[2]) const
+{
+    Vector3 relativeVel = velocities[0] + angularVelocities[0].Cross(point.r1) - (velocities[1] + angularVelocities[1].Cross(point.r2));
+    return relativeVel.Dot(direction);
+}
+
+void SoftContactSolver::LoadVelocities(const SoftManifold& manifold, Vector3 (&velocities)[2], Vector3 (&angularVelocities)[2]) const{
+    for (int i = 0; i < 2; ++i) {
+        velocities[i] = manifold.bodies[i] ? manifold.bodies[i]->GetLinearVelocity() : Vector3();
+        angularVelocities[i] = manifold.bodies[i] ? manifold.bodies[i]->GetAngularVelocity() : Vector3();
+    }
+}
+
+//fixed bodies are never written
+void SoftContactSolver::StoreVelocities(const SoftManifold& manifold, const Vector3 (&velocities)[2], const Vector3 (&angularVelocities)[2]) const{
+    for (int i = 0; i < 2; ++i) {
+        if (manifold.bodies[i] == nullptr || manifold.inverseMasses[i] == 0.0f) {
+            continue;
+        }
+        manifold.bodies[i]->SetLinearVelocity(velocities[i]);
+        manifold.bodies[i]->SetAngularVelocity(angularVelocities[i]);
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "contact.h"
+#include <vector>
+
+namespace physics
+{
+    //SolverMode::SOFT_SUBSTEPS : a contact spring replaces the Baumgarte bias (CORRECTION_RATIO),
+    //penetrationTolerance stays the overlap left alone
+    struct SoftContactSettings
+    {
+        int substepCount{ 4 };
+        float contactHertz{ 30.0f };//stiffness of the contact spring, capped to a quarter of the substep rate
+        float dampingRatio{ 10.0f };//overdamped : the overlap is pushed out without bouncing
+        float maxPushVelocity{ 3.0f };//m/s, the fastest an overlap is pushed out
+        float restitutionThreshold{ 1.0f };//m/s, slower approaching contacts don't bounce
+    };
+
+    //Temporal Gauss-Seidel with soft contacts (Box2D v3 "soft step"), driven by PhysicsWorld::SolveSubsteps().
+    //The contact data (arms, effective masses, anchors) is prepared once per step, then every substep
+    //warm starts, solves once with the soft bias, lets the positions move and relaxes once without the bias,
+    //which takes out the velocity the bias added. The separation follows the bodies through the substeps.
+    class SoftContactSolver
+    {
+    private:
+        struct SoftPoint
+        {
+            Vector3 r1, r2;//arms, fixed over the step
+            Vector3 anchor1, anchor2;//world contact points at Prepare()
+            Vector3 localAnchor1, localAnchor2;//the same in the bodies' local spaces
+            float separation;//at Prepare(), minus the penetration tolerance : negative while too deep
+            float normalMass;
+            float tangentMass[2];
+            float relativeVelocity;//normal, at Prepare(), for the restitution
+            float maxNormalImpulse;
+            float normalImpulse;
+            float tangentImpulse[2];
+            int pointIdx;//in the manifold's points
+        };
+
+        struct SoftManifold
+        {
+            int contactIdx;
+            RigidBody* bodies[2];
+            float inverseMasses[2];
+            Matrix3 inverseInertias[2];
+            Vector3 directions[3];//normal, tangents
+            float friction;
+            float restitution;
+            SoftPoint points[CollisionManifold::MAX_POINTS];
+            int pointCount;
+        };
+
+        //the contact spring, see Prepare()
+        struct Softness
+        {
+            float biasRate;
+            float massScale;
+            float impulseScale;
+        };
+
+        SoftContactSettings settings;
+        std::vector<SoftManifold> manifolds;
+        Softness softness;
+        float inverseSubstep;
+
+    public:
+        SoftContactSolver() : softness{}, inverseSubstep{} {}
+
+        void SetSettings(const SoftContactSettings& _settings) { settings = _settings; }
+        const SoftContactSettings& GetSettings() const { return settings; }
+
+        //the manifolds' accumulated impulses are the warm starting guess (0 without warm starting)
+        void Prepare(const std::vector<CollisionManifold>& contacts, float substep, float penetrationTolerance);
+
+        //applies the accumulated impulses again : gravity was integrated into the velocities since
+        void WarmStart();
+        //one pass, useBias false is the relax pass. Returns the largest impulse change
+        float Solve(bool useBias);
+        //once after the substeps, from the approaching velocities of Prepare()
+        void ApplyRestitution();
+
+        //writes the impulses back to the manifold points, for the contact cache
+        void Finish(std::vector<CollisionManifold>& contacts) const;
+
+    private:
+        void ApplyImpulse(const SoftManifold& manifold, const SoftPoint& point, const Vector3& direction, float impulse,
+            Vector3 (&velocities)[2], Vector3 (&angularVelocities)[2]) const;
+        float GetRelativeSpeed(const SoftPoint& point, const Vector3& direction,
+            const Vector3 (&velocities)[2], const Vector3 (&angularVelocities)[2]) const;
+        void LoadVelocities(const SoftManifold& manifold, Vector3 (&velocities)[2], Vector3 (&angularVelocities)[2]) const;
+        void StoreVelocities(const SoftManifold& manifold, const Vector3 (&velocities)[2], const Vector3 (&angularVelocities)[2]) const;
+    };
+}
@@ -0,0 +1,170 @@
+#include "spatialHashGrid.h"
+#include <algorithm>//std::nth_element, std::max
+#include <cmath>//std::floor
+
+using namespace physics;
+
+void SpatialHashGrid::AddObject(RigidObject* obj){
+    if (proxyIndices.find(obj) != proxyIndices.end()) {
+        return;
+    }
+    proxyIndices[obj] = static_cast<unsigned>(proxies.size());
+    proxies.push_back({ obj, obj->GetCollider()->ComputeAABB(), nextOrder++ });
+}
+
+void SpatialHashGrid::RemoveObject(RigidObject* obj){
+    auto itr = proxyIndices.find(obj);
+    if (itr == proxyIndices.end()) {
+        return;
+    }
+    unsigned idx = itr->second;
+    proxyIndices.erase(itr);
+
+    //swap with the last one, the table is rebuilt every step anyway
+    if (idx + 1 != proxies.size()) {
+        proxies[idx] = proxies.back();
+        proxyIndices[proxies[idx].object] = idx;
+    }
+    proxies.pop_back();
+}
+
+void SpatialHashGrid::ComputePairs(std::vector<ObjectPair>& pairs){
+    pairs.clear();
+
+    for (Proxy& proxy : proxies) {
+        proxy.bounds = proxy.object->GetCollider()->ComputeAABB();
+    }
+    UpdateCellSize();
+    BuildTable();
+
+    const unsigned bucketCount = static_cast<unsigned>(bucketStarts.size()) - 1;
+    for (unsigned bucket = 0; bucket < bucketCount; ++bucket) {
+        const unsigned begin = bucketStarts[bucket];
+        const unsigned end = bucketStarts[bucket + 1];
+
+        for (unsigned i = begin; i < end; ++i) {
+            const CellEntry& entry1 = cellEntries[i];
+            const Proxy& proxy1 = proxies[entry1.proxyIdx];
+
+            for (unsigned j = i + 1; j < end; ++j) {
+                const CellEntry& entry2 = cellEntries[j];
+                if (entry1.x != entry2.x || entry1.y != entry2.y || entry1.z != entry2.z) {//hash collision
+                    continue;
+                }
+
+                const Proxy& proxy2 = proxies[entry2.proxyIdx];
+                if (proxy1.bounds.Overlaps(proxy2.bounds) == false) {
+                    continue;
+                }
+
+                //two objects can share several cells, the pair is only reported by the cell
+                //holding the min corner of their overlap
+                if (ToCell(std::max(proxy1.bounds.min.x, proxy2.bounds.min.x)) != entry1.x
+                    || ToCell(std::max(proxy1.bounds.min.y, proxy2.bounds.min.y)) != entry1.y
+                    || ToCell(std::max(proxy1.bounds.min.z, proxy2.bounds.min.z)) != entry1.z) {
+                    continue;
+                }
+
+                if (proxy1.order < proxy2.order) {
+                    pairs.emplace_back(proxy1.object, proxy2.object);
+                }
+                else {
+                    pairs.emplace_back(proxy2.object, proxy1.object);
+                }
+            }
+        }
+    }
+}
+
+void SpatialHashGrid::UpdateCellSize(){
+    constexpr float MIN_CELL_SIZE = 0.01f;
+
+    if (requestedCellSize > 0.0f) {
+        cellSize = requestedCellSize;
+        return;
+    }
+    if (proxies.empty()) {
+        return;
+    }
+
+    //median of the largest AABB dimension, O(n) with nth_element
+    sizeScratch.clear();
+    for (const Proxy& proxy : proxies) {
+        Vector3 size = proxy.bounds.max - proxy.bounds.min;
+        sizeScratch.push_back(std::max(size.x, std::max(size.y, size.z)));
+    }
+    auto median = sizeScratch.begin() + sizeScratch.size() / 2;
+    std::nth_element(sizeScratch.begin(), median, sizeScratch.end());
+    cellSize = std::max(*median, MIN_CELL_SIZE);
+}
+
+void SpatialHashGrid::BuildTable(){
+    //1. one entry per (object, overlapped cell)
+    unsortedEntries.clear();
+    for (unsigned idx = 0; idx < proxies.size(); ++idx) {
+        const AABB& bounds = proxies[idx].bounds;
+        const int minX = ToCell(bounds.min.x), maxX = ToCell(bounds.max.x);
+        const int minY = ToCell(bounds.min.y), maxY = ToCell(bounds.max.y);
+        const int minZ = ToCell(bounds.min.z), maxZ = ToCell(bounds.max.z);
+
+        for (int x = minX; x <= maxX; ++x) {
+            for (int y = minY; y <= maxY; ++y) {
+                for (int z = minZ; z <= maxZ; ++z) {
+                    unsortedEntries.push_back({ x, y, z, idx });
+                }
+            }
+        }
+    }
+
+    //2. counting sort into the buckets, table size : power of two, about half occupied
+    unsigned bucketCount = 64;
+    while (bucketCount < 2 * unsortedEntries.size()) {
+        bucketCount <<= 1;
+    }
+    bucketStarts.assign(bucketCount + 1, 0);
+    for (const CellEntry& entry : unsortedEntries) {
+        ++bucketStarts[HashCell(entry.x, entry.y, entry.z) & (bucketCount - 1)];
+    }
+
+    stats = GridStats{};
+    stats.cellSize = cellSize;
+    stats.objectCount = static_cast<unsigned>(proxies.size());
+    stats.cellEntries = static_cast<unsigned>(unsortedEntries.size());
+
+    unsigned start = 0;
+    for (unsigned bucket = 0; bucket < bucketCount; ++bucket) {
+        unsigned count = bucketStarts[bucket];
+        if (count > 0) {
+            ++stats.occupiedBuckets;
+            stats.maxEntriesPerBucket = std::max(stats.maxEntriesPerBucket, count);
+        }
+        bucketStarts[bucket] = start;
+        start += count;
+    }
+    bucketStarts[bucketCount] = start;
+    if (stats.occupiedBuckets > 0) {
+        stats.averageEntriesPerBucket = static_cast<float>(stats.cellEntries) / stats.occupiedBuckets;
+    }
+
+    //bucketStarts[b] is used as the write cursor and ends up at the start of b+1, shifted back afterwards
+    cellEntries.resize(unsortedEntries.size());
+    for (const CellEntry& entry : unsortedEntries) {
+        unsigned bucket = HashCell(entry.x, entry.y, entry.z) & (bucketCount - 1);
+        cellEntries[bucketStarts[bucket]++] = entry;
+    }
+    for (unsigned bucket = bucketCount; bucket > 0; --bucket) {
+        bucketStarts[bucket] = bucketStarts[bucket - 1];
+    }
+    bucketStarts[0] = 0;
+}
+
+//Teschner et al. 2003, "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+unsigned SpatialHashGrid::HashCell(int x, int y, int z) const{
+    return (static_cast<unsigned>(x) * 73856093u)
+        ^ (static_cast<unsigned>(y) * 19349663u)
+        ^ (static_cast<unsigned>(z) * 83492791u);
+}
+
+int SpatialHashGrid::ToCell(float coord) const{
+    return static_cast<int>(std::floor(coord / cellSize));
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "broadPhase.h"
+#include "aabb.h"
+#include <unordered_map>
+#include <vector>
+
+namespace physics
+{
+    struct GridStats
+    {
+        float cellSize;
+        unsigned objectCount;
+        unsigned cellEntries;//(object, cell) pairs, an object overlapping 8 cells counts 8 times
+        unsigned occupiedBuckets;
+        unsigned maxEntriesPerBucket;
+        float averageEntriesPerBucket;//over the occupied buckets
+
+        GridStats() : cellSize{}, objectCount{}, cellEntries{}, occupiedBuckets{}, maxEntriesPerBucket{}, averageEntriesPerBucket{} {}
+    };
+
+    //Uniform grid hashed into a flat table, rebuilt from scratch every step with a counting sort.
+    //Works best when the objects have similar sizes (e.g. what SphereBoxSpawner throws out).
+    //With AUTO_CELL_SIZE the cell edge follows the median of the largest AABB dimension.
+    class SpatialHashGrid : public BroadPhase
+    {
+    public:
+        static constexpr float AUTO_CELL_SIZE = 0.0f;
+
+    private:
+        struct Proxy
+        {
+            RigidObject* object;
+            AABB bounds;
+            unsigned order;//registration order
+        };
+
+        struct CellEntry
+        {
+            int x, y, z;//cell coordinates, to tell cells sharing a bucket apart
+            unsigned proxyIdx;
+        };
+
+        std::vector<Proxy> proxies;//dense
+        std::unordered_map<RigidObject*, unsigned> proxyIndices;
+        unsigned nextOrder;
+
+        float requestedCellSize;
+        float cellSize;
+
+        //bucket b owns cellEntries[bucketStarts[b], bucketStarts[b+1])
+        std::vector<unsigned> bucketStarts;
+        std::vector<CellEntry> cellEntries;
+        std::vector<CellEntry> unsortedEntries;
+        std::vector<float> sizeScratch;
+
+        GridStats stats;
+
+    public:
+        SpatialHashGrid(float _cellSize = AUTO_CELL_SIZE)
+            : nextOrder{}, requestedCellSize{ _cellSize }, cellSize{ 1.0f } {}
+
+        BroadPhaseType GetType() const override { return BroadPhaseType::SPATIAL_HASH_GRID; }
+
+        void AddObject(RigidObject* obj) override;
+        void RemoveObject(RigidObject* obj) override;
+        void ComputePairs(std::vector<ObjectPair>& pairs) override;
+
+        void SetCellSize(float value) { requestedCellSize = value; }//AUTO_CELL_SIZE : derived every step
+        float GetCellSize() const { return cellSize; }
+        const GridStats& GetStats() const { return stats; }
+
+    private:
+        void UpdateCellSize();
+        void BuildTable();
+        unsigned HashCell(int x, int y, int z) const;
+        int ToCell(float coord) const;
+    };
+}
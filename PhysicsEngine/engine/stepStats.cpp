@@ -0,0 +1,96 @@
+#include "stepStats.h"
+#include <atomic>
+
+using namespace physics;
+
+namespace
+{
+    std::atomic<uint64_t> heapAllocationCount{ 0 };
+}
+
+void physics::CountHeapAllocation(){
+    heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t physics::GetHeapAllocationCount(){
+    return heapAllocationCount.load(std::memory_order_relaxed);
+}
+
+const char* physics::GetShapePairName(ShapePairType type){
+    switch (type) {
+    case ShapePairType::SPHERE_SPHERE:
+        return "sphere-sphere";
+    case ShapePairType::BOX_SPHERE:
+        return "box-sphere";
+    case ShapePairType::BOX_BOX:
+        return "box-box";
+    case ShapePairType::SPHERE_PLANE:
+        return "sphere-plane";
+    case ShapePairType::BOX_PLANE:
+        return "box-plane";
+    case ShapePairType::CAPSULE_CAPSULE:
+        return "capsule-capsule";
+    case ShapePairType::CAPSULE_SPHERE:
+        return "capsule-sphere";
+    case ShapePairType::BOX_CAPSULE:
+        return "box-capsule";
+    case ShapePairType::CAPSULE_PLANE:
+        return "capsule-plane";
+    case ShapePairType::HULL_PLANE:
+        return "hull-plane";
+    case ShapePairType::CONVEX_CONVEX:
+        return "convex-convex";
+    case ShapePairType::CONVEX_PLANE:
+        return "convex-plane";
+    default:
+        return "unknown";
+    }
+}
+
+int StepStats::GetNarrowPhaseTestCount() const{
+    int count{};
+    for (int tests : narrowPhaseTests) {
+        count += tests;
+    }
+    return count;
+}
+
+StepStats& StepStats::operator+=(const StepStats& rhs){
+    candidatePairs += rhs.candidatePairs;
+    for (int i = 0; i < SHAPE_PAIR_TYPE_COUNT; ++i) {
+        narrowPhaseTests[i] += rhs.narrowPhaseTests[i];
+    }
+    manifolds += rhs.manifolds;
+    contactPoints += rhs.contactPoints;
+    solverIterations += rhs.solverIterations;
+    solvedIslands += rhs.solvedIslands;
+    islandIterations += rhs.islandIterations;
+    bodiesIntegrated += rhs.bodiesIntegrated;
+    heapAllocations += rhs.heapAllocations;
+    return *this;
+}
+
+StepStats& StepStats::operator-=(const StepStats& rhs){
+    candidatePairs -= rhs.candidatePairs;
+    for (int i = 0; i < SHAPE_PAIR_TYPE_COUNT; ++i) {
+        narrowPhaseTests[i] -= rhs.narrowPhaseTests[i];
+    }
+    manifolds -= rhs.manifolds;
+    contactPoints -= rhs.contactPoints;
+    solverIterations -= rhs.solverIterations;
+    solvedIslands -= rhs.solvedIslands;
+    islandIterations -= rhs.islandIterations;
+    bodiesIntegrated -= rhs.bodiesIntegrated;
+    heapAllocations -= rhs.heapAllocations;
+    return *this;
+}
+
+void StepStatsWindow::Add(const StepStats& stats){
+    StepStats& slot = steps[addedCount % SIZE];
+    if (addedCount >= SIZE) {
+        sum -= slot;//leaves the window
+    }
+    slot = stats;
+    sum += stats;
+    ++addedCount;
+}
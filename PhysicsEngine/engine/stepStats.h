@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace physics
+{
+    //narrow phase test kinds, the order of the shapes follows the FindCollisionFeatures overloads
+    enum class ShapePairType
+    {
+        SPHERE_SPHERE,
+        BOX_SPHERE,
+        BOX_BOX,
+        SPHERE_PLANE,
+        BOX_PLANE,
+        CAPSULE_CAPSULE,
+        CAPSULE_SPHERE,
+        BOX_CAPSULE,
+        CAPSULE_PLANE,
+        HULL_PLANE,
+        CONVEX_CONVEX,//GJK/EPA, the pairs without an analytic test
+        CONVEX_PLANE,//support point, the shapes without an analytic plane test
+        COUNT
+    };
+    constexpr int SHAPE_PAIR_TYPE_COUNT = static_cast<int>(ShapePairType::COUNT);
+
+    const char* GetShapePairName(ShapePairType type);//e.g. "box-sphere"
+
+    //what one Simulate() did, see PhysicsWorld::GetStepStats()
+    struct StepStats
+    {
+        int candidatePairs{};//broad phase output
+        std::array<int, SHAPE_PAIR_TYPE_COUNT> narrowPhaseTests{};//pairs of sleeping bodies are not tested
+        int manifolds{};
+        int contactPoints{};
+        int solverIterations{};//of the slowest island to converge, the substeps with SOFT_SUBSTEPS
+        int solvedIslands{};//solved on their own, the colored solvers (GRAPH_COLORED, SIMD_BATCHES) and SOFT_SUBSTEPS count as one
+        int islandIterations{};//summed over the solved islands
+        int bodiesIntegrated{};//awake and movable
+        int heapAllocations{};//operator new calls during the step, on every thread (0 without allocationCounter.cpp)
+
+        int GetNarrowPhaseTestCount() const;
+
+        StepStats& operator+=(const StepStats& rhs);
+        StepStats& operator-=(const StepStats& rhs);
+    };
+
+    //the stats of the last SIZE steps, summed up as they come
+    class StepStatsWindow
+    {
+    public:
+        static constexpr int SIZE = 60;//steps, one second at the default time step
+
+    private:
+        std::array<StepStats, SIZE> steps{};
+        StepStats sum;
+        int addedCount{};
+
+    public:
+        void Add(const StepStats& stats);
+
+        const StepStats& GetLast() const { return steps[(addedCount + SIZE - 1) % SIZE]; }
+        const StepStats& GetSum() const { return sum; }
+        int GetStepCount() const { return addedCount < SIZE ? addedCount : SIZE; }//in the sum
+    };
+
+    //operator new calls since the start of the program. The library doesn't replace the host's allocator :
+    //a program that wants the count compiles engine/allocationCounter.cpp in, whose operator new calls CountHeapAllocation()
+    void CountHeapAllocation();
+    uint64_t GetHeapAllocationCount();
+}
@@ -0,0 +1,135 @@
+#include "sweepAndPrune.h"
+#include <algorithm>//std::sort, std::remove_if
+#include <stdexcept>
+
+using namespace physics;
+
+void SweepAndPrune::AddObject(RigidObject* obj){
+    if (proxyIndices.find(obj) != proxyIndices.end()) {
+        return;
+    }
+
+    unsigned idx;
+    if (freeProxies.empty() == false) {
+        idx = freeProxies.back();
+        freeProxies.pop_back();
+    }
+    else {
+        idx = static_cast<unsigned>(proxies.size());
+        proxies.emplace_back();
+    }
+
+    Proxy& proxy = proxies[idx];
+    proxy.object = obj;
+    proxy.bounds = obj->GetCollider()->ComputeAABB();
+    proxy.order = nextOrder++;
+    proxyIndices[obj] = idx;
+
+    //appended unsorted, the next ComputePairs() moves them into place
+    endpoints.push_back({ proxy.bounds.min[sortAxis], idx, true });
+    endpoints.push_back({ proxy.bounds.max[sortAxis], idx, false });
+    ++pendingInsertions;
+}
+
+void SweepAndPrune::RemoveObject(RigidObject* obj){
+    auto itr = proxyIndices.find(obj);
+    if (itr == proxyIndices.end()) {
+        return;
+    }
+    unsigned idx = itr->second;
+    proxyIndices.erase(itr);
+
+    //erasing keeps the remaining endpoints sorted
+    endpoints.erase(
+        std::remove_if(endpoints.begin(), endpoints.end(), [idx](const Endpoint& e) { return e.proxyIdx == idx; }),
+        endpoints.end()
+    );
+
+    proxies[idx].object = nullptr;
+    freeProxies.push_back(idx);
+}
+
+void SweepAndPrune::ComputePairs(std::vector<ObjectPair>& pairs){
+    pairs.clear();
+
+    UpdateEndpoints();
+    SortEndpoints();
+
+    //sweep: every interval that opens while another one is still open overlaps it on the sort axis
+    activeProxies.clear();
+    for (const Endpoint& endpoint : endpoints) {
+        if (endpoint.isMin == false) {
+            auto itr = std::find(activeProxies.begin(), activeProxies.end(), endpoint.proxyIdx);
+            *itr = activeProxies.back();
+            activeProxies.pop_back();
+            continue;
+        }
+
+        const Proxy& proxy = proxies[endpoint.proxyIdx];
+        for (unsigned otherIdx : activeProxies) {
+            const Proxy& other = proxies[otherIdx];
+            if (proxy.bounds.Overlaps(other.bounds) == false) {//remaining two axes
+                continue;
+            }
+            if (proxy.order < other.order) {
+                pairs.emplace_back(proxy.object, other.object);
+            }
+            else {
+                pairs.emplace_back(other.object, proxy.object);
+            }
+        }
+        activeProxies.push_back(endpoint.proxyIdx);
+    }
+}
+
+void SweepAndPrune::SetSortAxis(int axis){
+    if (axis < 0 || axis > 2) {
+        throw std::runtime_error("SweepAndPrune::SetSortAxis(), axis out of bounds");
+    }
+    sortAxis = axis;
+    pendingInsertions = FULL_SORT_THRESHOLD;//the old order is useless on a new axis
+}
+
+//ties : 'min' endpoints first so that touching intervals are reported, then registration order
+bool SweepAndPrune::IsLess(const Endpoint& lhs, const Endpoint& rhs) const{
+    if (lhs.value != rhs.value) {
+        return lhs.value < rhs.value;
+    }
+    if (lhs.isMin != rhs.isMin) {
+        return lhs.isMin;
+    }
+    return proxies[lhs.proxyIdx].order < proxies[rhs.proxyIdx].order;
+}
+
+void SweepAndPrune::UpdateEndpoints(){
+    for (Proxy& proxy : proxies) {
+        if (proxy.object != nullptr) {
+            proxy.bounds = proxy.object->GetCollider()->ComputeAABB();
+        }
+    }
+    for (Endpoint& endpoint : endpoints) {
+        const AABB& bounds = proxies[endpoint.proxyIdx].bounds;
+        endpoint.value = endpoint.isMin ? bounds.min[sortAxis] : bounds.max[sortAxis];
+    }
+}
+
+void SweepAndPrune::SortEndpoints(){
+    auto isLess = [this](const Endpoint& lhs, const Endpoint& rhs) { return IsLess(lhs, rhs); };
+
+    if (pendingInsertions >= FULL_SORT_THRESHOLD) {
+        std::sort(endpoints.begin(), endpoints.end(), isLess);
+    }
+    else {
+        //insertion sort, nearly linear thanks to the temporal coherence
+        for (size_t i = 1; i < endpoints.size(); ++i) {
+            Endpoint key = endpoints[i];
+            size_t j = i;
+            while (j > 0 && isLess(key, endpoints[j - 1])) {
+                endpoints[j] = endpoints[j - 1];
+                --j;
+            }
+            endpoints[j] = key;
+        }
+    }
+    pendingInsertions = 0;
+}
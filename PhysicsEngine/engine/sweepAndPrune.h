@@ -0,0 +1,62 @@
+#pragma once
+
+#include "broadPhase.h"
+#include "aabb.h"
+#include <unordered_map>
+#include <vector>
+
+namespace physics
+{
+    //Incremental sweep and prune (sort and sweep).
+    //The min/max endpoints of every AABB along one world axis are kept sorted across frames.
+    //Bodies move only a little per step, so the list is nearly sorted and the insertion sort
+    //run in ComputePairs() is close to linear.
+    class SweepAndPrune : public BroadPhase
+    {
+    private:
+        //above this many pending insertions the list is re-sorted in O(nlogn) instead
+        static constexpr unsigned FULL_SORT_THRESHOLD = 64;
+
+        struct Proxy
+        {
+            RigidObject* object;//nullptr when the slot is free
+            AABB bounds;
+            unsigned order;//registration order
+        };
+
+        struct Endpoint
+        {
+            float value;
+            unsigned proxyIdx;
+            bool isMin;
+        };
+
+        std::vector<Proxy> proxies;
+        std::vector<unsigned> freeProxies;
+        std::unordered_map<RigidObject*, unsigned> proxyIndices;
+
+        std::vector<Endpoint> endpoints;//sorted along 'sortAxis'
+        std::vector<unsigned> activeProxies;//scratch buffer for the sweep
+
+        unsigned nextOrder;
+        unsigned pendingInsertions;
+        int sortAxis;
+
+    public:
+        SweepAndPrune(int axis = 0) : nextOrder{}, pendingInsertions{}, sortAxis{ axis } {}
+
+        BroadPhaseType GetType() const override { return BroadPhaseType::SWEEP_AND_PRUNE; }
+
+        void AddObject(RigidObject* obj) override;
+        void RemoveObject(RigidObject* obj) override;
+        void ComputePairs(std::vector<ObjectPair>& pairs) override;
+
+        void SetSortAxis(int axis);
+        int GetSortAxis() const { return sortAxis; }
+
+    private:
+        bool IsLess(const Endpoint& lhs, const Endpoint& rhs) const;
+        void UpdateEndpoints();
+        void SortEndpoints();
+    };
+}
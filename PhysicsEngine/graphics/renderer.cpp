@@ -198,6 +198,14 @@ void Renderer::AddGraphicalShape(RigidObject* obj)
         shapes[obj] = std::make_unique<Box>();
         obj->SetShape(shapes[obj].get());
     }
+    else if (dynamic_cast<CapsuleObject*>(obj) != nullptr) {
+        shapes[obj] = std::make_unique<Capsule>();
+        obj->SetShape(shapes[obj].get());
+    }
+    else if (dynamic_cast<ConvexHullObject*>(obj) != nullptr) {
+        shapes[obj] = std::make_unique<Hull>(static_cast<ConvexHullObject*>(obj)->GetHull());
+        obj->SetShape(shapes[obj].get());
+    }
     else {
         throw std::runtime_error("Renderer::addGraphicalShape, invalid object pointer");
     }
@@ -225,6 +233,7 @@ void Renderer::RenderObject(RigidObject* obj)
     objectShader.SetVec3("viewPos", cameraManager.GetCameraPosition());
 
     Shape *objectShape = shapes.find(obj)->second.get();
+    objectShape->SetScale(obj->GetScale());
     objectShader.SetInt("texture1", objectShape->textureID);
     glBindVertexArray(objectShape->polygonVAO);
     glDrawElements(GL_TRIANGLES, objectShape->polygonIndices.size(), GL_UNSIGNED_INT, (void*)0);
@@ -87,9 +87,20 @@ void Shape::SetupPolygonAndFrameVAOs()
     glBindVertexArray(0);
 }
 
+void Shape::SetScale(const math::Vector3& newScale)
+{
+    if (newScale == scale) {
+        return;
+    }
+    scale = newScale;
+    GenerateShapeVertices(newScale);
+    SetupPolygonAndFrameVAOs();
+}
+
 Box::Box()
 {
-    GenerateShapeVertices({ 0.5f, 0.5f, 0.5f });
+    scale = { 0.5f, 0.5f, 0.5f };
+    GenerateShapeVertices(scale);
     polygonIndices = {
         // Front face
         0, 1, 2,  0, 2, 3,
@@ -157,6 +168,7 @@ void Box::GenerateShapeVertices(math::Vector3 extents)
 
 Sphere::Sphere()
 {
+    scale = { 1.0f, 1.0f, 1.0f };
     GenerateShapeVertices(1.0f);
     GenerateIndices();
     SetupPolygonAndFrameVAOs();
@@ -234,3 +246,144 @@ void Sphere::GenerateIndices()
         frameIndices.push_back(k2);
     }
 }
+
+Capsule::Capsule()
+{
+    scale = { 0.5f, 0.5f, 0.5f };
+    GenerateShapeVertices(scale);
+    GenerateIndices();
+    SetupPolygonAndFrameVAOs();
+}
+
+//the stacks of Sphere with the pole on y, the equator twice : once for each half
+void Capsule::GenerateShapeVertices(math::Vector3 scale)
+{
+    float radius = scale.x;
+    float halfHeight = scale.y;
+    float x, y, z, xz, s, t;
+    float sectorStep = 2 * math::PI / SECTOR_CNT;
+    float stackStep = math::PI / STACK_CNT;
+    float sectorAngle, stackAngle;
+
+    vertices.clear();
+    for (int i = 0; i <= STACK_CNT + 1; ++i)
+    {
+        bool isTopHalf = i <= STACK_CNT / 2;
+        int stack = isTopHalf ? i : i - 1;
+        stackAngle = math::PI / 2 - stack * stackStep;
+        xz = radius * cosf(stackAngle);
+        y = radius * sinf(stackAngle) + (isTopHalf ? halfHeight : -halfHeight);
+
+        for (int j = 0; j <= SECTOR_CNT; ++j)
+        {
+            sectorAngle = j * sectorStep;
+
+            x = xz * cosf(sectorAngle);
+            z = -xz * sinf(sectorAngle);
+            vertices.push_back(x);
+            vertices.push_back(y);
+            vertices.push_back(z);
+
+            s = (float)j / SECTOR_CNT;
+            t = (float)i / (STACK_CNT + 1);
+            vertices.push_back(s);
+            vertices.push_back(t);
+        }
+    }
+}
+
+void Capsule::GenerateIndices()
+{
+    int k1, k2;
+    for (int i = 0; i < STACK_CNT + 1; ++i)
+    {
+        k1 = i * (SECTOR_CNT + 1);
+        k2 = k1 + SECTOR_CNT + 1;
+
+        for (int j = 0; j < SECTOR_CNT; ++j, ++k1, ++k2)
+        {
+            if (i != 0)
+            {
+                polygonIndices.push_back(k1);
+                polygonIndices.push_back(k2);
+                polygonIndices.push_back(k1 + 1);
+            }
+            if (i != STACK_CNT)
+            {
+                polygonIndices.push_back(k1 + 1);
+                polygonIndices.push_back(k2);
+                polygonIndices.push_back(k2 + 1);
+            }
+        }
+        frameIndices.push_back(k1);
+        frameIndices.push_back(k2);
+    }
+}
+
+Hull::Hull(std::shared_ptr<const physics::ConvexHull> _hull)
+    : hull(std::move(_hull))
+{
+    scale = { 1.0f, 1.0f, 1.0f };
+    GenerateShapeVertices(1.0f);
+    GenerateIndices();
+    SetupPolygonAndFrameVAOs();
+}
+
+//the texture is projected on each face, along its first edge
+void Hull::GenerateShapeVertices(float scale)
+{
+    const std::vector<math::Vector3>& hullVertices = hull->GetVertices();
+    const std::vector<physics::ConvexHull::HalfEdge>& edges = hull->GetEdges();
+
+    vertices.clear();
+    for (const physics::ConvexHull::Face& face : hull->GetFaces())
+    {
+        const math::Vector3& origin = hullVertices[edges[face.edge].origin];
+        math::Vector3 tangent = hullVertices[edges[edges[face.edge].next].origin] - origin;
+        tangent.Normalize();
+        math::Vector3 bitangent = face.normal.Cross(tangent);
+
+        int edge = face.edge;
+        do
+        {
+            math::Vector3 position = hullVertices[edges[edge].origin];
+            vertices.push_back(position.x * scale);
+            vertices.push_back(position.y * scale);
+            vertices.push_back(position.z * scale);
+
+            vertices.push_back(tangent.Dot(position - origin) + 0.5f);
+            vertices.push_back(bitangent.Dot(position - origin) + 0.5f);
+            edge = edges[edge].next;
+        } while (edge != face.edge);
+    }
+}
+
+void Hull::GenerateIndices()
+{
+    const std::vector<physics::ConvexHull::HalfEdge>& edges = hull->GetEdges();
+
+    unsigned int first = 0;
+    for (const physics::ConvexHull::Face& face : hull->GetFaces())
+    {
+        unsigned int count = 0;
+        int edge = face.edge;
+        do
+        {
+            ++count;
+            edge = edges[edge].next;
+        } while (edge != face.edge);
+
+        for (unsigned int i = 1; i + 1 < count; ++i)
+        {
+            polygonIndices.push_back(first);
+            polygonIndices.push_back(first + i);
+            polygonIndices.push_back(first + i + 1);
+        }
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            frameIndices.push_back(first + i);
+            frameIndices.push_back(first + (i + 1) % count);
+        }
+        first += count;
+    }
+}
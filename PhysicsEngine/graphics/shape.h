@@ -1,6 +1,8 @@
 #pragma once
 
+#include <memory>//std::shared_ptr
 #include <vector>
+#include "engine/convexHull.h"
 #include "math/vector3.h"
 #include "textureImage.h"
 
@@ -21,11 +23,15 @@ namespace graphics
         unsigned int frameVAO;
         unsigned int textureID;
 
+        math::Vector3 scale;//what the vertices were generated for, (radius, radius, radius) for a sphere
+
     public:
         Shape() :polygonVAO{}, frameVAO{}, textureID {} {}
         virtual ~Shape() {}
 
         void SetupPolygonAndFrameVAOs();
+        //regenerates the vertices when the object was scaled since (the object has no graphics dependency)
+        void SetScale(const math::Vector3& newScale);
 
         virtual void GenerateShapeVertices(float) = 0;
         virtual void GenerateShapeVertices(math::Vector3) {}
@@ -55,6 +61,34 @@ namespace graphics
     public:
         Sphere();
         void GenerateShapeVertices(float)override final;
+        void GenerateShapeVertices(math::Vector3 scale)override final { GenerateShapeVertices(scale.x); }
+        void GenerateIndices();
+    };
+
+    //a sphere along y cut at the equator, the halves moved apart by the height of the cylinder
+    class Capsule : public Shape
+    {
+    public:
+        static constexpr int SECTOR_CNT = 72;
+        static constexpr int STACK_CNT = 24;//of the whole sphere, even
+
+    public:
+        Capsule();
+        void GenerateShapeVertices(float radius)override final { GenerateShapeVertices({ radius, radius, radius }); }
+        void GenerateShapeVertices(math::Vector3 scale)override final;//radius, halfHeight, radius
+        void GenerateIndices();
+    };
+
+    //flat shaded : every face fanned from its first vertex, with its own copies of the vertices
+    class Hull : public Shape
+    {
+    protected:
+        std::shared_ptr<const physics::ConvexHull> hull;
+
+    public:
+        explicit Hull(std::shared_ptr<const physics::ConvexHull> _hull);
+        void GenerateShapeVertices(float scale)override final;
+        void GenerateShapeVertices(math::Vector3 scale)override final { GenerateShapeVertices(scale.x); }
         void GenerateIndices();
     };
 }
@@ -1,9 +1,13 @@
 #include "simulator/geometry.h"
 #include "simulator/spawner.h"
+#include "engine/jobSystem.h"
 #include <gui/gui.h>
 #include <GLFW/glfw3.h>
 #include <string>
 #include <cfloat>
+#include <cstdio>//snprintf
+#include <cstring>//strcmp
+#include <algorithm>//std::min
 #include <queue>
 
 using namespace gui;
@@ -42,6 +46,7 @@ void GUI::renderAll(
 	renderObjectDetails(textures, windowFlags, eventQueue, objects, selectedObjects, isRunning);
 	renderSimulationControl(textures, windowFlags, eventQueue, isRunning);
 	renderWorldSettings(windowFlags, eventQueue);
+	renderProfiler(windowFlags, eventQueue);
 	renderScene(windowFlags, eventQueue);
 
 	ImGui::ShowDemoWindow();
@@ -185,6 +190,18 @@ void GUI::renderContentBrowser(unsigned* textures, ImGuiWindowFlags windowFlags,
 				{
 					eventQueue.push(std::make_unique<ObjectAddEvent>(ObjectType::SPAWNER));
 				}
+				ImGui::SameLine();
+
+				if (ImGui::Button("Capsule", buttonSize))//no icon yet
+				{
+					eventQueue.push(std::make_unique<ObjectAddEvent>(ObjectType::CAPSULE));
+				}
+				ImGui::SameLine();
+
+				if (ImGui::Button("Rock", buttonSize))//a convex hull, no icon yet
+				{
+					eventQueue.push(std::make_unique<ObjectAddEvent>(ObjectType::CONVEX_HULL));
+				}
 				ImGui::EndTabItem();
 			}
 			ImGui::EndTabBar();
@@ -275,6 +292,8 @@ void GUI::renderObjectList(
 				int boxCount{};
 				int spawnerCount{};
 				int sphereCount{};
+				int capsuleCount{};
+				int rockCount{};
 
 				for (const auto& object : objects)
 				{
@@ -299,6 +318,16 @@ void GUI::renderObjectList(
 						objectName = "cube";
 						objectName += std::to_string(++boxCount);
 					}
+					else if (dynamic_cast<CapsuleObject*>(object) != nullptr)
+					{
+						objectName = "capsule";
+						objectName += std::to_string(++capsuleCount);
+					}
+					else if (dynamic_cast<ConvexHullObject*>(object) != nullptr)
+					{
+						objectName = "rock";
+						objectName += std::to_string(++rockCount);
+					}
 
 					//multiple select with the ctrl key
 					if (ImGui::Selectable(objectName.c_str(), object->GetIsSelected(), 0, ImVec2(50, 20)))
@@ -387,6 +416,9 @@ void GUI::renderObjectAttribute(
 			eventQueue.push(std::make_unique<DeselectObjectsEvent>());
 		}
 	
+		ImGui::Spacing();
+		ImGui::Text(object->GetIsSleeping() ? "State : sleeping" : "State : awake");
+
 		math::Vector3 position = object->GetPosition();
 		ImGui::Spacing();
 		ImGui::Text("Position");
@@ -510,6 +542,33 @@ void GUI::renderObjectAttribute(
 				eventQueue.push(std::make_unique<ObjectScaleEvent>(selectedObjects[0], halfSize));
 			}
 		}
+		else if (dynamic_cast<const CapsuleObject*>(object) != nullptr) {
+			ImGui::Spacing();
+			ImGui::Text("Radius, half height");
+			ImGui::SameLine();
+			if (ImGui::Button("Reset##capsule")) {
+				halfSize = { 0.5f,0.5f,0.5f };
+				eventQueue.push(std::make_unique<ObjectScaleEvent>(selectedObjects[0], halfSize));
+			}
+			if (ImGui::DragFloat("##capsule-radius", &halfSize[0], 0.01f, 0.1f, FLT_MAX)) {
+				eventQueue.push(std::make_unique<ObjectScaleEvent>(selectedObjects[0], halfSize));
+			}
+			if (ImGui::DragFloat("##capsule-halfHeight", &halfSize[1], 0.01f, 0.0f, FLT_MAX)) {
+				eventQueue.push(std::make_unique<ObjectScaleEvent>(selectedObjects[0], halfSize));
+			}
+		}
+		else if (dynamic_cast<const ConvexHullObject*>(object) != nullptr) {
+			ImGui::Spacing();
+			ImGui::Text("Scale");
+			ImGui::SameLine();
+			if (ImGui::Button("Reset##scale")) {
+				halfSize = { 1.0f,1.0f,1.0f };
+				eventQueue.push(std::make_unique<ObjectScaleEvent>(selectedObjects[0], halfSize));
+			}
+			if (ImGui::DragFloat("##hull-scale", &halfSize[0], 0.01f, 0.1f, FLT_MAX)) {
+				eventQueue.push(std::make_unique<ObjectScaleEvent>(selectedObjects[0], halfSize));
+			}
+		}
 
 		// Texture selection
 		ImGui::Spacing();
@@ -543,6 +602,10 @@ void GUI::renderObjectAttribute(
 void GUI::renderAttributeDetails(ImGuiWindowFlags windowFlags, std::queue<std::unique_ptr<Event>>& eventQueue)
 {
 	static bool shouldRenderContactInfo = false;
+	static bool isSleepingEnabled = true;
+	static int threadCount = 1;
+	static int solverMode = 0;
+	static int substepCount = physics::SoftContactSettings{}.substepCount;
 	static float timeStep = 1.0f;
 	static float gravity = 9.8f;
 	static float groundRestitution = 0.2f;
@@ -619,6 +682,51 @@ void GUI::renderAttributeDetails(ImGuiWindowFlags windowFlags, std::queue<std::u
 				ImGui::EndTabItem();
 			}
 
+			// Sleeping tab
+			if (ImGui::BeginTabItem("Sleeping"))
+			{
+				ImGui::Spacing();
+				if (ImGui::Checkbox("Let resting islands sleep", &isSleepingEnabled))
+				{
+					eventQueue.push(std::make_unique<ToggleSleepingEvent>(isSleepingEnabled));
+				}
+
+				ImGui::EndTabItem();
+			}
+
+			// Threads tab
+			if (ImGui::BeginTabItem("Threads"))
+			{
+				ImGui::Spacing();
+				ImGui::Text("Worker threads");
+				if (ImGui::SliderInt("##ThreadCount", &threadCount, 1, physics::JobSystem::GetHardwareThreadCount()))
+				{
+					eventQueue.push(std::make_unique<ThreadCountEvent>(threadCount));
+				}
+				ImGui::SameLine();
+				if (ImGui::Button("Reset##ThreadCount"))
+				{
+					threadCount = 1;
+					eventQueue.push(std::make_unique<ThreadCountEvent>(threadCount));
+				}
+				ImGui::Text("Contact solver");
+				const char* solverModes[] = { "Sequential", "Graph colored", "SIMD batches", "Soft substeps" };
+				if (ImGui::Combo("##SolverMode", &solverMode, solverModes, IM_ARRAYSIZE(solverModes)))
+				{
+					eventQueue.push(std::make_unique<SolverModeEvent>(static_cast<physics::SolverMode>(solverMode)));
+				}
+				if (static_cast<physics::SolverMode>(solverMode) == physics::SolverMode::SOFT_SUBSTEPS)
+				{
+					ImGui::Text("Substeps");
+					if (ImGui::SliderInt("##SubstepCount", &substepCount, 1, 16))
+					{
+						eventQueue.push(std::make_unique<SubstepCountEvent>(substepCount));
+					}
+				}
+
+				ImGui::EndTabItem();
+			}
+
 			// Time Step tab
 			if (ImGui::BeginTabItem("Time Step"))
 			{
@@ -691,3 +799,57 @@ bool GUI::isInMainSceneWindow(ImVec2 vec)
 		return false;
 	}
 }
+
+void gui::GUI::renderProfiler(ImGuiWindowFlags windowFlags, std::queue<std::unique_ptr<Event>>& eventQueue)
+{
+	//time spent in each zone since the last frame, the physics steps of this frame summed up
+	profileEvents.clear();
+	physics::Profiler::Collect(profileEvents, profilerCursors);
+	const int historyIdx = profilerFrameIdx % PROFILER_HISTORY_SIZE;
+	for (int zone = 0; zone < PROFILED_ZONE_COUNT; ++zone) {
+		float frameMs{};
+		for (const physics::ProfileEvent& event : profileEvents) {
+			if (std::strcmp(event.name, PROFILED_ZONES[zone]) == 0) {
+				frameMs += event.duration / 1000000.f;
+			}
+		}
+		profilerHistory[zone][historyIdx] = frameMs;
+	}
+	++profilerFrameIdx;
+
+	const float windowWidth = SETTINGS_SCREEN_WIDTH_PERCENTAGE * ImGui::GetIO().DisplaySize.x - 0.065f * ImGui::GetIO().DisplaySize.x;
+	const float windowHeight = 0.25f * ImGui::GetIO().DisplaySize.y;
+	const float xOffset = (MAIN_SCREEN_WIDTH_PERCENTAGE + 0.065f) * ImGui::GetIO().DisplaySize.x;
+	const float yOffset = 0.55f * ImGui::GetIO().DisplaySize.y;
+
+	ImGui::SetNextWindowPos(ImVec2(xOffset, yOffset), ImGuiCond_Once);
+	ImGui::SetNextWindowSize(ImVec2(windowWidth, windowHeight), ImGuiCond_Once);
+
+	ImGui::Begin("Profiler", NULL, windowFlags);
+	{
+		ImGui::BeginChild("ProfilerRender");
+
+		if (ImGui::Button("trace")) {
+			eventQueue.push(std::make_unique<ProfilerTraceEvent>());
+		}
+		ImGui::SameLine();
+		ImGui::TextDisabled("(chrome://tracing)");
+
+		const int frameCount = std::min(profilerFrameIdx, PROFILER_HISTORY_SIZE);
+		const int oldestIdx = profilerFrameIdx > PROFILER_HISTORY_SIZE ? historyIdx + 1 : 0;
+		for (int zone = 0; zone < PROFILED_ZONE_COUNT; ++zone) {
+			float averageMs{};
+			for (int i = 0; i < frameCount; ++i) {
+				averageMs += profilerHistory[zone][i];
+			}
+			averageMs /= frameCount;
+
+			char overlay[32];
+			std::snprintf(overlay, sizeof(overlay), "%.3f ms", averageMs);
+			ImGui::PlotLines(PROFILED_ZONES[zone], profilerHistory[zone].data(), frameCount, oldestIdx % PROFILER_HISTORY_SIZE, overlay, 0.f, FLT_MAX, ImVec2(0.f, 30.f));
+		}
+
+		ImGui::EndChild();
+	}
+	ImGui::End();
+}
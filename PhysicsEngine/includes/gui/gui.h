@@ -4,11 +4,13 @@
 #include "imgui/imgui_impl_opengl3.h"
 #include "simulator/object.h"
 #include "simulator/event.h"
+#include "engine/profiler.h"
 #include <unordered_map>
 #include <vector>
 #include <queue>
 #include <memory>//unique_ptr
 #include <string>
+#include <array>
 
 namespace gui
 {
@@ -19,12 +21,22 @@ namespace gui
         static constexpr float MAIN_SCREEN_WIDTH_PERCENTAGE = 0.8f;
         static constexpr float SETTINGS_SCREEN_WIDTH_PERCENTAGE = 0.2f;
 
+        //zones plotted by the profiler window, the job zones are only in the trace
+        static constexpr const char* PROFILED_ZONES[] = { "Simulate", "BroadPhase", "NarrowPhase", "Islands", "Solver", "Integration", "Sleep", "Render", "GUI" };
+        static constexpr int PROFILED_ZONE_COUNT = sizeof(PROFILED_ZONES) / sizeof(PROFILED_ZONES[0]);
+        static constexpr int PROFILER_HISTORY_SIZE = 120;//frames
+
     private:
         unsigned int textureBufferID;
         bool shouldShowLoadPopup;
         bool isObjectAttributeWindowFocused;
         bool isObjectDetailsOpen;// Flag to track whether the objectDetails window is open or closed.
 
+        physics::Profiler::Cursors profilerCursors;
+        std::vector<physics::ProfileEvent> profileEvents;
+        std::array<std::array<float, PROFILER_HISTORY_SIZE>, PROFILED_ZONE_COUNT> profilerHistory{};//ms per frame
+        int profilerFrameIdx{};
+
     public:
         GUI(GLFWwindow* window, unsigned int textureBufferID);
 
@@ -77,6 +89,7 @@ namespace gui
         );
         void renderAttributeDetails(ImGuiWindowFlags, std::queue<std::unique_ptr<Event>>& eventQueue);
         void renderWorldSettings(ImGuiWindowFlags, std::queue<std::unique_ptr<Event>>& eventQueue);
+        void renderProfiler(ImGuiWindowFlags, std::queue<std::unique_ptr<Event>>& eventQueue);
 
         bool isInMainSceneWindow(ImVec2);
     };
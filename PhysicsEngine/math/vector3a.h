@@ -0,0 +1,167 @@
+#pragma once
+
+#include "vector3.h"
+#include <cmath>
+
+//SSE2 is part of x64 (MSVC doesn't define __SSE2__ there), MATH_NO_SIMD forces the scalar fallback
+#if !defined(MATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MATH_SIMD_SSE
+#include <emmintrin.h>
+#endif
+
+namespace math
+{
+    //Vector3 padded to 16 bytes, so that it fits one __m128 (x, y, z, 0). Everything is inline :
+    //the hot loops get it without a call per operation. The results are the same as Vector3's,
+    //the operations are done in the same order (no fused multiply-add, no reciprocal estimates).
+    struct alignas(16) Vector3A
+    {
+#ifdef MATH_SIMD_SSE
+        __m128 value;
+
+        Vector3A() : value(_mm_setzero_ps()) {}
+        Vector3A(float _x, float _y, float _z) : value(_mm_set_ps(0.0f, _z, _y, _x)) {}
+        explicit Vector3A(__m128 _value) : value(_value) {}
+#else
+        float value[4];
+
+        Vector3A() : value{ 0.0f, 0.0f, 0.0f, 0.0f } {}
+        Vector3A(float _x, float _y, float _z) : value{ _x, _y, _z, 0.0f } {}
+#endif
+        explicit Vector3A(const Vector3& vec) : Vector3A(vec.x, vec.y, vec.z) {}
+
+        Vector3 ToVector3() const;
+
+        float X() const { return (*this)[0]; }
+        float Y() const { return (*this)[1]; }
+        float Z() const { return (*this)[2]; }
+        float operator[](unsigned int idx) const;
+
+        void Normalize();
+
+        float Length() const { return sqrtf(LengthSquared()); }
+        float LengthSquared() const { return Dot(*this); }
+
+        float Dot(const Vector3A& rhs) const;
+        Vector3A Cross(const Vector3A& rhs) const;
+
+        void Clear() { *this = Vector3A(); }
+
+        Vector3A operator+(const Vector3A& rhs) const;
+        void operator+=(const Vector3A& rhs) { *this = *this + rhs; }
+
+        Vector3A operator-(const Vector3A& rhs) const;
+        void operator-=(const Vector3A& rhs) { *this = *this - rhs; }
+
+        Vector3A operator*(const float scale) const;
+        void operator*=(const float scale) { *this = *this * scale; }
+
+        Vector3A operator-() const;
+        bool operator==(const Vector3A& rhs) const;
+        bool operator!=(const Vector3A& rhs) const { return !(*this == rhs); }
+    };
+
+#ifdef MATH_SIMD_SSE
+    inline Vector3 Vector3A::ToVector3() const {
+        alignas(16) float components[4];
+        _mm_store_ps(components, value);
+        return { components[0], components[1], components[2] };
+    }
+
+    inline float Vector3A::operator[](unsigned int idx) const {
+        alignas(16) float components[4];
+        _mm_store_ps(components, value);
+        return components[idx & 3];
+    }
+
+    inline void Vector3A::Normalize() {
+        __m128 magnitudeInverse = _mm_div_ss(_mm_set_ss(1.0f), _mm_sqrt_ss(_mm_set_ss(LengthSquared())));
+        value = _mm_mul_ps(value, _mm_shuffle_ps(magnitudeInverse, magnitudeInverse, _MM_SHUFFLE(0, 0, 0, 0)));
+    }
+
+    //(x*x' + y*y') + z*z', the order of Vector3::Dot()
+    inline float Vector3A::Dot(const Vector3A& rhs) const {
+        __m128 product = _mm_mul_ps(value, rhs.value);
+        __m128 sum = _mm_add_ss(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1)));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 2, 2, 2)));
+        return _mm_cvtss_f32(sum);
+    }
+
+    //yzx * zxy - zxy * yzx
+    inline Vector3A Vector3A::Cross(const Vector3A& rhs) const {
+        __m128 lhsYzx = _mm_shuffle_ps(value, value, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 lhsZxy = _mm_shuffle_ps(value, value, _MM_SHUFFLE(3, 1, 0, 2));
+        __m128 rhsYzx = _mm_shuffle_ps(rhs.value, rhs.value, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 rhsZxy = _mm_shuffle_ps(rhs.value, rhs.value, _MM_SHUFFLE(3, 1, 0, 2));
+        return Vector3A(_mm_sub_ps(_mm_mul_ps(lhsYzx, rhsZxy), _mm_mul_ps(lhsZxy, rhsYzx)));
+    }
+
+    inline Vector3A Vector3A::operator+(const Vector3A& rhs) const {
+        return Vector3A(_mm_add_ps(value, rhs.value));
+    }
+
+    inline Vector3A Vector3A::operator-(const Vector3A& rhs) const {
+        return Vector3A(_mm_sub_ps(value, rhs.value));
+    }
+
+    inline Vector3A Vector3A::operator*(const float scale) const {
+        return Vector3A(_mm_mul_ps(value, _mm_set1_ps(scale)));
+    }
+
+    inline Vector3A Vector3A::operator-() const {
+        return Vector3A(_mm_xor_ps(value, _mm_set1_ps(-0.0f)));
+    }
+
+    //the padding isn't compared (it is NaN after e.g. a multiplication by infinity)
+    inline bool Vector3A::operator==(const Vector3A& rhs) const {
+        return (_mm_movemask_ps(_mm_cmpeq_ps(value, rhs.value)) & 0x7) == 0x7;
+    }
+#else
+    inline Vector3 Vector3A::ToVector3() const {
+        return { value[0], value[1], value[2] };
+    }
+
+    inline float Vector3A::operator[](unsigned int idx) const {
+        return value[idx & 3];
+    }
+
+    inline void Vector3A::Normalize() {
+        float magnitudeInverse = 1.0f / Length();
+        value[0] *= magnitudeInverse;
+        value[1] *= magnitudeInverse;
+        value[2] *= magnitudeInverse;
+    }
+
+    inline float Vector3A::Dot(const Vector3A& rhs) const {
+        return value[0] * rhs.value[0] + value[1] * rhs.value[1] + value[2] * rhs.value[2];
+    }
+
+    inline Vector3A Vector3A::Cross(const Vector3A& rhs) const {
+        return Vector3A(
+            value[1] * rhs.value[2] - value[2] * rhs.value[1],
+            value[2] * rhs.value[0] - value[0] * rhs.value[2],
+            value[0] * rhs.value[1] - value[1] * rhs.value[0]
+        );
+    }
+
+    inline Vector3A Vector3A::operator+(const Vector3A& rhs) const {
+        return Vector3A(value[0] + rhs.value[0], value[1] + rhs.value[1], value[2] + rhs.value[2]);
+    }
+
+    inline Vector3A Vector3A::operator-(const Vector3A& rhs) const {
+        return Vector3A(value[0] - rhs.value[0], value[1] - rhs.value[1], value[2] - rhs.value[2]);
+    }
+
+    inline Vector3A Vector3A::operator*(const float scale) const {
+        return Vector3A(value[0] * scale, value[1] * scale, value[2] * scale);
+    }
+
+    inline Vector3A Vector3A::operator-() const {
+        return Vector3A(-value[0], -value[1], -value[2]);
+    }
+
+    inline bool Vector3A::operator==(const Vector3A& rhs) const {
+        return value[0] == rhs.value[0] && value[1] == rhs.value[1] && value[2] == rhs.value[2];
+    }
+#endif
+}
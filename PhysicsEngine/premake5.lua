@@ -1,3 +1,24 @@
+-- physics only (engine, math and the object model), no GLFW/OpenGL : also linked by Headless-Runner
+project "PhysicsCore"
+    kind "StaticLib"
+    language "C++"
+
+    files
+    {
+        "engine/**.h",
+        "engine/**.cpp",
+        "math/**.h",
+        "math/**.cpp",
+        "simulator/object.h",
+        "simulator/object.cpp",
+        "simulator/geometry.h",
+        "simulator/objectSerialization.h"
+    }
+    -- replaces the global operator new, compiled by the executables that want it (Headless-Runner)
+    removefiles { "engine/allocationCounter.cpp" }
+
+    includedirs { "." }
+
 project "PhysicsEngine"
     kind "ConsoleApp"
     language "C++"
@@ -9,8 +30,18 @@ project "PhysicsEngine"
         "**.cpp",
         "glad.c"--"**.c" --glad.c
     }
+    -- built by PhysicsCore
+    removefiles
+    {
+        "engine/**",
+        "math/**",
+        "simulator/object.*"
+    }
     
 
     -- to ensures the root of Project1 is included
     includedirs { "." }
 
+    libdirs { "libraries" }
+    -- Since you're using GLFW (which likely has a .lib file), link against it
+    links { "PhysicsCore", "glfw3", "opengl32" }
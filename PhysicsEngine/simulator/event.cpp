@@ -3,7 +3,9 @@
 #include "simulator.h"
 #include "objectSerialization.h"
 #include "spawner.h"
+#include "engine/profiler.h"
 #include <cmath>//cos,sin
+#include <iostream>
 
 int SaveScenarioEvent::savedScenarios = 1;
 
@@ -18,6 +20,12 @@ void ObjectAddEvent::Handle(Simulator& simulator) {
 	case ObjectType::SPAWNER:
 		simulator.AddSpawner();
 		break;
+	case ObjectType::CAPSULE:
+		simulator.AddCapsule();
+		break;
+	case ObjectType::CONVEX_HULL:
+		simulator.AddConvexHull();
+		break;
 	default:
 		break;
 	}
@@ -73,20 +81,24 @@ void ObjectPositionEvent::Handle(Simulator& simulator)
 	rigidBody->SetPosition(position[0], position[1], position[2]);
 	rigidBody->SetLinearVelocity(0.0f, 0.0f, 0.0f);
 	rigidBody->SetAngularVelocity(0.0f, 0.0f, 0.0f);
+	obj->WakeUp();
 }
 
 void ObjectVelocityEvent::Handle(Simulator& simulator) {
 	obj->GetRigidBody()->SetLinearVelocity(velocity[0], velocity[1], velocity[2]);
+	obj->WakeUp();
 }
 
 void ObjectScaleEvent::Handle(Simulator& simulator) {
 	RigidObject* object = obj;
 	object->SetScale(GRID_SCALE);
+	object->WakeUp();
 	//object->synchObjectData();
 }
 
 void ObjectMassEvent::Handle(Simulator& simulator) {
-	obj->GetRigidBody()->SetMass(value);
+	obj->SetMass(value);
+	obj->WakeUp();
 }
 
 void LeftMouseDragEvent::Handle(Simulator& simulator) {
@@ -154,43 +166,24 @@ void LeftMouseClickEvent::Handle(Simulator& simulator) {
 void ObjectFixPositionEvent::Handle(Simulator& simulator) {
 	if (shouldBeFixed)
 	{
-		obj->SetFixed(true);
-		obj->GetRigidBody()->SetInverseMass(0.0f);
-		obj->GetRigidBody()->SetInverseInertiaTensor(physics::Matrix3(0.0f));
-		obj->GetRigidBody()->SetLinearVelocity(0.0f, 0.0f, 0.0f);
-		obj->GetRigidBody()->SetAngularVelocity(0.0f, 0.0f, 0.0f);
+		obj->FixInPlace();
 	}
 	else
 	{
 		obj->SetFixed(false);
-		obj->GetRigidBody()->SetMass(5.0f);
-
-		physics::Matrix3 inertiaTensor;
-		Vector3 GRID_SCALE = obj->GetScale();
-		if (typeid(*obj) == typeid(SphereObject))
-		{
-			SphereObject* sphere = static_cast<SphereObject*>(obj);
-			inertiaTensor.SetDiagonal(0.4f * sphere->GetRigidBody()->GetMass() * GRID_SCALE.x * GRID_SCALE.x);
-		}
-		else if (typeid(*obj) == typeid(BoxObject))
-		{
-			BoxObject* box = static_cast<BoxObject*>(obj);
-			float k = obj->GetRigidBody()->GetMass() / 12;
-			float x = GRID_SCALE.x * 2.0f;
-			float y = GRID_SCALE.y * 2.0f;
-			float z = GRID_SCALE.z * 2.0f;
-			inertiaTensor[0] = k * (y * y + z * z);
-			inertiaTensor[4] = k * (x * x + z * z);
-			inertiaTensor[8] = k * (y * y + x * x);
-		}
-		obj->GetRigidBody()->SetInertiaTensor(inertiaTensor);
+		obj->SetMass(5.0f);
 	}
+	obj->WakeUp();
 }
 
 void ToggleContactRenderEvent::Handle(Simulator& simulator) {
 	simulator.shouldRenderContactInfo = flag;
 }
 
+void ToggleSleepingEvent::Handle(Simulator& simulator) {
+	simulator.GetSimulator().SetSleepingEnabled(flag);
+}
+
 void ClearAllObjectsEvent::Handle(Simulator& simulator)
 {
 	simulator.isRunning = false;
@@ -216,6 +209,20 @@ void GravityEvent::Handle(Simulator& simulator) {
 	simulator.GetSimulator().SetGravity(value);
 }
 
+void ThreadCountEvent::Handle(Simulator& simulator) {
+	simulator.GetSimulator().SetThreadCount(value);
+}
+
+void SolverModeEvent::Handle(Simulator& simulator) {
+	simulator.GetSimulator().SetSolverMode(mode);
+}
+
+void SubstepCountEvent::Handle(Simulator& simulator) {
+	physics::SoftContactSettings settings = simulator.GetSimulator().GetSoftContactSettings();
+	settings.substepCount = value;
+	simulator.GetSimulator().SetSoftContactSettings(settings);
+}
+
 void ObjectRotateEvent::Handle(Simulator& simulator) {
 	RigidObject* target = obj;
 
@@ -229,10 +236,12 @@ void ObjectRotateEvent::Handle(Simulator& simulator) {
 	physics::Quaternion quat(degree,axisLocal);
 
 	obj->GetRigidBody()->RotateByQuat(quat);
+	obj->WakeUp();
 }
 
 void OrientationResetEvent::Handle(Simulator& simulator) {
 	obj->GetRigidBody()->SetOrientation(physics::Quaternion(1.0f, 0.0f, 0.0f, 0.0f));
+	obj->WakeUp();
 }
 
 void ToggleWorldAxisRenderEvent::Handle(Simulator& simulator) {
@@ -300,34 +309,21 @@ void SaveScenarioEvent::Handle(Simulator& simulator)
 	SaveObjectsToJson(serializedObjs, ++SaveScenarioEvent::savedScenarios);
 }
 
+void ProfilerTraceEvent::Handle(Simulator& simulator)
+{
+	const std::string tracePath = "PhysicsEngine/profile_trace.json";
+	if (physics::Profiler::WriteChromeTrace(tracePath) == false) {
+		std::cerr << "can't write " << tracePath << std::endl;
+	}
+}
+
 void PresetLoadEvent::Handle(Simulator& simulator)
 {
 	std::vector<ObjectData> loadedObjects;
 	LoadObjectsFromJson(loadedObjects,presetIdx);
 	for (const ObjectData& objData : loadedObjects) {
-		RigidObject* obj{ nullptr };
-		if (objData.type == ObjectType::BOX) {
-			obj = simulator.AddBox(objData.pos, TextureID(objData.textureID));
-		}
-		else if (objData.type == ObjectType::SPHERE) {
-			obj = simulator.AddSphere(objData.pos, TextureID(objData.textureID));
-		}
-		else if (objData.type == ObjectType::SPAWNER) {
-			obj = simulator.AddSpawner(objData.pos, TextureID(objData.textureID));
-		}
-		else {
-			throw std::runtime_error("unidentified object type");
-			//...
-		}
-		obj->SetScale(objData.scl);
-		obj->GetRigidBody()->SetMass(objData.mass);
-		obj->GetRigidBody()->SetLinearVelocity(objData.vel);
-		obj->GetRigidBody()->SetOrientation(objData.orientation);
-
-		if (objData.IsFixed == true) {
-			ObjectFixPositionEvent evt2(obj, true);
-			evt2.Handle(simulator);
-		}
+		RigidObject* obj = simulator.AddObject(objData.type, objData.pos, TextureID(objData.textureID));
+		ApplyObjectData(obj, objData);
 	}
 
 }
@@ -335,29 +331,15 @@ void PresetLoadEvent::Handle(Simulator& simulator)
 void DuplicateEvent::Handle(Simulator& simulator){
 	std::vector<RigidObject*>& selectedObjects = simulator.GetSelectedObjects();
 	for (const RigidObject* obj : selectedObjects) {
-		RigidObject* newObj{ nullptr };
 		const physics::RigidBody* body = obj->GetRigidBody();
-		if (obj->GetObjectType() == ObjectType::BOX) {
-			newObj = simulator.AddBox(body->GetPosition(), TextureID(obj->GetShape()->GetTextureID()));
-		}
-		else if (obj->GetObjectType() == ObjectType::SPHERE) {
-			newObj = simulator.AddSphere(body->GetPosition(), TextureID(obj->GetShape()->GetTextureID()));
-		}
-		else if (obj->GetObjectType() == ObjectType::SPAWNER) {
-			newObj = simulator.AddSpawner(body->GetPosition(), TextureID(obj->GetShape()->GetTextureID()));
-		}
-		else {
-			throw std::runtime_error("unidentified object type");
-			//...
-		}
+		RigidObject* newObj = simulator.AddObject(obj->GetObjectType(), body->GetPosition(), TextureID(obj->GetShape()->GetTextureID()));
 		newObj->SetScale(obj->GetScale());
 		newObj->GetRigidBody()->SetLinearVelocity(body->GetLinearVelocity());
 		newObj->GetRigidBody()->SetOrientation(body->GetOrientation()
 		);
 
 		if (obj->GetIsFixed() == true) {
-			ObjectFixPositionEvent evt2(newObj, true);
-			evt2.Handle(simulator);
+			newObj->FixInPlace();
 		}
 	}
 }
@@ -2,6 +2,7 @@
 
 #include "geometry.h"
 #include "object.h"
+#include "engine/collisionManager.h"//physics::SolverMode
 
 class Simulator;
 /* 
@@ -29,6 +30,11 @@ struct SaveScenarioEvent : public Event {
     virtual void Handle(Simulator& simulator) override final;
 };
 
+//dumps the profiler rings as a Chrome trace
+struct ProfilerTraceEvent : public Event {
+    virtual void Handle(Simulator& simulator) override final;
+};
+
 struct PresetLoadEvent : public Event {
     int presetIdx;
     PresetLoadEvent(int presetIdx_) :presetIdx{ presetIdx_ } {}
@@ -180,6 +186,16 @@ public:
     virtual void Handle(Simulator& simulator) override final;
 };
 
+struct ToggleSleepingEvent : public Event
+{
+public:
+    bool flag;
+
+    ToggleSleepingEvent(bool _flag)
+        : flag(_flag) {}
+    virtual void Handle(Simulator& simulator) override final;
+};
+
 struct ClearAllObjectsEvent : public Event {
     virtual void Handle(Simulator& simulator) override final;
 };
@@ -214,6 +230,36 @@ public:
     virtual void Handle(Simulator& simulator) override final;
 };
 
+struct ThreadCountEvent : public Event
+{
+public:
+    int value;
+
+    ThreadCountEvent(int _value)
+        : value(_value) {}
+    virtual void Handle(Simulator& simulator) override final;
+};
+
+struct SolverModeEvent : public Event
+{
+public:
+    physics::SolverMode mode;
+
+    SolverModeEvent(physics::SolverMode _mode)
+        : mode(_mode) {}
+    virtual void Handle(Simulator& simulator) override final;
+};
+
+struct SubstepCountEvent : public Event
+{
+public:
+    int value;
+
+    SubstepCountEvent(int _value)
+        : value(_value) {}
+    virtual void Handle(Simulator& simulator) override final;
+};
+
 struct ObjectRotateEvent : public Event
 {
 public:
@@ -1,9 +1,14 @@
 #pragma once
 
+//the presets and the cooked hulls, relative to the working directory (the apps run from the repository root)
+constexpr const char* PRESETS_DIRECTORY = "PhysicsEngine/presets/";
+
 enum class ObjectType
 {
     DEFAULT,
     SPHERE,
     BOX,
-    SPAWNER
+    SPAWNER,
+    CAPSULE,
+    CONVEX_HULL
 };
@@ -1,4 +1,10 @@
 #include "object.h"
+#include "engine/physicsWorld.h"
+#include "math/mathConstants.h"//PI
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 math::Vector3 RigidObject::GetPosition() const{
     return rigidBody->GetPosition();
@@ -20,9 +26,23 @@ float RigidObject::GetMass() const{
     return rigidBody->GetMass();
 }
 
-void RigidObject::FreePhysicsComponents() {
-    delete rigidBody; rigidBody = nullptr;
-    delete collider; collider = nullptr;
+void RigidObject::WakeUp() {
+    if (rigidBody != nullptr) {
+        rigidBody->SetAwake(true);
+    }
+}
+
+void RigidObject::SetMass(float mass) {
+    rigidBody->SetMass(mass);
+    SynchObjectData();
+}
+
+void RigidObject::FixInPlace() {
+    SetFixed(true);
+    rigidBody->SetInverseMass(0.0f);
+    rigidBody->SetInverseInertiaTensor(physics::Matrix3(0.0f));
+    rigidBody->SetLinearVelocity(0.0f, 0.0f, 0.0f);
+    rigidBody->SetAngularVelocity(0.0f, 0.0f, 0.0f);
 }
 
 math::Vector3 SphereObject::GetScale() const{
@@ -50,9 +70,6 @@ void SphereObject::SynchObjectData()
     }
 
     collider->SetScale(radius);
-
-    shape->GenerateShapeVertices(radius);
-    shape->SetupPolygonAndFrameVAOs();
 }
 
 math::Vector3 BoxObject::GetScale() const{
@@ -87,7 +104,145 @@ void BoxObject::SynchObjectData()
         rigidBody->SetInertiaTensor(inertiaTensor);
     }
     collider->SetScale(extentsX, extentsY, extentsZ);
-    shape->GenerateShapeVertices({ extentsX, extentsY, extentsZ });
-    shape->SetupPolygonAndFrameVAOs();
 }
 
+math::Vector3 CapsuleObject::GetScale() const{
+    return { radius,halfHeight,radius };
+}
+
+void CapsuleObject::SetScale(float value)
+{
+    radius = value;
+    SynchObjectData();
+}
+
+void CapsuleObject::SetScale(math::Vector3 v)
+{
+    radius = v.x;
+    halfHeight = v.y;
+    SynchObjectData();
+}
+
+void CapsuleObject::SynchObjectData()
+{
+    if (rigidBody->GetInverseMass() != 0.0f)
+    {
+        rigidBody->SetInertiaTensor(CalcInertiaTensor(rigidBody->GetMass(), radius, halfHeight));
+    }
+    collider->SetScale(radius, halfHeight);
+}
+
+//a cylinder and a sphere split in two, the mass shared by volume. The caps move by the parallel axis theorem
+physics::Matrix3 CapsuleObject::CalcInertiaTensor(float mass, float radius, float halfHeight)
+{
+    float cylinderVolume = math::PI * radius * radius * halfHeight * 2.0f;
+    float sphereVolume = 4.0f / 3.0f * math::PI * radius * radius * radius;
+    float cylinderMass = mass * cylinderVolume / (cylinderVolume + sphereVolume);
+    float sphereMass = mass - cylinderMass;
+    float r2 = radius * radius;
+    float h = halfHeight;
+
+    physics::Matrix3 inertiaTensor;
+    inertiaTensor[4] = cylinderMass * r2 * 0.5f + sphereMass * r2 * 0.4f;
+    inertiaTensor[0] = inertiaTensor[8] =
+        cylinderMass * (h * h / 3.0f + r2 * 0.25f) + sphereMass * (r2 * 0.4f + h * h + 0.75f * h * radius);
+    return inertiaTensor;
+}
+
+ConvexHullObject::ConvexHullObject(std::shared_ptr<const physics::ConvexHull> _hull)
+    : hull(std::move(_hull)), scale(1.0f)
+{
+    physics::ConvexHull::MassProperties massProperties = hull->ComputeMassProperties();
+    unitInertiaTensor = massProperties.inertiaTensor * (1.0f / massProperties.volume);
+}
+
+math::Vector3 ConvexHullObject::GetScale() const{
+    return { scale,scale,scale };
+}
+
+void ConvexHullObject::SetScale(float value)
+{
+    scale = value;
+    SynchObjectData();
+}
+
+void ConvexHullObject::SetScale(math::Vector3 v)
+{
+    scale = v.x;
+    SynchObjectData();
+}
+
+float ConvexHullObject::GetHeight() const
+{
+    return hull->GetVertices()[hull->GetSupportVertex({ 0.0f,1.0f,0.0f })].y * scale;
+}
+
+void ConvexHullObject::SynchObjectData()
+{
+    if (rigidBody->GetInverseMass() != 0.0f)
+    {
+        rigidBody->SetInertiaTensor(CalcInertiaTensor(rigidBody->GetMass()));
+    }
+    collider->SetScale(scale);
+}
+
+//a Fibonacci sphere on a bumpy ellipsoid : the same rock on every run. Loaded cooked from the presets (rock.hull),
+//built in memory when the file can't be read. Nothing is written : the hull is cooked once and committed
+std::shared_ptr<const physics::ConvexHull> ConvexHullObject::GetRockHull()
+{
+    static const std::shared_ptr<const physics::ConvexHull> rock = [] {
+        auto newHull = std::make_shared<physics::ConvexHull>();
+        if (physics::ConvexHull::LoadCooked(std::string(PRESETS_DIRECTORY) + "rock.hull", *newHull) == false)
+        {
+            const int pointCount = 48;
+            const float goldenAngle = math::PI * (3.0f - std::sqrt(5.0f));
+            std::vector<math::Vector3> points;
+            for (int i = 0; i < pointCount; ++i)
+            {
+                float y = 1.0f - 2.0f * (i + 0.5f) / pointCount;
+                float ringRadius = std::sqrt(1.0f - y * y);
+                float angle = goldenAngle * i;
+                float bump = 1.0f + 0.15f * std::sin(angle * 3.0f + y * 5.0f);
+                points.push_back({ ringRadius * std::cos(angle) * 0.5f * bump, y * 0.35f * bump, ringRadius * std::sin(angle) * 0.425f * bump });
+            }
+            *newHull = physics::ConvexHull::Build(points);
+            newHull->Translate(-newHull->ComputeMassProperties().centerOfMass);
+        }
+        return std::shared_ptr<const physics::ConvexHull>(std::move(newHull));
+    }();
+    return rock;
+}
+
+RigidObject* CreateObject(ObjectType type)
+{
+    if (type == ObjectType::BOX) {
+        return new BoxObject;
+    }
+    else if (type == ObjectType::SPHERE) {
+        return new SphereObject;
+    }
+    else if (type == ObjectType::CAPSULE) {
+        return new CapsuleObject;
+    }
+    else if (type == ObjectType::CONVEX_HULL) {
+        return new ConvexHullObject;
+    }
+    throw std::runtime_error("CreateObject(): unidentified object type");
+}
+
+void AddObjectToWorld(physics::PhysicsWorld& world, RigidObject* obj, const math::Vector3& pos)
+{
+    world.AddRigidBody(pos.x, pos.y, pos.z, obj);
+    world.AddCollider(obj->GetRigidBody(), obj);
+    world.AddPhysicalObject(obj);
+}
+
+void DeleteAllObjects(physics::PhysicsWorld& world)
+{
+    std::vector<RigidObject*>& objects = world.GetObjects();
+    while (objects.empty() == false) {
+        RigidObject* obj = objects.back();
+        world.RemovePhysicsObject(obj);
+        delete obj;
+    }
+}
@@ -2,11 +2,18 @@
 
 #include "engine/body.h"
 #include "engine/collider.h"
-#include "graphics/shape.h"
 #include "geometry.h"
-#include <glm/glm.hpp>
+#include <memory>//std::shared_ptr
 
-class PhysicsSystem;
+namespace graphics
+{
+    class Shape;//set by the renderer, nullptr without one (e.g. headless)
+}
+
+namespace physics
+{
+    class PhysicsWorld;
+}
 
 class RigidObject
 {
@@ -29,12 +36,15 @@ public:
     virtual ~RigidObject() {};
 
     virtual ObjectType GetObjectType() const = 0;
+    virtual void OnCollision() {}//after the collision detection of the step (spawners only)
     physics::RigidBody* GetRigidBody() { return rigidBody; }
     const physics::RigidBody* GetRigidBody()const { return rigidBody; }
     physics::Collider* GetCollider() { return collider; }
 
     bool GetIsSelected() const { return isSelected; }
     bool GetIsFixed() const { return IsFixed; }
+    bool GetIsSleeping() const { return rigidBody != nullptr && rigidBody->IsAwake() == false; }
+    void WakeUp();//the whole island wakes up with it in the next step
     
     math::Vector3 GetPosition() const;
     math::Vector3 GetLinearVelocity() const;
@@ -48,12 +58,13 @@ public:
     graphics::Shape* GetShape() { return shape; }
     const graphics::Shape* GetShape() const { return shape; }
 
+    void SetMass(float mass);//the inertia tensor follows
     void SetFixed(bool isFixed_) { IsFixed = isFixed_; }
+    void FixInPlace();//SetFixed(true), without mass, inertia nor velocity : nothing moves it anymore
     void SetSelected(bool isSelected_) { isSelected = isSelected_; }
     void SetRigidBody(physics::RigidBody* rb) { rigidBody = rb; }
     void SetCollider(physics::Collider* col) { collider = col; }
     void SetShape(graphics::Shape* Shape) { shape = Shape; }
-    void FreePhysicsComponents();
 
     virtual void SetScale(float) = 0;
     virtual void SetScale(math::Vector3) = 0;
@@ -93,3 +104,55 @@ public:
     float GetHeight()const override final { return extentsY; }
 };
 
+class CapsuleObject : public RigidObject
+{
+    virtual void SynchObjectData() override final;
+protected:
+    float radius;
+    float halfHeight;//of the cylinder between the caps
+
+public:
+    CapsuleObject() : radius(0.5f), halfHeight(0.5f) {}
+
+    ObjectType GetObjectType() const override final { return ObjectType::CAPSULE; }
+    math::Vector3 GetScale() const override final;//radius, halfHeight, radius
+    void SetScale(float) override final;//the radius
+    void SetScale(math::Vector3) override final;
+    float GetHeight()const override final { return halfHeight + radius; }
+
+    static physics::Matrix3 CalcInertiaTensor(float mass, float radius, float halfHeight);
+};
+
+class ConvexHullObject : public RigidObject
+{
+    virtual void SynchObjectData() override final;
+protected:
+    std::shared_ptr<const physics::ConvexHull> hull;//around its center of mass
+    physics::Matrix3 unitInertiaTensor;//for a mass of 1 at scale 1
+    float scale;//uniform
+
+public:
+    explicit ConvexHullObject(std::shared_ptr<const physics::ConvexHull> _hull = GetRockHull());
+
+    ObjectType GetObjectType() const override final { return ObjectType::CONVEX_HULL; }
+    math::Vector3 GetScale() const override final;//scale, scale, scale
+    void SetScale(float) override final;
+    void SetScale(math::Vector3) override final;//the x component
+    float GetHeight()const override final;
+
+    const std::shared_ptr<const physics::ConvexHull>& GetHull() const { return hull; }
+    physics::Matrix3 CalcInertiaTensor(float mass) const { return unitInertiaTensor * (mass * scale * scale); }
+
+    //the default shape, loaded cooked on the first call (or built if the file is missing) and shared
+    static std::shared_ptr<const physics::ConvexHull> GetRockHull();
+};
+
+//an object of the type, without body nor collider : see AddObjectToWorld().
+//The spawner isn't created here, its pools need the renderer (Simulator::AddSpawner)
+RigidObject* CreateObject(ObjectType type);
+
+//gives it a body and a collider at pos, then adds it to the world
+void AddObjectToWorld(physics::PhysicsWorld& world, RigidObject* obj, const math::Vector3& pos);
+
+//the world frees the physics components, the objects are deleted here
+void DeleteAllObjects(physics::PhysicsWorld& world);
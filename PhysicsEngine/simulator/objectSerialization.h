@@ -4,6 +4,7 @@
 #include <iostream>
 #include <filesystem>
 #include "geometry.h"
+#include "object.h"
 #include "math/vector3.h"
 #include "engine/quaternion.h"
 
@@ -23,7 +24,7 @@ struct ObjectData {//78 bytes
     ObjectType type;  // enum Sphere or Box, 1 byte
 };
  //Function to save object data to a JSON file
-static void SaveObjectsToJson(const std::vector<ObjectData>& objects, int fileIdx) {
+static void SaveObjectsToJson(const std::vector<ObjectData>& objects, const std::string& filePath) {
     json j = json::array();
     for (const auto& obj : objects) {
         json objJson;
@@ -38,17 +39,17 @@ static void SaveObjectsToJson(const std::vector<ObjectData>& objects, int fileId
         objJson["type"] = static_cast<int>(obj.type);
         j.push_back(objJson);
     }
-    std::string filePath = "PhysicsEngine/presets/preset_" + std::to_string(fileIdx) + ".json";
     std::ofstream outputFile(filePath);
-
-    std::ifstream ifs(filePath);
     outputFile << j.dump(4);
     outputFile.close();
 }
 
+static void SaveObjectsToJson(const std::vector<ObjectData>& objects, int fileIdx) {
+    SaveObjectsToJson(objects, PRESETS_DIRECTORY + ("preset_" + std::to_string(fileIdx) + ".json"));
+}
+
 // Function to load object data from a JSON file
-static void LoadObjectsFromJson(std::vector<ObjectData>& objects,unsigned fileIdx) {
-    std::string filePath = "PhysicsEngine/presets/preset_" + std::to_string(fileIdx) + ".json";
+static void LoadObjectsFromJson(std::vector<ObjectData>& objects, const std::string& filePath) {
     std::ifstream inputFile(filePath);
     if (!std::filesystem::exists(filePath)) {
         std::cerr << "Error: File not found: " << filePath << std::endl;
@@ -76,3 +77,20 @@ static void LoadObjectsFromJson(std::vector<ObjectData>& objects,unsigned fileId
         objects.push_back(objData);
     }
 }
+
+static void LoadObjectsFromJson(std::vector<ObjectData>& objects, unsigned fileIdx) {
+    LoadObjectsFromJson(objects, PRESETS_DIRECTORY + ("preset_" + std::to_string(fileIdx) + ".json"));
+}
+
+//the loaded state, on an object added at objData.pos (PresetLoadEvent, Headless-Runner)
+static void ApplyObjectData(RigidObject* obj, const ObjectData& objData) {
+    obj->SetScale(objData.scl);
+    obj->SetMass(objData.mass);
+    obj->GetRigidBody()->SetLinearVelocity(objData.vel);
+    obj->GetRigidBody()->SetAngularVelocity(objData.angVel);
+    obj->GetRigidBody()->SetOrientation(objData.orientation);
+
+    if (objData.IsFixed == true) {
+        obj->FixInPlace();
+    }
+}
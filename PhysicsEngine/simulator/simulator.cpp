@@ -2,6 +2,7 @@
 #include "math/mathConstants.h"
 #include "graphics/textureImage.h"
 #include "spawner.h"
+#include "engine/profiler.h"
 #include <typeinfo>
 #include <cmath>
 
@@ -36,29 +37,37 @@ void Simulator::Run()
 			accumulator -= Target_FPS_Inverse;
 		}
 
+		PROFILE_ZONE("Frame");//the physics steps excluded, they have their own zones
+
 		renderer.BindSceneFrameBuffer();
 		renderer.Clear();
 
-		//background
-		renderer.RenderGround();
-
-		//objects
 		const std::vector<RigidObject*>& objects = physicsWorld.GetObjects();
-		for (auto& object : objects) {
-			renderer.RenderObject(object);
+		{
+			PROFILE_ZONE("Render");
+			//background
+			renderer.RenderGround();
+
+			//objects
+			for (auto& object : objects) {
+				renderer.RenderObject(object);
+			}
 		}
 
 
 		//contact points
-		auto collisionManifolds = physicsWorld.GetManifold();
+		const physics::PhysicsWorld::Manifolds& collisionManifolds = physicsWorld.GetContacts();
 		for (const auto& manifold : collisionManifolds)
 		{
 			if (shouldRenderContactInfo) {
-				if (manifold.contactPoint.p1.first == true) {//valid
-					renderer.RenderCollisionContacts(manifold.contactPoint.p1.second, manifold.collisionNormal);
-				}
-				if (manifold.contactPoint.p2.first == true) {//valid
-					renderer.RenderCollisionContacts(manifold.contactPoint.p2.second, manifold.collisionNormal);
+				for (int i = 0; i < manifold.pointCount; ++i) {
+					const physics::ContactPoint& contactPoint = manifold.points[i].contactPoint;
+					if (contactPoint.p1.first == true) {//valid
+						renderer.RenderCollisionContacts(contactPoint.p1.second, manifold.collisionNormal);
+					}
+					if (contactPoint.p2.first == true) {//valid
+						renderer.RenderCollisionContacts(contactPoint.p2.second, manifold.collisionNormal);
+					}
 				}
 			}
 		}
@@ -72,7 +81,10 @@ void Simulator::Run()
 
 		renderer.BindDefaultFrameBuffer();
 
-		userInterface.renderAll(renderer.GetTextures(), eventQueue, objects, isRunning, selectedObjects);
+		{
+			PROFILE_ZONE("GUI");
+			userInterface.renderAll(renderer.GetTextures(), eventQueue, objects, isRunning, selectedObjects);
+		}
 
 		glfwSwapBuffers(renderer.GetWindow());
 		glfwPollEvents();
@@ -80,58 +92,49 @@ void Simulator::Run()
 	}
 }
 
-SphereObject* Simulator::AddSphere(math::Vector3 pos, TextureID textureID) {
-	SphereObject* newObject = new SphereObject;
-	physicsWorld.AddRigidBody(pos.x, pos.y, pos.z, newObject);
-	physicsWorld.AddCollider(newObject->rigidBody, newObject);
+RigidObject* Simulator::AddObject(ObjectType type, math::Vector3 pos, TextureID textureID) {
+	if (type == ObjectType::SPAWNER) {
+		return AddSpawner(pos, textureID);
+	}
+	RigidObject* newObject = CreateObject(type);
+	AddObjectToWorld(physicsWorld, newObject, pos);
 
 	renderer.AddGraphicalShape(newObject);
-
 	newObject->GetShape()->SetTextureID(textureID);
-	physicsWorld.AddPhysicalObject(newObject);
 	return newObject;
 }
 
+SphereObject* Simulator::AddSphere(math::Vector3 pos, TextureID textureID) {
+	return static_cast<SphereObject*>(AddObject(ObjectType::SPHERE, pos, textureID));
+}
+
 BoxObject* Simulator::AddBox(math::Vector3 pos, TextureID textureID) {
-	BoxObject* newObject = new BoxObject;
-	physicsWorld.AddRigidBody(pos.x, pos.y, pos.z, newObject);
-	physicsWorld.AddCollider(newObject->GetRigidBody(), newObject);
+	return static_cast<BoxObject*>(AddObject(ObjectType::BOX, pos, textureID));
+}
 
-	renderer.AddGraphicalShape(newObject);
-	newObject->GetShape()->SetTextureID(textureID);
+CapsuleObject* Simulator::AddCapsule(math::Vector3 pos, TextureID textureID) {
+	return static_cast<CapsuleObject*>(AddObject(ObjectType::CAPSULE, pos, textureID));
+}
 
-	physicsWorld.AddPhysicalObject(newObject);
-	return newObject;
+ConvexHullObject* Simulator::AddConvexHull(math::Vector3 pos, TextureID textureID) {
+	return static_cast<ConvexHullObject*>(AddObject(ObjectType::CONVEX_HULL, pos, textureID));
 }
 
 SphereBoxSpawner* Simulator::AddSpawner(math::Vector3 pos, TextureID textureID) {
 	SphereBoxSpawner* newObject = new SphereBoxSpawner(physicsWorld, renderer);
-	physicsWorld.AddRigidBody(pos.x, pos.y, pos.z, newObject);
-	physicsWorld.AddCollider(newObject->GetRigidBody(), newObject);
+	AddObjectToWorld(physicsWorld, newObject, pos);
+
 	renderer.AddGraphicalShape(newObject);
 	newObject->GetShape()->SetTextureID(textureID);
-
-	physicsWorld.AddPhysicalObject(newObject);
 	return newObject;
 }
 
 std::vector<RigidObject*>::iterator Simulator::RemoveObject(RigidObject* obj)
 {
-	physicsWorld.RemovePhysicsObject(obj);
+	std::vector<RigidObject*>::iterator itr = physicsWorld.RemovePhysicsObject(obj);
 	renderer.RemoveShape(obj);
-
-	std::vector<RigidObject*>& objects = physicsWorld.GetObjects();
-	std::vector<RigidObject*>::iterator itr = objects.begin();
-	for (; itr != objects.end();) {
-		if (*itr == obj) {
-			delete* itr;
-			break;
-		}
-		else {
-			itr++;//https://backhugger.tistory.com/45
-		}
-	}
-	return objects.erase(itr);
+	delete obj;
+	return itr;
 }
 
 void Simulator::HandleKeyboardInput()
@@ -34,9 +34,12 @@ public:
     Simulator();
     
     void Run();
+    RigidObject* AddObject(ObjectType type, math::Vector3 pos, TextureID img);//with its graphical shape
     SphereObject* AddSphere(math::Vector3 pos = {0.f,1.f,0.f}, TextureID img = TextureID::FACE);
     BoxObject* AddBox(math::Vector3 pos = { 0.f,1.f,0.f }, TextureID img=TextureID::BALOONS);
     SphereBoxSpawner* AddSpawner(math::Vector3 pos = { 0.f,1.f,0.f }, TextureID img = TextureID::SPAWNER);
+    CapsuleObject* AddCapsule(math::Vector3 pos = { 0.f,1.f,0.f }, TextureID img = TextureID::JEANS);
+    ConvexHullObject* AddConvexHull(math::Vector3 pos = { 0.f,1.f,0.f }, TextureID img = TextureID::BRICKS);
     std::vector<RigidObject*>::iterator RemoveObject(RigidObject* obj);
 
     void SetTimeStepMultiplier(float value) { timeStepMultiplier=value; }
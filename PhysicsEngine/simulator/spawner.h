@@ -53,7 +53,7 @@ template<>
 inline void ObjectPool<SphereObject>::AddObject(){
     SphereObject* newObject = new SphereObject;
 
-    RigidBody* newBody = new RigidBody;
+    RigidBody* newBody = physicsWorld.CreateRigidBody();
     newBody->SetMass(3.0f);
     newBody->SetPosition(0,0,0);
     newBody->SetLinearAcceleration(0.0f, 0.0f, 0.0f);
@@ -66,7 +66,7 @@ inline void ObjectPool<SphereObject>::AddObject(){
     newObject->SetRigidBody(newBody);
 
     Collider* newCollider{ nullptr };
-    newCollider = new SphereCollider(newBody, SPAWNED_OBJECT_SCALE);
+    newCollider = physicsWorld.CreateSphereCollider(newBody, SPAWNED_OBJECT_SCALE);
     newObject->SetCollider(newCollider);
 
     renderer.AddGraphicalShape(newObject);
@@ -139,7 +139,7 @@ template<>
 inline void ObjectPool<BoxObject>::AddObject() {
     BoxObject* newObject = new BoxObject;
 
-    RigidBody* newBody = new RigidBody;
+    RigidBody* newBody = physicsWorld.CreateRigidBody();
     newBody->SetMass(2.5f);
     newBody->SetPosition(0, 0, 0);
     newBody->SetLinearAcceleration(0.0f, 0.0f, 0.0f);
@@ -152,7 +152,7 @@ inline void ObjectPool<BoxObject>::AddObject() {
     newObject->SetRigidBody(newBody);
 
     Collider* newCollider{ nullptr };
-    newCollider = new BoxCollider(newBody, SPAWNED_OBJECT_SCALE , SPAWNED_OBJECT_SCALE , SPAWNED_OBJECT_SCALE);
+    newCollider = physicsWorld.CreateBoxCollider(newBody, Vector3{ SPAWNED_OBJECT_SCALE, SPAWNED_OBJECT_SCALE, SPAWNED_OBJECT_SCALE });
     newObject->SetCollider(newCollider);
 
     renderer.AddGraphicalShape(newObject);
@@ -173,6 +173,7 @@ public:
         spherePool.SpawnAll(GetPosition());
         boxPool.SpawnAll(GetPosition());
     }
+    void OnCollision() override final { spawnAll(); }
     SphereBoxSpawner(physics::PhysicsWorld& physicsWorld_, graphics::Renderer& renderer_, int initialSphereCount = 10, int initialBoxCount = 10)
         :spherePool(physicsWorld_, renderer_, initialSphereCount),
         boxPool(physicsWorld_, renderer_, initialBoxCount)
@@ -23,10 +23,6 @@ workspace "PhysicsEngineWorkspace"
         "PhysicsEngine/includes/json",
     }
 
-    libdirs { "PhysicsEngine/libraries" }
-    -- Since you're using GLFW (which likely has a .lib file), link against it
-    links { "glfw3", "opengl32" }
-
     -- Configuration Specific Settings
     filter "configurations:Debug"
         defines { "DEBUG" }
@@ -38,4 +34,6 @@ workspace "PhysicsEngineWorkspace"
 
     -- Projects
     include "PhysicsEngine"
+    include "Headless-Runner"
+    include "Benchmark"
     include "Matrix-Test"